@@ -19,16 +19,22 @@
  */
 
 #include <assert.h>
+#include <algorithm>
+#include <atomic>
 #include <boost/filesystem/convenience.hpp>
 #include <boost/program_options.hpp>
 #include <iostream>
-#include <map>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
+#ifdef BBASM_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 enum TokenType : int8_t
 {
@@ -39,6 +45,25 @@ enum TokenType : int8_t
     TOK_U32
 };
 
+// Opcodes of the binary input format, see README.md
+enum BinaryOpcode : uint8_t
+{
+    BIN_PRE = 0x01,
+    BIN_POST = 0x02,
+    BIN_PUSH = 0x03,
+    BIN_POP = 0x04,
+    BIN_SYM = 0x05,
+    BIN_LABEL = 0x06,
+    BIN_REF = 0x07,
+    BIN_U8 = 0x08,
+    BIN_U16 = 0x09,
+    BIN_U32 = 0x0a,
+    BIN_STR = 0x0b
+};
+
+const char binaryMagic[] = "BBAB";
+const int binaryVersion = 1;
+
 struct Stream
 {
     std::string name;
@@ -49,15 +74,20 @@ struct Stream
 
 Stream stringStream;
 std::vector<Stream> streams;
-std::map<std::string, int> streamIndex;
+std::unordered_map<std::string, int> streamIndex;
 std::vector<int> streamStack;
 
+// Label positions are first computed relative to the start of the stream that defines them (labelStream), so that
+// streams can be sized independently, and then made absolute
 std::vector<int> labels;
+std::vector<int> labelStream;
 std::vector<std::string> labelNames;
-std::map<std::string, int> labelIndex;
+std::unordered_map<std::string, int> labelIndex;
 
 std::vector<std::string> preText, postText;
 
+bool debug = false;
+
 const char *skipWhitespace(const char *p)
 {
     if (p == nullptr)
@@ -67,14 +97,255 @@ const char *skipWhitespace(const char *p)
     return p;
 }
 
+int getLabel(const std::string &name)
+{
+    auto found = labelIndex.emplace(name, int(labels.size()));
+    if (found.second) {
+        if (debug)
+            labelNames.push_back(name);
+        labels.push_back(-1);
+        labelStream.push_back(-1);
+    }
+    return found.first->second;
+}
+
+Stream &currentStream()
+{
+    if (streamStack.empty()) {
+        printf("Data outside of a push..pop block\n");
+        exit(-1);
+    }
+    return streams.at(streamStack.back());
+}
+
+void pushStream(const std::string &name)
+{
+    auto found = streamIndex.emplace(name, int(streams.size()));
+    if (found.second) {
+        streams.resize(streams.size() + 1);
+        streams.back().name = name;
+    }
+    streamStack.push_back(found.first->second);
+}
+
+void addToken(TokenType type, uint32_t value, const char *comment)
+{
+    Stream &s = currentStream();
+    s.tokenTypes.push_back(type);
+    s.tokenValues.push_back(value);
+    if (debug)
+        s.tokenComments.push_back(comment);
+}
+
+// Add a reference to a zero-terminated copy of the string, which is placed in the strings stream
+void addString(const char *value, size_t length, const char *comment)
+{
+    int label = getLabel(std::string("str:") + std::string(value, length));
+    addToken(TOK_REF, label, comment);
+    stringStream.tokenTypes.push_back(TOK_LABEL);
+    stringStream.tokenValues.push_back(label);
+    stringStream.tokenComments.push_back("");
+    for (size_t i = 0; i <= length; i++) {
+        char c = (i < length) ? value[i] : 0;
+        stringStream.tokenTypes.push_back(TOK_U8);
+        stringStream.tokenValues.push_back(c);
+        if (debug) {
+            char char_comment[4] = {'\'', c, '\'', 0};
+            if (c < 32 || c >= 127)
+                char_comment[0] = 0;
+            stringStream.tokenComments.push_back(char_comment);
+        }
+    }
+}
+
+void parseText(FILE *fileIn)
+{
+    char buffer[512];
+    while (fgets(buffer, 512, fileIn) != nullptr) {
+        std::string cmd = strtok(buffer, " \t\r\n");
+
+        if (cmd == "pre") {
+            const char *p = skipWhitespace(strtok(nullptr, "\r\n"));
+            preText.push_back(p);
+            continue;
+        }
+
+        if (cmd == "post") {
+            const char *p = skipWhitespace(strtok(nullptr, "\r\n"));
+            postText.push_back(p);
+            continue;
+        }
+
+        if (cmd == "push") {
+            pushStream(strtok(nullptr, " \t\r\n"));
+            continue;
+        }
+
+        if (cmd == "pop") {
+            streamStack.pop_back();
+            continue;
+        }
+
+        if (cmd == "label" || cmd == "ref") {
+            const char *label = strtok(nullptr, " \t\r\n");
+            const char *comment = skipWhitespace(strtok(nullptr, "\r\n"));
+            addToken(cmd == "label" ? TOK_LABEL : TOK_REF, getLabel(label), comment);
+            continue;
+        }
+
+        if (cmd == "u8" || cmd == "u16" || cmd == "u32") {
+            const char *value = strtok(nullptr, " \t\r\n");
+            const char *comment = skipWhitespace(strtok(nullptr, "\r\n"));
+            addToken(cmd == "u8" ? TOK_U8 : cmd == "u16" ? TOK_U16 : TOK_U32, atoll(value), comment);
+            continue;
+        }
+
+        if (cmd == "str") {
+            const char *value = skipWhitespace(strtok(nullptr, "\r\n"));
+            assert(*value != 0);
+            char *end = strchr((char *)value + 1, *value);
+            assert(end != nullptr);
+            *end = 0;
+            value += 1;
+            const char *comment = skipWhitespace(strtok(end + 1, "\r\n"));
+            addString(value, end - value, comment);
+            continue;
+        }
+
+        assert(0);
+    }
+}
+
+void parseBinary(const std::vector<uint8_t> &input)
+{
+    size_t pos = strlen(binaryMagic);
+    auto truncated = []() {
+        printf("Binary input is truncated\n");
+        exit(-1);
+    };
+    // Unsigned LEB128
+    auto readVarint = [&]() {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            if (pos >= input.size())
+                truncated();
+            uint8_t b = input[pos++];
+            value |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return value;
+        }
+    };
+    auto readString = [&]() {
+        uint32_t length = readVarint();
+        if (input.size() - pos < length)
+            truncated();
+        std::string result(reinterpret_cast<const char *>(&input[pos]), length);
+        pos += length;
+        return result;
+    };
+    auto readSymbol = [&](const std::vector<int> &symbols) {
+        uint32_t sym = readVarint();
+        if (sym >= symbols.size()) {
+            printf("Undeclared symbol %u in binary input\n", sym);
+            exit(-1);
+        }
+        return symbols[sym];
+    };
+
+    if (pos >= input.size())
+        truncated();
+    if (input[pos++] != binaryVersion) {
+        printf("Unsupported binary input version %d\n", int(input[pos - 1]));
+        exit(-1);
+    }
+
+    // The input declares each label name once, and refers to it by the order of declaration from then on
+    std::vector<int> symbols;
+    while (pos < input.size()) {
+        uint8_t op = input[pos++];
+        switch (op) {
+        case BIN_PRE:
+            preText.push_back(readString());
+            break;
+        case BIN_POST:
+            postText.push_back(readString());
+            break;
+        case BIN_PUSH:
+            pushStream(readString());
+            break;
+        case BIN_POP:
+            if (streamStack.empty()) {
+                printf("Unbalanced pop in binary input\n");
+                exit(-1);
+            }
+            streamStack.pop_back();
+            break;
+        case BIN_SYM:
+            symbols.push_back(getLabel(readString()));
+            break;
+        case BIN_LABEL:
+            addToken(TOK_LABEL, readSymbol(symbols), "");
+            break;
+        case BIN_REF:
+            addToken(TOK_REF, readSymbol(symbols), "");
+            break;
+        case BIN_U8:
+            addToken(TOK_U8, readVarint(), "");
+            break;
+        case BIN_U16:
+            addToken(TOK_U16, readVarint(), "");
+            break;
+        case BIN_U32:
+            addToken(TOK_U32, readVarint(), "");
+            break;
+        case BIN_STR: {
+            std::string value = readString();
+            addString(value.data(), value.size(), "");
+            break;
+        }
+        default:
+            printf("Invalid opcode 0x%02x in binary input at offset %d\n", int(op), int(pos - 1));
+            exit(-1);
+        }
+    }
+}
+
+// Run func(index) for every stream. With more than one thread, streams are handed out to a pool of threads largest
+// first to balance the load; otherwise they are processed in order.
+template <typename TFunc> void forEachStream(int numThreads, TFunc func)
+{
+    numThreads = std::min(numThreads, int(streams.size()));
+    if (numThreads <= 1) {
+        for (int i = 0; i < int(streams.size()); i++)
+            func(i);
+        return;
+    }
+    std::vector<int> order(streams.size());
+    for (int i = 0; i < int(order.size()); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [](int a, int b) {
+        return streams[a].tokenTypes.size() > streams[b].tokenTypes.size();
+    });
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+        for (int i = next++; i < int(order.size()); i = next++)
+            func(order[i]);
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(worker);
+    for (auto &t : threads)
+        t.join();
+}
+
 int main(int argc, char **argv)
 {
-    bool debug = false;
     bool verbose = false;
     bool bigEndian;
     bool writeC = false;
     bool writeE = false;
-    char buffer[512];
+    bool writeCompressed = false;
+    int numThreads = std::max(1, int(std::thread::hardware_concurrency()));
 
     namespace po = boost::program_options;
     po::positional_options_description pos;
@@ -86,6 +357,8 @@ int main(int argc, char **argv)
     options.add_options()("le,l", "little endian");
     options.add_options()("c,c", "write C strings");
     options.add_options()("e,e", "write #embed C");
+    options.add_options()("compress", "compress the data with zlib");
+    options.add_options()("threads,j", po::value<int>(), "number of threads for assembling streams");
     options.add_options()("files", po::value<std::vector<std::string>>(), "file parameters");
     pos.add("files", -1);
 
@@ -120,6 +393,17 @@ int main(int argc, char **argv)
         writeC = true;
     if (vm.count("e"))
         writeE = true;
+    if (vm.count("threads"))
+        numThreads = std::max(1, vm["threads"].as<int>());
+
+    if (vm.count("compress")) {
+#ifdef BBASM_HAVE_ZLIB
+        writeCompressed = true;
+#else
+        printf("bbasm was built without zlib support\n");
+        exit(-1);
+#endif
+    }
 
     if (writeC && writeE) {
         printf("Incompatible modes\n");
@@ -135,115 +419,31 @@ int main(int argc, char **argv)
         exit(-1);
     }
 
-    FILE *fileIn = fopen(files.at(0).c_str(), "rt");
+    FILE *fileIn = fopen(files.at(0).c_str(), "rb");
     assert(fileIn != nullptr);
 
     FILE *fileOut = fopen(files.at(1).c_str(), writeC ? "wt" : "wb");
     assert(fileOut != nullptr);
 
-    while (fgets(buffer, 512, fileIn) != nullptr) {
-        std::string cmd = strtok(buffer, " \t\r\n");
-
-        if (cmd == "pre") {
-            const char *p = skipWhitespace(strtok(nullptr, "\r\n"));
-            preText.push_back(p);
-            continue;
-        }
-
-        if (cmd == "post") {
-            const char *p = skipWhitespace(strtok(nullptr, "\r\n"));
-            postText.push_back(p);
-            continue;
-        }
-
-        if (cmd == "push") {
-            const char *p = strtok(nullptr, " \t\r\n");
-            if (streamIndex.count(p) == 0) {
-                streamIndex[p] = streams.size();
-                streams.resize(streams.size() + 1);
-                streams.back().name = p;
-            }
-            streamStack.push_back(streamIndex.at(p));
-            continue;
-        }
-
-        if (cmd == "pop") {
-            streamStack.pop_back();
-            continue;
-        }
-
-        if (cmd == "label" || cmd == "ref") {
-            const char *label = strtok(nullptr, " \t\r\n");
-            const char *comment = skipWhitespace(strtok(nullptr, "\r\n"));
-            Stream &s = streams.at(streamStack.back());
-            if (labelIndex.count(label) == 0) {
-                labelIndex[label] = labels.size();
-                if (debug)
-                    labelNames.push_back(label);
-                labels.push_back(-1);
-            }
-            s.tokenTypes.push_back(cmd == "label" ? TOK_LABEL : TOK_REF);
-            s.tokenValues.push_back(labelIndex.at(label));
-            if (debug)
-                s.tokenComments.push_back(comment);
-            continue;
-        }
-
-        if (cmd == "u8" || cmd == "u16" || cmd == "u32") {
-            const char *value = strtok(nullptr, " \t\r\n");
-            const char *comment = skipWhitespace(strtok(nullptr, "\r\n"));
-            Stream &s = streams.at(streamStack.back());
-            s.tokenTypes.push_back(cmd == "u8" ? TOK_U8 : cmd == "u16" ? TOK_U16 : TOK_U32);
-            s.tokenValues.push_back(atoll(value));
-            if (debug)
-                s.tokenComments.push_back(comment);
-            continue;
-        }
-
-        if (cmd == "str") {
-            const char *value = skipWhitespace(strtok(nullptr, "\r\n"));
-            assert(*value != 0);
-            char *end = strchr((char *)value + 1, *value);
-            assert(end != nullptr);
-            *end = 0;
-            value += 1;
-            const char *comment = skipWhitespace(strtok(end + 1, "\r\n"));
-            std::string label = std::string("str:") + value;
-            Stream &s = streams.at(streamStack.back());
-            if (labelIndex.count(label) == 0) {
-                labelIndex[label] = labels.size();
-                if (debug)
-                    labelNames.push_back(label);
-                labels.push_back(-1);
-            }
-            s.tokenTypes.push_back(TOK_REF);
-            s.tokenValues.push_back(labelIndex.at(label));
-            if (debug)
-                s.tokenComments.push_back(comment);
-            stringStream.tokenTypes.push_back(TOK_LABEL);
-            stringStream.tokenValues.push_back(labelIndex.at(label));
-            stringStream.tokenComments.push_back("");
-            while (1) {
-                stringStream.tokenTypes.push_back(TOK_U8);
-                stringStream.tokenValues.push_back(*value);
-                if (debug) {
-                    char char_comment[4] = {'\'', *value, '\'', 0};
-                    if (*value < 32 || *value >= 127)
-                        char_comment[0] = 0;
-                    stringStream.tokenComments.push_back(char_comment);
-                }
-                if (*value == 0)
-                    break;
-                value++;
-            }
-            continue;
-        }
-
-        assert(0);
+    // Binary input is recognised by its magic; anything else is parsed as text
+    char magic[sizeof(binaryMagic) - 1];
+    bool binaryInput = fread(magic, 1, sizeof(magic), fileIn) == sizeof(magic) &&
+                       memcmp(magic, binaryMagic, sizeof(magic)) == 0;
+    if (binaryInput) {
+        std::vector<uint8_t> input(magic, magic + sizeof(magic));
+        uint8_t chunk[65536];
+        size_t count;
+        while ((count = fread(chunk, 1, sizeof(chunk), fileIn)) > 0)
+            input.insert(input.end(), chunk, chunk + count);
+        parseBinary(input);
+    } else {
+        rewind(fileIn);
+        parseText(fileIn);
     }
+    fclose(fileIn);
 
     if (verbose) {
-        printf("Constructed %d streams:\n", int(streams.size()));
+        printf("Constructed %d streams from %s input:\n", int(streams.size()), binaryInput ? "binary" : "text");
         for (auto &s : streams)
             printf("    stream '%s' with %d tokens\n", s.name.c_str(), int(s.tokenTypes.size()));
     }
@@ -256,12 +456,16 @@ int main(int argc, char **argv)
     streams.back().tokenValues.swap(stringStream.tokenValues);
     streams.back().tokenComments.swap(stringStream.tokenComments);
 
-    int cursor = 0;
-    for (auto &s : streams) {
+    // First pass: size each stream and place its labels relative to the start of the stream
+    std::vector<int> streamSizes(streams.size());
+    forEachStream(numThreads, [&](int idx) {
+        Stream &s = streams[idx];
+        int cursor = 0;
         for (int i = 0; i < int(s.tokenTypes.size()); i++) {
             switch (s.tokenTypes[i]) {
             case TOK_LABEL:
                 labels[s.tokenValues[i]] = cursor;
+                labelStream[s.tokenValues[i]] = idx;
                 break;
             case TOK_REF:
                 cursor += 4;
@@ -270,18 +474,28 @@ int main(int argc, char **argv)
                 cursor += 1;
                 break;
             case TOK_U16:
-                assert(cursor % 2 == 0);
                 cursor += 2;
                 break;
             case TOK_U32:
-                assert(cursor % 4 == 0);
                 cursor += 4;
                 break;
             default:
                 assert(0);
             }
         }
+        streamSizes[idx] = cursor;
+    });
+
+    // Start offset of each stream, also used for the section table of the binary output header
+    std::vector<int> streamOffsets;
+    int cursor = 0;
+    for (int size : streamSizes) {
+        streamOffsets.push_back(cursor);
+        cursor += size;
     }
+    for (int i = 0; i < int(labels.size()); i++)
+        if (labelStream[i] != -1)
+            labels[i] += streamOffsets[labelStream[i]];
 
     if (verbose) {
         printf("resolved positions for %d labels.\n", int(labels.size()));
@@ -290,8 +504,11 @@ int main(int argc, char **argv)
 
     std::vector<uint8_t> data(cursor);
 
-    cursor = 0;
-    for (auto &s : streams) {
+    // Second pass: write the data. Streams cover disjoint regions of the output, so they can be written in parallel;
+    // the debug listing has to be in order though.
+    forEachStream(debug ? 1 : numThreads, [&](int idx) {
+        Stream &s = streams[idx];
+        int cursor = streamOffsets[idx];
         if (debug)
             printf("-- %s --\n", s.name.c_str());
 
@@ -310,51 +527,20 @@ int main(int argc, char **argv)
                 numBytes = 1;
                 break;
             case TOK_U16:
+                assert(cursor % 2 == 0);
                 numBytes = 2;
                 break;
             case TOK_U32:
+                assert(cursor % 4 == 0);
                 numBytes = 4;
                 break;
             default:
                 assert(0);
             }
 
-            if (bigEndian) {
-                switch (numBytes) {
-                case 4:
-                    data[cursor++] = value >> 24;
-                    data[cursor++] = value >> 16;
-                /* fall-through */
-                case 2:
-                    data[cursor++] = value >> 8;
-                /* fall-through */
-                case 1:
-                    data[cursor++] = value;
-                /* fall-through */
-                case 0:
-                    break;
-                default:
-                    assert(0);
-                }
-            } else {
-                switch (numBytes) {
-                case 4:
-                    data[cursor + 3] = value >> 24;
-                    data[cursor + 2] = value >> 16;
-                /* fall-through */
-                case 2:
-                    data[cursor + 1] = value >> 8;
-                /* fall-through */
-                case 1:
-                    data[cursor] = value;
-                /* fall-through */
-                case 0:
-                    break;
-                default:
-                    assert(0);
-                }
-                cursor += numBytes;
-            }
+            for (int k = 0; k < numBytes; k++)
+                data[cursor + (bigEndian ? (numBytes - 1 - k) : k)] = value >> (8 * k);
+            cursor += numBytes;
 
             if (debug) {
                 printf("%08x ", cursor - numBytes);
@@ -401,19 +587,79 @@ int main(int argc, char **argv)
                 }
             }
         }
+        assert(cursor == streamOffsets[idx] + streamSizes[idx]);
+    });
+
+    // Plain binary files and compressed databases get a header (see ChipdbHeader in common/kernel/embed.h) with a
+    // version, sizes, checksum and table of streams. For binary files the header is padded so that the data itself
+    // starts on a page boundary and can be mapped directly.
+    std::vector<uint8_t> blob;
+    if (writeCompressed || (!writeC && !writeE)) {
+        const uint32_t magic = 0x4244504e, version = 2, flagCompressed = 1;
+        const int sectionNameLen = 24, pageSize = 4096;
+        auto putU32 = [&](uint32_t value) {
+            for (int k = 0; k < 4; k++)
+                blob.push_back(bigEndian ? (value >> (24 - 8 * k)) : (value >> (8 * k)));
+        };
+        std::vector<uint8_t> stored;
+        if (writeCompressed) {
+#ifdef BBASM_HAVE_ZLIB
+            uLongf storedSize = compressBound(data.size());
+            stored.resize(storedSize);
+            if (compress2(stored.data(), &storedSize, data.data(), data.size(), Z_BEST_COMPRESSION) != Z_OK) {
+                printf("Compression failed\n");
+                exit(-1);
+            }
+            stored.resize(storedSize);
+#endif
+        } else {
+            stored = data;
+        }
+        uint32_t checksum = 2166136261U;
+        for (auto d : data)
+            checksum = (checksum ^ d) * 16777619U;
+        int headerSize = 32 + int(streams.size()) * (sectionNameLen + 8);
+        if (!writeCompressed)
+            headerSize = (headerSize + pageSize - 1) / pageSize * pageSize;
+        else
+            headerSize = (headerSize + 15) / 16 * 16;
+        putU32(magic);
+        putU32(version);
+        putU32(headerSize);
+        putU32(streams.size());
+        putU32(data.size());
+        putU32(checksum);
+        putU32(writeCompressed ? flagCompressed : 0);
+        putU32(stored.size());
+        for (int i = 0; i < int(streams.size()); i++) {
+            std::string name = streams[i].name.substr(0, sectionNameLen - 1);
+            name.resize(sectionNameLen, '\0');
+            blob.insert(blob.end(), name.begin(), name.end());
+            int end = (i + 1 < int(streams.size())) ? streamOffsets[i + 1] : int(data.size());
+            putU32(streamOffsets[i]);
+            putU32(end - streamOffsets[i]);
+        }
+        blob.resize(headerSize, 0);
+        blob.insert(blob.end(), stored.begin(), stored.end());
+        if (verbose) {
+            printf("header size %d bytes, checksum %08x\n", headerSize, checksum);
+            if (writeCompressed)
+                printf("compressed %.2f MB to %.2f MB (%.1f%%)\n", double(data.size()) / (1024 * 1024),
+                       double(stored.size()) / (1024 * 1024), 100.0 * double(stored.size()) / double(data.size()));
+        }
+    } else {
+        blob.swap(data);
     }
 
-    assert(cursor == int(data.size()));
-
     if (writeC) {
         for (auto &s : preText)
             fprintf(fileOut, "%s\n", s.c_str());
 
-        fprintf(fileOut, "const char %s[%d] =\n\"", streams[0].name.c_str(), int(data.size()) + 1);
+        fprintf(fileOut, "const char %s[%d] =\n\"", streams[0].name.c_str(), int(blob.size()) + 1);
 
         cursor = 1;
-        for (int i = 0; i < int(data.size()); i++) {
-            auto d = data[i];
+        for (int i = 0; i < int(blob.size()); i++) {
+            auto d = blob[i];
             if (cursor > 70) {
                 fputc('\"', fileOut);
                 fputc('\n', fileOut);
@@ -424,7 +670,7 @@ int main(int argc, char **argv)
                 cursor = 1;
             }
             if (d < 32 || d >= 127) {
-                if (i + 1 < int(data.size()) && (data[i + 1] < '0' || '9' < data[i + 1]))
+                if (i + 1 < int(blob.size()) && (blob[i + 1] < '0' || '9' < blob[i + 1]))
                     cursor += fprintf(fileOut, "\\%o", int(d));
                 else
                     cursor += fprintf(fileOut, "\\%03o", int(d));
@@ -446,7 +692,7 @@ int main(int argc, char **argv)
         for (auto &s : preText)
             fprintf(fileOut, "%s\n", s.c_str());
 
-        fprintf(fileOut, "const char %s[%d] =\n", streams[0].name.c_str(), int(data.size()) + 1);
+        fprintf(fileOut, "const char %s[%d] =\n", streams[0].name.c_str(), int(blob.size()) + 1);
         fprintf(fileOut, "#embed_str \"%s\"\n", boost::filesystem::basename(files.at(2)).c_str());
         fprintf(fileOut, ";\n");
 
@@ -455,10 +701,10 @@ int main(int argc, char **argv)
 
         FILE *fileBin = fopen(files.at(2).c_str(), "wb");
         assert(fileBin != nullptr);
-        fwrite(data.data(), int(data.size()), 1, fileBin);
+        fwrite(blob.data(), int(blob.size()), 1, fileBin);
         fclose(fileBin);
     } else {
-        fwrite(data.data(), int(data.size()), 1, fileOut);
+        fwrite(blob.data(), int(blob.size()), 1, fileOut);
     }
 
     return 0;
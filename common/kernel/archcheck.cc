@@ -21,6 +21,7 @@
 
 #include "log.h"
 #include "nextpnr.h"
+#include "parallel_chunks.h"
 
 #if 0
 #define dbg(...) log(__VA_ARGS__)
@@ -38,6 +39,60 @@ USING_NEXTPNR_NAMESPACE
 
 namespace {
 
+// Failures found by one chunk of a parallel check. Worker threads can't safely log, so failures are collected and
+// reported once all the chunks have finished, in chunk order, so the log doesn't depend on the number of threads.
+struct CheckErrors
+{
+    // A broken database tends to fail the same check many times, so only the first few failures are kept
+    static const int max_messages = 10;
+    std::vector<std::string> messages;
+    int count = 0;
+
+    void fail(const char *expr, int line)
+    {
+        if (count++ < max_messages)
+            messages.push_back(stringf("Assertion failure: %s (%s:%d)", expr, __FILE__, line));
+    }
+};
+
+#define check_assert(errors, cond)                                                                                     \
+    do {                                                                                                               \
+        if (!(cond))                                                                                                   \
+            (errors).fail(#cond, __LINE__);                                                                            \
+    } while (0)
+
+template <typename TResult> void report_errors(const std::vector<TResult> &results, const char *what)
+{
+    int count = 0;
+    for (const CheckErrors &result : results) {
+        for (auto &msg : result.messages)
+            log_nonfatal_error("%s\n", msg.c_str());
+        count += result.count;
+    }
+    if (count > 0)
+        log_error("%d failure%s while checking %s.\n", count, count == 1 ? "" : "s", what);
+}
+
+// Run func(item, result) for every item of a range, in parallel chunks. Arch ranges can only be iterated forwards, so
+// each chunk steps through the range to its start, which is cheap compared to the checks themselves. func must only
+// use the read-only parts of the Arch API; in particular, it must not create IdStrings.
+template <typename TResult, typename TRange, typename TFunc>
+std::vector<TResult> check_parallel(const Context *ctx, const TRange &range, TFunc func)
+{
+    int count = 0;
+    for (auto it = range.begin(); it != range.end(); ++it)
+        count++;
+    return parallel_chunks<TResult>(ctx, count, 4096, [&](int begin, int end, TResult &result) {
+        auto it = range.begin();
+        for (int i = 0; i < begin; i++)
+            ++it;
+        for (int i = begin; i < end; i++, ++it)
+            func(*it, result);
+    });
+}
+
+// Names are checked on a single thread, as getting the name of an object can create new IdStrings, and some arches fill
+// in their name lookup tables lazily.
 void archcheck_names(const Context *ctx)
 {
     log_info("Checking entity names.\n");
@@ -87,54 +142,53 @@ void archcheck_locs(const Context *ctx)
     log_info("Checking location data.\n");
 
     log_info("Checking all bels..\n");
-    for (BelId bel : ctx->getBels()) {
-        log_assert(bel != BelId());
-        dbg("> %s\n", ctx->getBelName(bel).c_str(ctx));
+    auto bel_results = check_parallel<CheckErrors>(ctx, ctx->getBels(), [&](BelId bel, CheckErrors &errors) {
+        check_assert(errors, bel != BelId());
 
         Loc loc = ctx->getBelLocation(bel);
-        dbg("   ... %d %d %d\n", loc.x, loc.y, loc.z);
 
-        log_assert(0 <= loc.x);
-        log_assert(0 <= loc.y);
-        log_assert(0 <= loc.z);
-        log_assert(loc.x < ctx->getGridDimX());
-        log_assert(loc.y < ctx->getGridDimY());
-        log_assert(loc.z < ctx->getTileBelDimZ(loc.x, loc.y));
+        check_assert(errors, 0 <= loc.x);
+        check_assert(errors, 0 <= loc.y);
+        check_assert(errors, 0 <= loc.z);
+        check_assert(errors, loc.x < ctx->getGridDimX());
+        check_assert(errors, loc.y < ctx->getGridDimY());
+        check_assert(errors, loc.z < ctx->getTileBelDimZ(loc.x, loc.y));
 
         BelId bel2 = ctx->getBelByLocation(loc);
-        dbg("   ... %s\n", ctx->getBelName(bel2).c_str(ctx));
-        log_assert(bel == bel2);
-    }
+        check_assert(errors, bel == bel2);
+    });
+    report_errors(bel_results, "bel locations");
 
     log_info("Checking all locations..\n");
-    for (int x = 0; x < ctx->getGridDimX(); x++)
-        for (int y = 0; y < ctx->getGridDimY(); y++) {
-            dbg("> %d %d\n", x, y);
-            pool<int> usedz;
-
-            for (int z = 0; z < ctx->getTileBelDimZ(x, y); z++) {
-                BelId bel = ctx->getBelByLocation(Loc(x, y, z));
-                if (bel == BelId())
-                    continue;
-                Loc loc = ctx->getBelLocation(bel);
-                dbg("   + %d %s\n", z, ctx->nameOfBel(bel));
-                log_assert(x == loc.x);
-                log_assert(y == loc.y);
-                log_assert(z == loc.z);
-                usedz.insert(z);
-            }
+    auto loc_results = parallel_chunks<CheckErrors>(ctx, ctx->getGridDimX(), 1, [&](int x0, int x1,
+                                                                                   CheckErrors &errors) {
+        for (int x = x0; x < x1; x++)
+            for (int y = 0; y < ctx->getGridDimY(); y++) {
+                pool<int> usedz;
+
+                for (int z = 0; z < ctx->getTileBelDimZ(x, y); z++) {
+                    BelId bel = ctx->getBelByLocation(Loc(x, y, z));
+                    if (bel == BelId())
+                        continue;
+                    Loc loc = ctx->getBelLocation(bel);
+                    check_assert(errors, x == loc.x);
+                    check_assert(errors, y == loc.y);
+                    check_assert(errors, z == loc.z);
+                    usedz.insert(z);
+                }
 
-            for (BelId bel : ctx->getBelsByTile(x, y)) {
-                Loc loc = ctx->getBelLocation(bel);
-                dbg("   - %d %s\n", loc.z, ctx->nameOfBel(bel));
-                log_assert(x == loc.x);
-                log_assert(y == loc.y);
-                log_assert(usedz.count(loc.z));
-                usedz.erase(loc.z);
-            }
+                for (BelId bel : ctx->getBelsByTile(x, y)) {
+                    Loc loc = ctx->getBelLocation(bel);
+                    check_assert(errors, x == loc.x);
+                    check_assert(errors, y == loc.y);
+                    check_assert(errors, usedz.count(loc.z));
+                    usedz.erase(loc.z);
+                }
 
-            log_assert(usedz.empty());
-        }
+                check_assert(errors, usedz.empty());
+            }
+    });
+    report_errors(loc_results, "locations");
 
     log_break();
 }
@@ -169,14 +223,17 @@ struct LruWireCacheMap
     dict<PipId, WireId> pips_downhill;
     dict<PipId, WireId> pips_uphill;
 
+    // Duplicate pips are counted rather than asserted on, as the cache is used from the worker threads
+    int duplicate_pips = 0;
+
     void removeWireFromCache(WireId wire_to_remove)
     {
         for (PipId pip : ctx->getPipsDownhill(wire_to_remove)) {
-            log_assert(pips_downhill.erase(pip) == 1);
+            pips_downhill.erase(pip);
         }
 
         for (PipId pip : ctx->getPipsUphill(wire_to_remove)) {
-            log_assert(pips_uphill.erase(pip) == 1);
+            pips_uphill.erase(pip);
         }
     }
 
@@ -184,12 +241,14 @@ struct LruWireCacheMap
     {
         for (PipId pip : ctx->getPipsDownhill(wire)) {
             auto result = pips_downhill.emplace(pip, wire);
-            log_assert(result.second);
+            if (!result.second)
+                duplicate_pips++;
         }
 
         for (PipId pip : ctx->getPipsUphill(wire)) {
             auto result = pips_uphill.emplace(pip, wire);
-            log_assert(result.second);
+            if (!result.second)
+                duplicate_pips++;
         }
     }
 
@@ -204,7 +263,7 @@ struct LruWireCacheMap
             cache_evictions += 1;
             WireId wire_to_remove = last_access_list.front();
             last_access_list.pop_front();
-            log_assert(last_access_map.erase(wire_to_remove) == 1);
+            last_access_map.erase(wire_to_remove);
 
             removeWireFromCache(wire_to_remove);
         }
@@ -232,14 +291,16 @@ struct LruWireCacheMap
     bool isPipUphill(PipId pip, WireId wire)
     {
         checkCache(wire);
-        return pips_uphill.at(pip) == wire;
+        auto found = pips_uphill.find(pip);
+        return found != pips_uphill.end() && found->second == wire;
     }
 
     // Returns true if pip is downhill of wire (e.g. pip in getPipsDownhill(wire)).
     bool isPipDownhill(PipId pip, WireId wire)
     {
         checkCache(wire);
-        return pips_downhill.at(pip) == wire;
+        auto found = pips_downhill.find(pip);
+        return found != pips_downhill.end() && found->second == wire;
     }
 
     void cache_info() const
@@ -250,44 +311,57 @@ struct LruWireCacheMap
     }
 };
 
+struct WireCheckResult : CheckErrors
+{
+#ifndef USING_LRU_CACHE
+    std::vector<std::pair<PipId, WireId>> pips_downhill, pips_uphill;
+#endif
+};
+
 void archcheck_conn(const Context *ctx)
 {
     log_info("Checking connectivity data.\n");
 
     log_info("Checking all wires...\n");
 
+    auto wire_results =
+            check_parallel<WireCheckResult>(ctx, ctx->getWires(), [&](WireId wire, WireCheckResult &result) {
+                for (BelPin belpin : ctx->getWireBelPins(wire)) {
+                    WireId wire2 = ctx->getBelPinWire(belpin.bel, belpin.pin);
+                    check_assert(result, wire == wire2);
+                }
+
+                for (PipId pip : ctx->getPipsDownhill(wire)) {
+                    WireId wire2 = ctx->getPipSrcWire(pip);
+                    check_assert(result, wire == wire2);
 #ifndef USING_LRU_CACHE
-    dict<PipId, WireId> pips_downhill;
-    dict<PipId, WireId> pips_uphill;
+                    result.pips_downhill.emplace_back(pip, wire);
 #endif
+                }
 
-    for (WireId wire : ctx->getWires()) {
-        for (BelPin belpin : ctx->getWireBelPins(wire)) {
-            WireId wire2 = ctx->getBelPinWire(belpin.bel, belpin.pin);
-            log_assert(wire == wire2);
-        }
-
-        for (PipId pip : ctx->getPipsDownhill(wire)) {
-            WireId wire2 = ctx->getPipSrcWire(pip);
-            log_assert(wire == wire2);
+                for (PipId pip : ctx->getPipsUphill(wire)) {
+                    WireId wire2 = ctx->getPipDstWire(pip);
+                    check_assert(result, wire == wire2);
 #ifndef USING_LRU_CACHE
-            auto result = pips_downhill.emplace(pip, wire);
-            log_assert(result.second);
+                    result.pips_uphill.emplace_back(pip, wire);
 #endif
-        }
+                }
+            });
+    report_errors(wire_results, "wires");
 
-        for (PipId pip : ctx->getPipsUphill(wire)) {
-            WireId wire2 = ctx->getPipDstWire(pip);
-            log_assert(wire == wire2);
 #ifndef USING_LRU_CACHE
-            auto result = pips_uphill.emplace(pip, wire);
-            log_assert(result.second);
-#endif
-        }
+    dict<PipId, WireId> pips_downhill;
+    dict<PipId, WireId> pips_uphill;
+    for (auto &result : wire_results) {
+        for (auto &entry : result.pips_downhill)
+            log_assert(pips_downhill.insert(entry).second);
+        for (auto &entry : result.pips_uphill)
+            log_assert(pips_uphill.insert(entry).second);
     }
+#endif
 
     log_info("Checking all BELs...\n");
-    for (BelId bel : ctx->getBels()) {
+    auto bel_results = check_parallel<CheckErrors>(ctx, ctx->getBels(), [&](BelId bel, CheckErrors &errors) {
         for (IdString pin : ctx->getBelPins(bel)) {
             WireId wire = ctx->getBelPinWire(bel, pin);
 
@@ -303,40 +377,56 @@ void archcheck_conn(const Context *ctx)
                 }
             }
 
-            log_assert(found_belpin);
+            check_assert(errors, found_belpin);
         }
-    }
+    });
+    report_errors(bel_results, "bel pins");
+
+    log_info("Checking all PIPs...\n");
+    struct PipCheckResult : CheckErrors
+    {
 #ifdef USING_LRU_CACHE
-    // This cache is used to meet two goals:
-    //  - Avoid linear scan by invoking getPipsDownhill/getPipsUphill directly.
-    //  - Avoid having pip -> wire maps for the entire part.
-    //
-    // The overhead of maintaining the cache is small relatively to the memory
-    // gains by avoiding the full pip -> wire map, and still preserves a fast
-    // pip -> wire, assuming that pips are returned from getPips with some
-    // chip locality.
-    LruWireCacheMap pip_cache(ctx, /*cache_size=*/64 * 1024);
+        // This cache is used to meet two goals:
+        //  - Avoid linear scan by invoking getPipsDownhill/getPipsUphill directly.
+        //  - Avoid having pip -> wire maps for the entire part.
+        //
+        // The overhead of maintaining the cache is small relatively to the memory
+        // gains by avoiding the full pip -> wire map, and still preserves a fast
+        // pip -> wire, assuming that pips are returned from getPips with some
+        // chip locality. Each chunk has its own cache.
+        std::unique_ptr<LruWireCacheMap> pip_cache;
+#endif
+    };
+    auto pip_results = check_parallel<PipCheckResult>(ctx, ctx->getPips(), [&](PipId pip, PipCheckResult &result) {
+#ifdef USING_LRU_CACHE
+        if (!result.pip_cache)
+            result.pip_cache.reset(new LruWireCacheMap(ctx, /*cache_size=*/64 * 1024));
+        auto &pip_cache = *result.pip_cache;
 #endif
-    log_info("Checking all PIPs...\n");
-    for (PipId pip : ctx->getPips()) {
         WireId src_wire = ctx->getPipSrcWire(pip);
         if (src_wire != WireId()) {
 #ifdef USING_LRU_CACHE
-            log_assert(pip_cache.isPipDownhill(pip, src_wire));
+            check_assert(result, pip_cache.isPipDownhill(pip, src_wire));
 #else
-            log_assert(pips_downhill.at(pip) == src_wire);
+            check_assert(result, pips_downhill.count(pip) && pips_downhill.at(pip) == src_wire);
 #endif
         }
 
         WireId dst_wire = ctx->getPipDstWire(pip);
         if (dst_wire != WireId()) {
 #ifdef USING_LRU_CACHE
-            log_assert(pip_cache.isPipUphill(pip, dst_wire));
+            check_assert(result, pip_cache.isPipUphill(pip, dst_wire));
 #else
-            log_assert(pips_uphill.at(pip) == dst_wire);
+            check_assert(result, pips_uphill.count(pip) && pips_uphill.at(pip) == dst_wire);
 #endif
         }
-    }
+    });
+#ifdef USING_LRU_CACHE
+    for (auto &result : pip_results)
+        if (result.pip_cache)
+            check_assert(result, result.pip_cache->duplicate_pips == 0);
+#endif
+    report_errors(pip_results, "pips");
 }
 
 void archcheck_buckets(const Context *ctx)
@@ -346,50 +436,58 @@ void archcheck_buckets(const Context *ctx)
     // BEL buckets should be subsets of BELs that form an exact cover.
     // In particular that means cell types in a bucket should only be
     // placable in that bucket.
-    for (BelBucketId bucket : ctx->getBelBuckets()) {
-
-        // Find out which cell types are in this bucket.
-        pool<IdString> cell_types_in_bucket;
-        for (IdString cell_type : ctx->getCellTypes()) {
-            if (ctx->getBelBucketForCellType(cell_type) == bucket) {
-                cell_types_in_bucket.insert(cell_type);
-            }
-        }
-
-        // Make sure that all cell types in this bucket have at least one
-        // BelId they can be placed at.
-        pool<IdString> cell_types_unused;
-
-        pool<BelId> bels_in_bucket;
-        for (BelId bel : ctx->getBelsInBucket(bucket)) {
-            BelBucketId bucket2 = ctx->getBelBucketForBel(bel);
-            log_assert(bucket == bucket2);
-
-            bels_in_bucket.insert(bel);
-
-            // Check to see if a cell type not in this bucket can be
-            // placed at a BEL in this bucket.
+    std::vector<BelBucketId> buckets;
+    for (BelBucketId bucket : ctx->getBelBuckets())
+        buckets.push_back(bucket);
+    auto results = parallel_chunks<CheckErrors>(ctx, int(buckets.size()), 1, [&](int begin, int end,
+                                                                                CheckErrors &errors) {
+        for (int i = begin; i < end; i++) {
+            BelBucketId bucket = buckets.at(i);
+
+            // Find out which cell types are in this bucket.
+            pool<IdString> cell_types_in_bucket;
             for (IdString cell_type : ctx->getCellTypes()) {
                 if (ctx->getBelBucketForCellType(cell_type) == bucket) {
-                    if (ctx->isValidBelForCellType(cell_type, bel)) {
-                        cell_types_unused.erase(cell_type);
+                    cell_types_in_bucket.insert(cell_type);
+                }
+            }
+
+            // Make sure that all cell types in this bucket have at least one
+            // BelId they can be placed at.
+            pool<IdString> cell_types_unused;
+
+            pool<BelId> bels_in_bucket;
+            for (BelId bel : ctx->getBelsInBucket(bucket)) {
+                BelBucketId bucket2 = ctx->getBelBucketForBel(bel);
+                check_assert(errors, bucket == bucket2);
+
+                bels_in_bucket.insert(bel);
+
+                // Check to see if a cell type not in this bucket can be
+                // placed at a BEL in this bucket.
+                for (IdString cell_type : ctx->getCellTypes()) {
+                    if (ctx->getBelBucketForCellType(cell_type) == bucket) {
+                        if (ctx->isValidBelForCellType(cell_type, bel)) {
+                            cell_types_unused.erase(cell_type);
+                        }
+                    } else {
+                        check_assert(errors, !ctx->isValidBelForCellType(cell_type, bel));
                     }
-                } else {
-                    log_assert(!ctx->isValidBelForCellType(cell_type, bel));
                 }
             }
-        }
 
-        // Verify that any BEL not in this bucket reports a different
-        // bucket.
-        for (BelId bel : ctx->getBels()) {
-            if (ctx->getBelBucketForBel(bel) != bucket) {
-                log_assert(bels_in_bucket.count(bel) == 0);
+            // Verify that any BEL not in this bucket reports a different
+            // bucket.
+            for (BelId bel : ctx->getBels()) {
+                if (ctx->getBelBucketForBel(bel) != bucket) {
+                    check_assert(errors, bels_in_bucket.count(bel) == 0);
+                }
             }
-        }
 
-        log_assert(cell_types_unused.empty());
-    }
+            check_assert(errors, cell_types_unused.empty());
+        }
+    });
+    report_errors(results, "bel buckets");
 }
 
 } // namespace
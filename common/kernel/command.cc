@@ -29,6 +29,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/filesystem/convenience.hpp>
 #include <boost/program_options.hpp>
 #include <fstream>
@@ -38,15 +39,44 @@
 
 #include "command.h"
 #include "design_utils.h"
+#include "embed.h"
 #include "json_frontend.h"
 #include "jsonwrite.h"
 #include "log.h"
+#include "multi_seed.h"
 #include "timing.h"
 #include "util.h"
 #include "version.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
+namespace {
+// A successful --test run leaves an empty file in the user's cache directory, named by a hash of the nextpnr version,
+// the device and the checksums of the chipdbs it was loaded from, so an unchanged database is only checked once.
+// Returns an empty string if the database can't be identified or there is no cache directory.
+std::string archcheck_stamp_file(const Context *ctx)
+{
+    std::string chipdbs = get_chipdb_checksums();
+    if (chipdbs.empty())
+        return "";
+    const char *cache_home = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    boost::filesystem::path dir;
+    if (cache_home != nullptr && *cache_home != '\0')
+        dir = cache_home;
+    else if (home != nullptr && *home != '\0')
+        dir = boost::filesystem::path(home) / ".cache";
+    else
+        return "";
+    std::string key = stringf("%s;%s;%s;%s", GIT_DESCRIBE_STR, ctx->archId().c_str(ctx), ctx->getChipName().c_str(),
+                              chipdbs.c_str());
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : key)
+        hash = (hash ^ uint8_t(c)) * 1099511628211ULL;
+    return (dir / "nextpnr" / stringf("archcheck-%016llx", (unsigned long long)hash)).string();
+}
+} // namespace
+
 struct no_separator : std::numpunct<char>
 {
   protected:
@@ -155,6 +185,8 @@ po::options_description CommandHandler::getGeneralOptions()
     general.add_options()("top", po::value<std::string>(), "name of top module");
     general.add_options()("seed", po::value<int>(), "seed value for random number generator");
     general.add_options()("randomize-seed,r", "randomize seed value for random number generator");
+    general.add_options()("place-seeds", po::value<int>(),
+                          "run placement with N different seeds in parallel processes and keep the best result");
 
     general.add_options()(
             "placer", po::value<std::string>(),
@@ -180,9 +212,13 @@ po::options_description CommandHandler::getGeneralOptions()
 
     general.add_options()("ignore-loops", "ignore combinational loops in timing analysis");
     general.add_options()("ignore-rel-clk", "ignore clock-to-clock relations in timing checks");
+    general.add_options()("timing-corners", po::value<std::string>(),
+                          "extra timing corners to analyse, as comma separated name:cell_derate[:route_derate] "
+                          "(e.g. slow:1.2:1.1,fast:0.8)");
 
     general.add_options()("version,V", "show version");
     general.add_options()("test", "check architecture database integrity");
+    general.add_options()("test-no-cache", "always run the --test checks, even if they already passed for this chipdb");
     general.add_options()("freq", po::value<double>(), "set target frequency for design in MHz");
     general.add_options()("timing-allow-fail", "allow timing to fail in design");
     general.add_options()("no-tmdriv", "disable timing-driven placement");
@@ -287,6 +323,10 @@ void CommandHandler::setupContext(Context *ctx)
         ctx->settings[ctx->id("timing/ignoreRelClk")] = true;
     }
 
+    if (vm.count("timing-corners")) {
+        ctx->settings[ctx->id("timing/corners")] = vm["timing-corners"].as<std::string>();
+    }
+
     if (vm.count("timing-allow-fail")) {
         ctx->settings[ctx->id("timing/allowFail")] = true;
     }
@@ -391,7 +431,19 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         std::set_terminate(script_terminate_handler);
     }
     if (vm.count("test")) {
+        std::string stamp = vm.count("test-no-cache") ? "" : archcheck_stamp_file(ctx.get());
+        boost::system::error_code ec;
+        if (!stamp.empty() && boost::filesystem::exists(stamp, ec)) {
+            log_info("Architecture database integrity check already passed for this chipdb, skipping (use "
+                     "--test-no-cache to run it again).\n");
+            return 0;
+        }
         ctx->archcheck();
+        if (!stamp.empty()) {
+            // Failing to write the stamp only means the check will be run again next time
+            boost::filesystem::create_directories(boost::filesystem::path(stamp).parent_path(), ec);
+            std::ofstream stamp_file(stamp);
+        }
         return 0;
     }
 
@@ -461,7 +513,8 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
             bool saved_debug = ctx->debug;
             if (vm.count("debug-placer"))
                 ctx->debug = true;
-            if (!ctx->place() && !ctx->force)
+            int place_seeds = vm.count("place-seeds") ? vm["place-seeds"].as<int>() : 1;
+            if (!place_multi_seed(ctx.get(), place_seeds) && !ctx->force)
                 log_error("Placing design failed.\n");
             ctx->debug = saved_debug;
             ctx->check();
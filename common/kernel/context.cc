@@ -477,4 +477,17 @@ struct FixupHierarchyWorker
 
 void Context::fixupHierarchy() { FixupHierarchyWorker(this).run(); }
 
+const std::vector<BelId> &Context::getBelsForCellType(IdString cell_type)
+{
+    auto found = bels_for_cell_type.find(cell_type);
+    if (found != bels_for_cell_type.end())
+        return found->second;
+    auto &bels = bels_for_cell_type[cell_type];
+    for (auto bel : getBels()) {
+        if (isValidBelForCellType(cell_type, bel))
+            bels.push_back(bel);
+    }
+    return bels;
+}
+
 NEXTPNR_NAMESPACE_END
@@ -89,6 +89,16 @@ struct Context : Arch, DeterministicRNG
 
     // --------------------------------------------------------------
 
+    // All bels that a cell type may be placed at, regardless of whether they are currently bound. This is built on
+    // first use for each cell type and kept for the lifetime of the context, so that the placers don't each repeat
+    // the scan of every bel through isValidBelForCellType. Not thread safe.
+    const std::vector<BelId> &getBelsForCellType(IdString cell_type);
+    // Must be called if bels are added or changed after the arch has been constructed
+    void invalidateBelsForCellType() { bels_for_cell_type.clear(); }
+    dict<IdString, std::vector<BelId>> bels_for_cell_type;
+
+    // --------------------------------------------------------------
+
     // provided by sdf.cc
     void writeSDF(std::ostream &out, bool cvc_mode = false) const;
 
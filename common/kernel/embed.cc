@@ -1,3 +1,5 @@
+#include <chrono>
+#include <cstring>
 #include <map>
 #if defined(WIN32)
 #include <windows.h>
@@ -5,22 +7,107 @@
 #include <boost/filesystem.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include "embed.h"
+#include "log.h"
 #include "nextpnr.h"
 
+#ifdef NEXTPNR_COMPRESSED_CHIPDB
+#include <zlib.h>
+#endif
+
 NEXTPNR_NAMESPACE_BEGIN
 
+namespace {
+uint32_t chipdb_checksum(const uint8_t *data, uint32_t size)
+{
+    uint32_t checksum = 2166136261U;
+    for (uint32_t i = 0; i < size; i++)
+        checksum = (checksum ^ data[i]) * 16777619U;
+    return checksum;
+}
+
+// Header checksum of each chipdb that has been loaded, or nothing for headerless databases
+std::map<std::string, std::pair<bool, uint32_t>> loaded_checksums;
+
+} // namespace
+
+const void *get_chipdb_data(const void *blob, size_t size, const std::string &filename, bool verify_checksum)
+{
+    if (blob == nullptr)
+        return nullptr;
+    ChipdbHeader hdr;
+    if (size != 0 && size < sizeof(hdr))
+        log_error("chipdb '%s' is truncated.\n", filename.c_str());
+    memcpy(&hdr, blob, sizeof(hdr));
+    if (hdr.magic != ChipdbHeader::magic_value) {
+        loaded_checksums[filename] = std::make_pair(false, 0);
+        return blob; // legacy headerless database
+    }
+    if (hdr.version != ChipdbHeader::current_version)
+        log_error("chipdb '%s' has container version %u, but this build of nextpnr expects version %u. Please rebuild "
+                  "the chipdb.\n",
+                  filename.c_str(), unsigned(hdr.version), unsigned(ChipdbHeader::current_version));
+    if (size != 0 && size_t(hdr.header_size) + hdr.stored_size > size)
+        log_error("chipdb '%s' is truncated (expected %u bytes, got %u).\n", filename.c_str(),
+                  unsigned(hdr.header_size + hdr.stored_size), unsigned(size));
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(blob) + hdr.header_size;
+    loaded_checksums[filename] = std::make_pair(true, hdr.checksum);
+    if (hdr.flags & ChipdbHeader::flag_compressed) {
+#ifdef NEXTPNR_COMPRESSED_CHIPDB
+        // The database is made up of relative pointers between all of its sections, so it is decompressed as a whole
+        // the first time it is used, and kept for the lifetime of the process
+        static std::map<std::string, std::vector<uint8_t>> decompressed;
+        auto &buf = decompressed[filename];
+        if (buf.empty()) {
+            auto start = std::chrono::high_resolution_clock::now();
+            buf.resize(hdr.data_size);
+            uLongf dest_size = hdr.data_size;
+            if (uncompress(buf.data(), &dest_size, data, hdr.stored_size) != Z_OK || dest_size != hdr.data_size)
+                log_error("chipdb '%s' failed to decompress.\n", filename.c_str());
+            if (chipdb_checksum(buf.data(), hdr.data_size) != hdr.checksum)
+                log_error("chipdb '%s' is corrupt (checksum mismatch).\n", filename.c_str());
+            auto end = std::chrono::high_resolution_clock::now();
+            log_info("Decompressed chipdb '%s' (%.2f MB to %.2f MB) in %.02fs\n", filename.c_str(),
+                     hdr.stored_size / (1024.0 * 1024.0), hdr.data_size / (1024.0 * 1024.0),
+                     std::chrono::duration<float>(end - start).count());
+        }
+        return buf.data();
+#else
+        log_error("chipdb '%s' is compressed, but nextpnr was built without COMPRESS_CHIPDB.\n", filename.c_str());
+#endif
+    }
+#ifdef NDEBUG
+    if (verify_checksum)
+#endif
+        if (chipdb_checksum(data, hdr.data_size) != hdr.checksum)
+            log_error("chipdb '%s' is corrupt (checksum mismatch).\n", filename.c_str());
+    return data;
+}
+
+std::string get_chipdb_checksums()
+{
+    std::string result;
+    for (auto &entry : loaded_checksums) {
+        if (!entry.second.first)
+            return "";
+        result += stringf("%s:%08x;", entry.first.c_str(), unsigned(entry.second.second));
+    }
+    return result;
+}
+
 #if defined(EXTERNAL_CHIPDB_ROOT)
 
 const void *get_chipdb(const std::string &filename)
 {
-    static std::map<std::string, boost::iostreams::mapped_file> files;
+    // Mapped read-only and shared, so the page cache is shared between concurrent nextpnr processes and only the pages
+    // that are actually used get read in
+    static std::map<std::string, boost::iostreams::mapped_file_source> files;
     if (!files.count(filename)) {
         std::string full_filename = EXTERNAL_CHIPDB_ROOT "/" + filename;
         if (boost::filesystem::exists(full_filename))
-            files[filename].open(full_filename, boost::iostreams::mapped_file::priv);
+            files[filename].open(full_filename);
     }
     if (files.count(filename))
-        return files.at(filename).data();
+        return get_chipdb_data(files.at(filename).data(), files.at(filename).size(), filename);
     return nullptr;
 }
 
@@ -30,7 +117,7 @@ const void *get_chipdb(const std::string &filename)
 {
     HRSRC rc = ::FindResource(nullptr, filename.c_str(), RT_RCDATA);
     HGLOBAL rcData = ::LoadResource(nullptr, rc);
-    return ::LockResource(rcData);
+    return get_chipdb_data(::LockResource(rcData), ::SizeofResource(nullptr, rc), filename);
 }
 
 #else
@@ -41,7 +128,7 @@ const void *get_chipdb(const std::string &filename)
 {
     for (EmbeddedFile *file = EmbeddedFile::head; file; file = file->next)
         if (file->filename == filename)
-            return file->content;
+            return get_chipdb_data(file->content, 0, filename);
     return nullptr;
 }
 
@@ -42,8 +42,47 @@ struct EmbeddedFile
 
 #endif
 
+// Binary and compressed chipdbs written by bbasm start with this header, followed by a table of the streams that make
+// up the database and then the database itself (starting on a page boundary for uncompressed files, so it can be
+// mapped directly). Headerless databases (such as those embedded as C strings) are still accepted.
+struct ChipdbHeader
+{
+    static const uint32_t magic_value = 0x4244504e; // "NPDB"
+    static const uint32_t current_version = 2;
+    static const uint32_t flag_compressed = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    // Offset of the database from the start of the file
+    uint32_t header_size;
+    uint32_t num_sections;
+    uint32_t data_size;
+    // FNV-1a hash of the (uncompressed) database, only checked in debug builds or after decompression, as it means
+    // reading the whole file
+    uint32_t checksum;
+    uint32_t flags;
+    // Size of the database as stored, which is smaller than data_size if it is zlib compressed
+    uint32_t stored_size;
+};
+
+struct ChipdbSection
+{
+    char name[24];
+    uint32_t offset;
+    uint32_t size;
+};
+
 const void *get_chipdb(const std::string &filename);
 
+// Skip and validate the header of a chipdb blob, if it has one, returning the start of the database. size is zero if
+// the size of the blob is not known. The checksum of an uncompressed database is only verified in debug builds, unless
+// verify_checksum is set. This is used by get_chipdb, and by arches that load a chipdb from a path given by the user.
+const void *get_chipdb_data(const void *blob, size_t size, const std::string &filename, bool verify_checksum = false);
+
+// Identifies the chipdbs loaded so far by name and header checksum, for caching results derived from them. Empty if no
+// chipdb has been loaded, or if any of them is a headerless database without a checksum.
+std::string get_chipdb_checksums();
+
 NEXTPNR_NAMESPACE_END
 
 #endif // EMBED_H
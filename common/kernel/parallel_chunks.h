@@ -0,0 +1,86 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef PARALLEL_CHUNKS_H
+#define PARALLEL_CHUNKS_H
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+#include "nextpnr.h"
+
+#if !defined(NPNR_DISABLE_THREADS)
+#include <thread>
+#endif
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// The number of threads to use for passes that split their work into independent chunks: the value of --threads if
+// set, otherwise the number of cores
+inline int get_parallel_threads(const Context *ctx)
+{
+#if defined(NPNR_DISABLE_THREADS)
+    return 1;
+#else
+    auto found = ctx->settings.find(ctx->id("threads"));
+    if (found != ctx->settings.end())
+        return std::max(1, found->second.is_string ? std::stoi(found->second.as_string())
+                                                   : int(found->second.as_int64()));
+    return std::max(1, int(std::thread::hardware_concurrency()));
+#endif
+}
+
+// Split [0, count) into contiguous chunks of at least min_chunk items, and run func(begin, end, result) for each chunk
+// on its own thread. Each chunk writes into its own result, and results are returned in chunk order, so that callers
+// can combine them into the same output as a serial pass over the whole range. func must only read shared state; in
+// particular it must not create new IdStrings.
+template <typename TResult, typename TFunc>
+std::vector<TResult> parallel_chunks(const Context *ctx, int count, int min_chunk, TFunc func)
+{
+    int n_chunks = std::max(1, std::min(get_parallel_threads(ctx), count / std::max(1, min_chunk)));
+    std::vector<TResult> results(n_chunks);
+    if (n_chunks == 1) {
+        func(0, count, results.at(0));
+        return results;
+    }
+#if !defined(NPNR_DISABLE_THREADS)
+    // Errors (such as from log_error) are passed back to the calling thread
+    std::vector<std::exception_ptr> errors(n_chunks);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n_chunks; i++) {
+        workers.emplace_back([&, i]() {
+            try {
+                func((int64_t(count) * i) / n_chunks, (int64_t(count) * (i + 1)) / n_chunks, results.at(i));
+            } catch (...) {
+                errors.at(i) = std::current_exception();
+            }
+        });
+    }
+    for (auto &w : workers)
+        w.join();
+    for (auto &e : errors)
+        if (e)
+            std::rethrow_exception(e);
+#endif
+    return results;
+}
+
+NEXTPNR_NAMESPACE_END
+
+#endif
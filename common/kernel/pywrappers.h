@@ -205,6 +205,11 @@ struct fn_wrapper_2a
     }
 
     template <typename WrapCls> static void def_wrap(WrapCls cls_, const char *name) { cls_.def(name, wrapped_fn); }
+
+    template <typename WrapCls, typename... Ta> static void def_wrap(WrapCls cls_, const char *name, Ta... a)
+    {
+        cls_.def(name, wrapped_fn, a...);
+    }
 };
 
 // Three parameters, one return
@@ -20,9 +20,9 @@
 
 #include "timing.h"
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
-#include <deque>
+#include <cstdlib>
 #include <map>
+#include <sstream>
 #include <utility>
 #include "log.h"
 #include "util.h"
@@ -35,6 +35,7 @@ const char *edge_name(ClockEdge edge) { return (edge == FALLING_EDGE) ? "negedge
 
 void TimingAnalyser::setup()
 {
+    init_corners();
     init_ports();
     get_cell_delays();
     topo_sort();
@@ -54,6 +55,47 @@ void TimingAnalyser::run(bool update_route_delays)
     compute_criticality();
 }
 
+void TimingAnalyser::init_corners()
+{
+    if (corners.empty() && ctx->settings.count(ctx->id("timing/corners"))) {
+        // Corners are given as name:cell_derate[:route_derate], separated by commas
+        std::istringstream spec(ctx->settings.at(ctx->id("timing/corners")).as_string());
+        std::string entry;
+        while (std::getline(spec, entry, ',')) {
+            std::istringstream entry_ss(entry);
+            std::string name, cell_derate, route_derate;
+            std::getline(entry_ss, name, ':');
+            std::getline(entry_ss, cell_derate, ':');
+            std::getline(entry_ss, route_derate, ':');
+            auto parse_derate = [&](const std::string &value) {
+                char *end = nullptr;
+                float derate = std::strtof(value.c_str(), &end);
+                if (value.empty() || *end != '\0' || derate <= 0)
+                    log_error("Invalid derate '%s' for timing corner '%s'.\n", value.c_str(), name.c_str());
+                return derate;
+            };
+            if (name.empty())
+                log_error("Timing corner '%s' has no name.\n", entry.c_str());
+            TimingCorner corner;
+            corner.name = ctx->id(name);
+            corner.cell_derate = parse_derate(cell_derate);
+            corner.route_derate = route_derate.empty() ? corner.cell_derate : parse_derate(route_derate);
+            corners.push_back(corner);
+        }
+    }
+    if (int(corners.size()) > MAX_CORNERS)
+        log_error("At most %d extra timing corners can be analysed, but %d were given.\n", MAX_CORNERS,
+                  int(corners.size()));
+}
+
+TimingAnalyser::CornerDelays TimingAnalyser::corner_delays(delay_t delay, bool is_route) const
+{
+    CornerDelays result{};
+    for (int i = 0; i < int(corners.size()); i++)
+        result[i] = delay_t(delay * (is_route ? corners[i].route_derate : corners[i].cell_derate));
+    return result;
+}
+
 void TimingAnalyser::init_ports()
 {
     // Per cell port structures
@@ -130,24 +172,36 @@ void TimingAnalyser::get_cell_delays()
                     pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
             }
         }
+        if (!corners.empty())
+            for (auto &arc : pd.cell_arcs)
+                arc.corner_value = corner_delays(arc.value.maxDelay(), false);
     }
 }
 
 void TimingAnalyser::get_route_delays()
 {
-    for (auto &net : ctx->nets) {
-        NetInfo *ni = net.second.get();
-        if (ni->driver.cell == nullptr || ni->driver.cell->bel == BelId())
+    for (auto &net : ctx->nets)
+        update_route_delays(net.second.get());
+}
+
+void TimingAnalyser::update_route_delays(const NetInfo *net)
+{
+    if (net->driver.cell == nullptr || net->driver.cell->bel == BelId())
+        return;
+    for (auto &usr : net->users) {
+        if (usr.cell->bel == BelId())
             continue;
-        for (auto &usr : ni->users) {
-            if (usr.cell->bel == BelId())
-                continue;
-            ports.at(CellPortKey(usr)).route_delay = DelayPair(ctx->getNetinfoRouteDelay(ni, usr));
-        }
+        set_route_delay(CellPortKey(usr), DelayPair(ctx->getNetinfoRouteDelay(net, usr)));
     }
 }
 
-void TimingAnalyser::set_route_delay(CellPortKey port, DelayPair value) { ports.at(port).route_delay = value; }
+void TimingAnalyser::set_route_delay(CellPortKey port, DelayPair value)
+{
+    auto &pd = ports.at(port);
+    pd.route_delay = value;
+    if (!corners.empty())
+        pd.corner_route_delay = corner_delays(value.maxDelay(), true);
+}
 
 void TimingAnalyser::topo_sort()
 {
@@ -212,6 +266,11 @@ void TimingAnalyser::setup_port_domains()
                         pd.arrival[dom];
                         domains.at(dom).startpoints.emplace_back(port, fanin.other_port);
                     }
+                    if (async_paths && pi.net != nullptr && port_class(port) == TMG_STARTPOINT) {
+                        auto dom = domain_id(ClockDomainKey(IdString(), RISING_EDGE));
+                        pd.arrival[dom];
+                        domains.at(dom).startpoints.emplace_back(port, IdString());
+                    }
                 }
                 // copy domains across routing
                 if (pi.net != nullptr)
@@ -248,6 +307,12 @@ void TimingAnalyser::setup_port_domains()
                         pd.required[dom];
                         domains.at(dom).endpoints.emplace_back(port, fanout.other_port);
                     }
+                    if (async_paths && pi.net != nullptr && pi.net->driver.cell != nullptr &&
+                        port_class(port) == TMG_ENDPOINT) {
+                        auto dom = domain_id(ClockDomainKey(IdString(), RISING_EDGE));
+                        pd.required[dom];
+                        domains.at(dom).endpoints.emplace_back(port, IdString());
+                    }
                 }
                 // copy port to driver
                 if (pi.net != nullptr && pi.net->driver.cell != nullptr)
@@ -269,22 +334,29 @@ void TimingAnalyser::setup_port_domains()
     for (auto &dp : domain_pairs) {
         auto &launch_data = domains.at(dp.key.launch);
         auto &capture_data = domains.at(dp.key.capture);
-        if (launch_data.key.clock != capture_data.key.clock)
-            continue;
-        IdString clk = launch_data.key.clock;
-        delay_t period = ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
-        if (ctx->nets.count(clk)) {
-            NetInfo *clk_net = ctx->nets.at(clk).get();
-            if (clk_net->clkconstr) {
-                period = clk_net->clkconstr->period.minDelay();
-            }
-        }
+        delay_t period = clock_period(capture_data.key.clock);
         if (launch_data.key.edge != capture_data.key.edge)
             period /= 2;
         dp.period = DelayPair(period);
     }
 }
 
+TimingPortClass TimingAnalyser::port_class(const CellPortKey &port)
+{
+    int clkInfoCount = 0;
+    return ctx->getPortTimingClass(cell_info(port), port.port, clkInfoCount);
+}
+
+delay_t TimingAnalyser::clock_period(IdString clock) const
+{
+    if (clock != IdString() && ctx->nets.count(clock)) {
+        const NetInfo *clk_net = ctx->nets.at(clock).get();
+        if (clk_net->clkconstr)
+            return clk_net->clkconstr->period.minDelay();
+    }
+    return ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
+}
+
 void TimingAnalyser::identify_related_domains()
 {
 
@@ -363,6 +435,8 @@ void TimingAnalyser::identify_related_domains()
     // Identify possible drivers for each clock domain
     dict<IdString, dict<IdString, delay_t>> clock_drivers;
     for (const auto &domain : domains) {
+        if (domain.key.is_async())
+            continue;
 
         const NetInfo *ni = ctx->nets.at(domain.key.clock).get();
         if (ni == nullptr)
@@ -444,18 +518,20 @@ void TimingAnalyser::identify_related_domains()
 void TimingAnalyser::reset_times()
 {
     for (auto &port : ports) {
-        auto do_reset = [&](dict<domain_id_t, ArrivReqTime> &times) {
+        auto do_reset = [&](dict<domain_id_t, ArrivReqTime> &times, delay_t corner_init) {
             for (auto &t : times) {
                 t.second.value = init_delay;
+                t.second.corner_value.fill(corner_init);
                 t.second.path_length = 0;
                 t.second.bwd_min = CellPortKey();
                 t.second.bwd_max = CellPortKey();
             }
         };
-        do_reset(port.second.arrival);
-        do_reset(port.second.required);
+        do_reset(port.second.arrival, std::numeric_limits<delay_t>::lowest());
+        do_reset(port.second.required, std::numeric_limits<delay_t>::max());
         for (auto &dp : port.second.domain_pairs) {
             dp.second.setup_slack = std::numeric_limits<delay_t>::max();
+            dp.second.corner_setup_slack.fill(std::numeric_limits<delay_t>::max());
             dp.second.hold_slack = std::numeric_limits<delay_t>::max();
             dp.second.max_path_length = 0;
             dp.second.criticality = 0;
@@ -467,10 +543,14 @@ void TimingAnalyser::reset_times()
     }
 }
 
-void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                                      CellPortKey prev)
+void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival,
+                                      const CornerDelays &corner_from, const CornerDelays &corner_delay,
+                                      int path_length, CellPortKey prev)
 {
     auto &arr = ports.at(target).arrival.at(domain);
+    if (!corners.empty())
+        for (int i = 0; i < MAX_CORNERS; i++)
+            arr.corner_value[i] = std::max(arr.corner_value[i], corner_from[i] + corner_delay[i]);
     if (arrival.max_delay > arr.value.max_delay) {
         arr.value.max_delay = arrival.max_delay;
         arr.bwd_max = prev;
@@ -482,10 +562,14 @@ void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, De
     arr.path_length = std::max(arr.path_length, path_length);
 }
 
-void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                                       CellPortKey prev)
+void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, DelayPair required,
+                                       const CornerDelays &corner_from, const CornerDelays &corner_delay,
+                                       int path_length, CellPortKey prev)
 {
     auto &req = ports.at(target).required.at(domain);
+    if (!corners.empty())
+        for (int i = 0; i < MAX_CORNERS; i++)
+            req.corner_value[i] = std::min(req.corner_value[i], corner_from[i] - corner_delay[i]);
     if (required.min_delay < req.value.min_delay) {
         req.value.min_delay = required.min_delay;
         req.bwd_min = prev;
@@ -505,6 +589,7 @@ void TimingAnalyser::walk_forward()
         for (auto &sp : dom.startpoints) {
             auto &pd = ports.at(sp.first);
             DelayPair init_arrival(0);
+            CornerDelays corner_clk_to_q{};
             CellPortKey clock_key;
             // TODO: clock routing delay, if analysis of that is enabled
             if (sp.second != IdString()) {
@@ -512,12 +597,13 @@ void TimingAnalyser::walk_forward()
                 for (auto &fanin : pd.cell_arcs) {
                     if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == sp.second) {
                         init_arrival = init_arrival + fanin.value.delayPair();
+                        corner_clk_to_q = fanin.corner_value;
                         break;
                     }
                 }
                 clock_key = CellPortKey(sp.first.cell, sp.second);
             }
-            set_arrival_time(sp.first, dom_id, init_arrival, 1, clock_key);
+            set_arrival_time(sp.first, dom_id, init_arrival, CornerDelays{}, corner_clk_to_q, 1, clock_key);
         }
     }
     // Walk forward in topological order
@@ -532,7 +618,8 @@ void TimingAnalyser::walk_forward()
                         CellPortKey usr_key(usr);
                         auto &usr_pd = ports.at(usr_key);
                         set_arrival_time(usr_key, arr.first, arr.second.value + usr_pd.route_delay,
-                                         arr.second.path_length, p);
+                                         arr.second.corner_value, usr_pd.corner_route_delay, arr.second.path_length,
+                                         p);
                     }
             } else if (pd.type == PORT_IN) {
                 // Input port; propagate delay through cell, adding combinational delay
@@ -540,7 +627,8 @@ void TimingAnalyser::walk_forward()
                     if (fanout.type != CellArc::COMBINATIONAL)
                         continue;
                     set_arrival_time(CellPortKey(p.cell, fanout.other_port), arr.first,
-                                     arr.second.value + fanout.value.delayPair(), arr.second.path_length + 1, p);
+                                     arr.second.value + fanout.value.delayPair(), arr.second.corner_value,
+                                     fanout.corner_value, arr.second.path_length + 1, p);
                 }
             }
         }
@@ -557,19 +645,22 @@ void TimingAnalyser::walk_backward()
         for (auto &ep : dom.endpoints) {
             auto &pd = ports.at(ep.first);
             DelayPair init_setuphold(0);
+            CornerDelays corner_setup{};
             CellPortKey clock_key;
             // TODO: clock routing delay, if analysis of that is enabled
             if (ep.second != IdString()) {
                 // Add setup/hold time, if this endpoint is clocked
                 for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type == CellArc::SETUP && fanin.other_port == ep.second)
+                    if (fanin.type == CellArc::SETUP && fanin.other_port == ep.second) {
                         init_setuphold.min_delay -= fanin.value.maxDelay();
+                        corner_setup = fanin.corner_value;
+                    }
                     if (fanin.type == CellArc::HOLD && fanin.other_port == ep.second)
                         init_setuphold.max_delay -= fanin.value.maxDelay();
                 }
                 clock_key = CellPortKey(ep.first.cell, ep.second);
             }
-            set_required_time(ep.first, dom_id, init_setuphold, 1, clock_key);
+            set_required_time(ep.first, dom_id, init_setuphold, CornerDelays{}, corner_setup, 1, clock_key);
         }
     }
     // Walk backwards in topological order
@@ -581,16 +672,16 @@ void TimingAnalyser::walk_backward()
                 NetInfo *net = port_info(p).net;
                 if (net != nullptr && net->driver.cell != nullptr)
                     set_required_time(CellPortKey(net->driver), req.first,
-                                      req.second.value - DelayPair(pd.route_delay.maxDelay()), req.second.path_length,
-                                      p);
+                                      req.second.value - DelayPair(pd.route_delay.maxDelay()), req.second.corner_value,
+                                      pd.corner_route_delay, req.second.path_length, p);
             } else if (pd.type == PORT_OUT) {
                 // Output port : propagate delay back through cell, subtracting combinational delay
                 for (auto &fanin : pd.cell_arcs) {
                     if (fanin.type != CellArc::COMBINATIONAL)
                         continue;
                     set_required_time(CellPortKey(p.cell, fanin.other_port), req.first,
-                                      req.second.value - DelayPair(fanin.value.maxDelay()), req.second.path_length + 1,
-                                      p);
+                                      req.second.value - DelayPair(fanin.value.maxDelay()), req.second.corner_value,
+                                      fanin.corner_value, req.second.path_length + 1, p);
                 }
             }
         }
@@ -622,6 +713,7 @@ void TimingAnalyser::compute_slack()
     for (auto &dp : domain_pairs) {
         dp.worst_setup_slack = std::numeric_limits<delay_t>::max();
         dp.worst_hold_slack = std::numeric_limits<delay_t>::max();
+        dp.corner_worst_setup_slack.fill(std::numeric_limits<delay_t>::max());
     }
     for (auto p : topological_order) {
         auto &pd = ports.at(p);
@@ -652,20 +744,72 @@ void TimingAnalyser::compute_slack()
                 pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.second.hold_slack);
                 dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.second.hold_slack);
             }
+            if (!corners.empty()) {
+                auto &corner_slack = pdp.second.corner_setup_slack;
+                for (int i = 0; i < MAX_CORNERS; i++) {
+                    corner_slack[i] = 0 - (arr.corner_value[i] - req.corner_value[i] + clock_to_clock);
+                    dp.corner_worst_setup_slack[i] = std::min(dp.corner_worst_setup_slack[i], corner_slack[i]);
+                }
+            }
         }
     }
 }
 
+delay_t TimingAnalyser::get_worst_setup_slack() const
+{
+    delay_t worst = std::numeric_limits<delay_t>::max();
+    for (auto &dp : domain_pairs) {
+        if (dp.key.launch != dp.key.capture || dp.worst_setup_slack == std::numeric_limits<delay_t>::max())
+            continue;
+        worst = std::min(worst, dp.period.minDelay() + dp.worst_setup_slack);
+    }
+    return worst;
+}
+
+delay_t TimingAnalyser::get_corner_setup_slack(int corner) const
+{
+    delay_t worst = std::numeric_limits<delay_t>::max();
+    for (auto &dp : domain_pairs) {
+        delay_t worst_slack = dp.corner_worst_setup_slack.at(corner);
+        if (dp.key.launch != dp.key.capture || worst_slack == std::numeric_limits<delay_t>::max())
+            continue;
+        worst = std::min(worst, dp.period.minDelay() + worst_slack);
+    }
+    return worst;
+}
+
+dict<IdString, float> TimingAnalyser::get_corner_fmax(int corner) const
+{
+    dict<IdString, float> fmax;
+    for (auto &dp : domain_pairs) {
+        const auto &launch = domains.at(dp.key.launch).key;
+        const auto &capture = domains.at(dp.key.capture).key;
+        delay_t worst_slack = dp.corner_worst_setup_slack.at(corner);
+        if (launch.clock != capture.clock || launch.is_async() || worst_slack == std::numeric_limits<delay_t>::max())
+            continue;
+        float clock_fmax = ((launch.edge == capture.edge) ? 1000 : 500) / ctx->getDelayNS(-worst_slack);
+        if (!fmax.count(launch.clock) || clock_fmax < fmax.at(launch.clock))
+            fmax[launch.clock] = clock_fmax;
+    }
+    return fmax;
+}
+
 void TimingAnalyser::compute_criticality()
 {
+    auto get_crit = [](delay_t slack, delay_t worst_slack) {
+        float crit = 1.0f - (float(slack) - float(worst_slack)) / float(-worst_slack);
+        crit = std::min(crit, 1.0f);
+        crit = std::max(crit, 0.0f);
+        return crit;
+    };
     for (auto p : topological_order) {
         auto &pd = ports.at(p);
         for (auto &pdp : pd.domain_pairs) {
             auto &dp = domain_pairs.at(pdp.first);
-            float crit =
-                    1.0f - (float(pdp.second.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
-            crit = std::min(crit, 1.0f);
-            crit = std::max(crit, 0.0f);
+            float crit = get_crit(pdp.second.setup_slack, dp.worst_setup_slack);
+            // Use the worst corner, so that paths which are only critical at one corner still get optimised
+            for (int i = 0; i < int(corners.size()); i++)
+                crit = std::max(crit, get_crit(pdp.second.corner_setup_slack[i], dp.corner_worst_setup_slack[i]));
             pdp.second.criticality = crit;
             pd.worst_crit = std::max(pd.worst_crit, crit);
         }
@@ -743,7 +887,10 @@ domain_id_t TimingAnalyser::domain_id(IdString cell, IdString clock_port, ClockE
 domain_id_t TimingAnalyser::domain_id(const NetInfo *net, ClockEdge edge)
 {
     NPNR_ASSERT(net != nullptr);
-    ClockDomainKey key{net->name, edge};
+    return domain_id(ClockDomainKey{net->name, edge});
+}
+domain_id_t TimingAnalyser::domain_id(const ClockDomainKey &key)
+{
     auto inserted = domain_to_id.emplace(key, domains.size());
     if (inserted.second) {
         domains.emplace_back(key);
@@ -772,463 +919,191 @@ CellInfo *TimingAnalyser::cell_info(const CellPortKey &key) { return ctx->cells.
 
 PortInfo &TimingAnalyser::port_info(const CellPortKey &key) { return ctx->cells.at(key.cell)->ports.at(key.port); }
 
-/** LEGACY CODE BEGIN **/
-
-typedef std::vector<const PortRef *> PortRefVector;
-typedef std::map<int, unsigned> DelayFrequency;
-
-struct CriticalPathData
+ClockEvent TimingAnalyser::clock_event(domain_id_t domain) const
 {
-    PortRefVector ports;
-    delay_t path_delay;
-    delay_t path_period;
-};
-
-typedef dict<ClockPair, CriticalPathData> CriticalPathDataMap;
-
-typedef dict<IdString, std::vector<NetSinkTiming>> DetailedNetTimings;
+    const auto &key = domains.at(domain).key;
+    return ClockEvent{key.is_async() ? ctx->id("$async$") : key.clock, key.edge};
+}
 
-struct Timing
+CriticalPath TimingAnalyser::build_critical_path(CellPortKey endpoint, domain_id_t domain_pair) const
 {
-    Context *ctx;
-    bool net_delays;
-    bool update;
-    delay_t min_slack;
-    CriticalPathDataMap *crit_path;
-    DelayFrequency *slack_histogram;
-    DetailedNetTimings *detailed_net_timings;
-    IdString async_clock;
-
-    struct TimingData
-    {
-        TimingData() : max_arrival(), max_path_length(), min_remaining_budget() {}
-        TimingData(delay_t max_arrival) : max_arrival(max_arrival), max_path_length(), min_remaining_budget() {}
-        delay_t max_arrival;
-        unsigned max_path_length = 0;
-        delay_t min_remaining_budget;
-        bool false_startpoint = false;
-        std::vector<delay_t> min_required;
-        dict<ClockEvent, delay_t> arrival_time;
-    };
+    auto &dp = domain_pairs.at(domain_pair);
+    auto &ep_data = ports.at(endpoint);
+    auto &req = ep_data.required.at(dp.key.capture);
 
-    Timing(Context *ctx, bool net_delays, bool update, CriticalPathDataMap *crit_path = nullptr,
-           DelayFrequency *slack_histogram = nullptr, DetailedNetTimings *detailed_net_timings = nullptr)
-            : ctx(ctx), net_delays(net_delays), update(update), min_slack(1.0e12 / ctx->setting<float>("target_freq")),
-              crit_path(crit_path), slack_histogram(slack_histogram), detailed_net_timings(detailed_net_timings),
-              async_clock(ctx->id("$async$"))
-    {
+    CriticalPath report;
+    report.clock_pair = ClockPair{clock_event(dp.key.launch), clock_event(dp.key.capture)};
+    report.delay = ep_data.arrival.at(dp.key.launch).value.maxDelay() - req.value.minDelay();
+    report.period = dp.period.minDelay();
+
+    // Ports on the path, from the clock port of a registered startpoint (if any) to the endpoint
+    std::vector<CellPortKey> path;
+    for (CellPortKey cursor = endpoint; cursor != CellPortKey();) {
+        path.push_back(cursor);
+        auto &arrival = ports.at(cursor).arrival;
+        auto found = arrival.find(dp.key.launch);
+        if (found == arrival.end())
+            break;
+        cursor = found->second.bwd_max;
     }
+    std::reverse(path.begin(), path.end());
+
+    auto add_segment = [&](CriticalPath::Segment::Type type, const CellPortKey &from, const CellPortKey &to,
+                           delay_t delay) -> CriticalPath::Segment & {
+        CriticalPath::Segment seg;
+        seg.type = type;
+        seg.delay = delay;
+        seg.budget = 0;
+        seg.from = std::make_pair(from.cell, from.port);
+        seg.to = std::make_pair(to.cell, to.port);
+        report.segments.push_back(seg);
+        return report.segments.back();
+    };
+    auto arc_delay = [&](const CellPortKey &port, CellArc::ArcType type, IdString other_port) {
+        for (auto &arc : ports.at(port).cell_arcs)
+            if (arc.type == type && arc.other_port == other_port)
+                return arc.value.maxDelay();
+        return delay_t(0);
+    };
 
-    delay_t walk_paths()
-    {
-        const auto clk_period = ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
-
-        // First, compute the topological order of nets to walk through the circuit, assuming it is a _acyclic_ graph
-        // TODO(eddieh): Handle the case where it is cyclic, e.g. combinatorial loops
-        std::vector<NetInfo *> topological_order;
-        dict<const NetInfo *, dict<ClockEvent, TimingData>, hash_ptr_ops> net_data;
-        // In lieu of deleting edges from the graph, simply count the number of fanins to each output port
-        dict<const PortInfo *, unsigned, hash_ptr_ops> port_fanin;
-
-        std::vector<IdString> input_ports;
-        std::vector<const PortInfo *> output_ports;
-
-        pool<IdString> ooc_port_nets;
-
-        // In out-of-context mode, top-level inputs look floating but aren't
-        if (bool_or_default(ctx->settings, ctx->id("arch.ooc"))) {
-            for (auto &p : ctx->ports) {
-                if (p.second.type != PORT_IN || p.second.net == nullptr)
-                    continue;
-                ooc_port_nets.insert(p.second.net->name);
-            }
-        }
-
-        for (auto &cell : ctx->cells) {
-            input_ports.clear();
-            output_ports.clear();
-            for (auto &port : cell.second->ports) {
-                if (!port.second.net)
-                    continue;
-                if (port.second.type == PORT_OUT)
-                    output_ports.push_back(&port.second);
-                else
-                    input_ports.push_back(port.first);
-            }
-
-            for (auto o : output_ports) {
-                int clocks = 0;
-                TimingPortClass portClass = ctx->getPortTimingClass(cell.second.get(), o->name, clocks);
-                // If output port is influenced by a clock (e.g. FF output) then add it to the ordering as a timing
-                // start-point
-                if (portClass == TMG_REGISTER_OUTPUT) {
-                    topological_order.emplace_back(o->net);
-                    for (int i = 0; i < clocks; i++) {
-                        TimingClockingInfo clkInfo = ctx->getPortClockingInfo(cell.second.get(), o->name, i);
-                        const NetInfo *clknet = cell.second->getPort(clkInfo.clock_port);
-                        IdString clksig = clknet ? clknet->name : async_clock;
-                        net_data[o->net][ClockEvent{clksig, clknet ? clkInfo.edge : RISING_EDGE}] =
-                                TimingData{clkInfo.clockToQ.maxDelay()};
-                    }
-
-                } else {
-                    if (portClass == TMG_STARTPOINT || portClass == TMG_GEN_CLOCK || portClass == TMG_IGNORE) {
-                        topological_order.emplace_back(o->net);
-                        TimingData td;
-                        td.false_startpoint = (portClass == TMG_GEN_CLOCK || portClass == TMG_IGNORE);
-                        td.max_arrival = 0;
-                        net_data[o->net][ClockEvent{async_clock, RISING_EDGE}] = td;
-                    }
-
-                    // Don't analyse paths from a clock input to other pins - they will be considered by the
-                    // special-case handling register input/output class ports
-                    if (portClass == TMG_CLOCK_INPUT)
-                        continue;
-
-                    // Otherwise, for all driven input ports on this cell, if a timing arc exists between the input and
-                    // the current output port, increment fanin counter
-                    for (auto i : input_ports) {
-                        DelayQuad comb_delay;
-                        NetInfo *i_net = cell.second->ports[i].net;
-                        if (i_net->driver.cell == nullptr && !ooc_port_nets.count(i_net->name))
-                            continue;
-                        bool is_path = ctx->getCellDelay(cell.second.get(), i, o->name, comb_delay);
-                        if (is_path)
-                            port_fanin[o]++;
-                    }
-                    // If there is no fanin, add the port as a false startpoint
-                    if (!port_fanin.count(o) && !net_data.count(o->net)) {
-                        topological_order.emplace_back(o->net);
-                        TimingData td;
-                        td.false_startpoint = true;
-                        td.max_arrival = 0;
-                        net_data[o->net][ClockEvent{async_clock, RISING_EDGE}] = td;
-                    }
-                }
-            }
-        }
-
-        // In out-of-context mode, handle top-level ports correctly
-        if (bool_or_default(ctx->settings, ctx->id("arch.ooc"))) {
-            for (auto &p : ctx->ports) {
-                if (p.second.type != PORT_IN || p.second.net == nullptr)
-                    continue;
-                topological_order.emplace_back(p.second.net);
-            }
-        }
-
-        std::deque<NetInfo *> queue(topological_order.begin(), topological_order.end());
-        // Now walk the design, from the start points identified previously, building up a topological order
-        while (!queue.empty()) {
-            const auto net = queue.front();
-            queue.pop_front();
-
-            for (auto &usr : net->users) {
-                int user_clocks;
-                TimingPortClass usrClass = ctx->getPortTimingClass(usr.cell, usr.port, user_clocks);
-                if (usrClass == TMG_IGNORE || usrClass == TMG_CLOCK_INPUT)
-                    continue;
-                for (auto &port : usr.cell->ports) {
-                    if (port.second.type != PORT_OUT || !port.second.net)
-                        continue;
-                    int port_clocks;
-                    TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, port.first, port_clocks);
-
-                    // Skip if this is a clocked output (but allow non-clocked ones)
-                    if (portClass == TMG_REGISTER_OUTPUT || portClass == TMG_STARTPOINT || portClass == TMG_IGNORE ||
-                        portClass == TMG_GEN_CLOCK)
-                        continue;
-                    DelayQuad comb_delay;
-                    bool is_path = ctx->getCellDelay(usr.cell, usr.port, port.first, comb_delay);
-                    if (!is_path)
-                        continue;
-                    // Decrement the fanin count, and only add to topological order if all its fanins have already
-                    // been visited
-                    auto it = port_fanin.find(&port.second);
-                    if (it == port_fanin.end())
-                        log_error("Timing counted negative fanin count for port %s.%s (net %s), please report this "
-                                  "error.\n",
-                                  ctx->nameOf(usr.cell), ctx->nameOf(port.first), ctx->nameOf(port.second.net));
-                    if (--it->second == 0) {
-                        topological_order.emplace_back(port.second.net);
-                        queue.emplace_back(port.second.net);
-                        port_fanin.erase(it);
-                    }
-                }
-            }
-        }
+    size_t i = 0;
+    if (path.size() >= 2 && ports.at(path.at(0)).type == PORT_IN) {
+        add_segment(CriticalPath::Segment::Type::CLK_TO_Q, path.at(0), path.at(1),
+                    arc_delay(path.at(1), CellArc::CLK_TO_Q, path.at(0).port));
+        i = 1;
+    } else {
+        add_segment(CriticalPath::Segment::Type::SOURCE, path.at(0), path.at(0), 0);
+    }
+    for (; i + 1 < path.size(); i += 2) {
+        const CellPortKey &driver = path.at(i), &sink = path.at(i + 1);
+        const PortInfo &sink_port = ctx->cells.at(sink.cell)->ports.at(sink.port);
+        auto &seg = add_segment(CriticalPath::Segment::Type::ROUTING, driver, sink,
+                                ports.at(sink).route_delay.maxDelay());
+        seg.net = sink_port.net->name;
+        seg.budget = sink_port.net->users.at(sink_port.user_idx).budget;
+        if (i + 2 < path.size())
+            add_segment(CriticalPath::Segment::Type::LOGIC, sink, path.at(i + 2),
+                        arc_delay(sink, CellArc::COMBINATIONAL, path.at(i + 2).port));
+    }
 
-        // Sanity check to ensure that all ports where fanins were recorded were indeed visited
-        if (!port_fanin.empty() && !bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false)) {
-            for (auto fanin : port_fanin) {
-                NetInfo *net = fanin.first->net;
-                if (net != nullptr) {
-                    log_info("   remaining fanin includes %s (net %s)\n", fanin.first->name.c_str(ctx),
-                             net->name.c_str(ctx));
-                    if (net->driver.cell != nullptr)
-                        log_info("        driver = %s.%s\n", net->driver.cell->name.c_str(ctx),
-                                 net->driver.port.c_str(ctx));
-                    for (auto net_user : net->users)
-                        log_info("        user: %s.%s\n", net_user.cell->name.c_str(ctx), net_user.port.c_str(ctx));
-                } else {
-                    log_info("   remaining fanin includes %s (no net)\n", fanin.first->name.c_str(ctx));
-                }
+    // For a registered endpoint, the required time was set from its clock port
+    if (req.bwd_min.cell == endpoint.cell) {
+        for (auto &arc : ep_data.cell_arcs) {
+            if (arc.type == CellArc::SETUP && arc.other_port == req.bwd_min.port) {
+                add_segment(CriticalPath::Segment::Type::SETUP, endpoint, endpoint, arc.value.maxDelay());
+                break;
             }
-            if (ctx->force)
-                log_warning("timing analysis failed due to presence of combinatorial loops, incomplete specification "
-                            "of timing ports, etc.\n");
-            else
-                log_error("timing analysis failed due to presence of combinatorial loops, incomplete specification of "
-                          "timing ports, etc.\n");
         }
+    }
+    return report;
+}
 
-        // Go forwards topologically to find the maximum arrival time and max path length for each net
-        std::vector<ClockEvent> startdomains;
-        for (auto net : topological_order) {
-            if (!net_data.count(net))
+std::vector<CriticalPath> TimingAnalyser::get_critical_paths() const
+{
+    std::vector<CriticalPath> paths;
+    for (domain_id_t i = 0; i < domain_id_t(domain_pairs.size()); i++) {
+        auto &dp = domain_pairs.at(i);
+        CellPortKey worst_ep;
+        delay_t worst_slack = std::numeric_limits<delay_t>::max();
+        for (auto &ep : domains.at(dp.key.capture).endpoints) {
+            auto &pd = ports.at(ep.first);
+            auto found = pd.domain_pairs.find(i);
+            if (found == pd.domain_pairs.end())
                 continue;
-            // Updates later on might invalidate a reference taken here to net_data, so iterate over a list of domains
-            // instead
-            startdomains.clear();
-            {
-                auto &nd_map = net_data.at(net);
-                for (auto &startdomain : nd_map)
-                    startdomains.push_back(startdomain.first);
-            }
-            for (auto &start_clk : startdomains) {
-                auto &nd = net_data.at(net).at(start_clk);
-                if (nd.false_startpoint)
-                    continue;
-                const auto net_arrival = nd.max_arrival;
-                const auto net_length_plus_one = nd.max_path_length + 1;
-                nd.min_remaining_budget = clk_period;
-                for (auto &usr : net->users) {
-                    int port_clocks;
-                    TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
-                    auto net_delay = net_delays ? ctx->getNetinfoRouteDelay(net, usr) : delay_t();
-                    auto usr_arrival = net_arrival + net_delay;
-
-                    if (portClass == TMG_ENDPOINT || portClass == TMG_IGNORE || portClass == TMG_CLOCK_INPUT) {
-                        // Skip
-                    } else {
-                        auto budget_override = ctx->getBudgetOverride(net, usr, net_delay);
-                        // Iterate over all output ports on the same cell as the sink
-                        for (auto port : usr.cell->ports) {
-                            if (port.second.type != PORT_OUT || !port.second.net)
-                                continue;
-                            DelayQuad comb_delay;
-                            // Look up delay through this path
-                            bool is_path = ctx->getCellDelay(usr.cell, usr.port, port.first, comb_delay);
-                            if (!is_path)
-                                continue;
-                            auto &data = net_data[port.second.net][start_clk];
-                            auto &arrival = data.max_arrival;
-                            arrival = std::max(arrival, usr_arrival + comb_delay.maxDelay());
-                            if (!budget_override) { // Do not increment path length if budget overridden since it
-                                                    // doesn't
-                                // require a share of the slack
-                                auto &path_length = data.max_path_length;
-                                path_length = std::max(path_length, net_length_plus_one);
-                            }
-                        }
-                    }
-                }
+            if (worst_ep == CellPortKey() || found->second.setup_slack < worst_slack) {
+                worst_ep = ep.first;
+                worst_slack = found->second.setup_slack;
             }
         }
+        if (worst_ep != CellPortKey())
+            paths.push_back(build_critical_path(worst_ep, i));
+    }
+    return paths;
+}
 
-        dict<ClockPair, std::pair<delay_t, NetInfo *>> crit_nets;
-
-        // Now go backwards topologically to determine the minimum path slack, and to distribute all path slack evenly
-        // between all nets on the path
-        for (auto net : boost::adaptors::reverse(topological_order)) {
-            if (!net_data.count(net))
-                continue;
-            auto &nd_map = net_data.at(net);
-            for (auto &startdomain : nd_map) {
-                auto &nd = startdomain.second;
-                // Ignore false startpoints
-                if (nd.false_startpoint)
+std::map<int, unsigned> TimingAnalyser::get_slack_histogram() const
+{
+    std::map<int, unsigned> histogram;
+    for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+        for (auto &ep : domains.at(dom_id).endpoints) {
+            for (auto &pdp : ports.at(ep.first).domain_pairs) {
+                auto &dp = domain_pairs.at(pdp.first);
+                if (dp.key.capture != dom_id)
                     continue;
-                const delay_t net_length_plus_one = nd.max_path_length + 1;
-                auto &net_min_remaining_budget = nd.min_remaining_budget;
-                for (auto &usr : net->users) {
-                    auto net_delay = net_delays ? ctx->getNetinfoRouteDelay(net, usr) : delay_t();
-                    auto budget_override = ctx->getBudgetOverride(net, usr, net_delay);
-                    int port_clocks;
-                    TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
-                    if (portClass == TMG_REGISTER_INPUT || portClass == TMG_ENDPOINT) {
-                        auto process_endpoint = [&](IdString clksig, ClockEdge edge, delay_t setup) {
-                            const auto net_arrival = nd.max_arrival;
-                            const auto endpoint_arrival = net_arrival + net_delay + setup;
-                            delay_t period;
-                            // Set default period
-                            if (edge == startdomain.first.edge) {
-                                period = clk_period;
-                            } else {
-                                period = clk_period / 2;
-                            }
-                            if (clksig != async_clock) {
-                                if (ctx->nets.at(clksig)->clkconstr) {
-                                    if (edge == startdomain.first.edge) {
-                                        // same edge
-                                        period = ctx->nets.at(clksig)->clkconstr->period.minDelay();
-                                    } else if (edge == RISING_EDGE) {
-                                        // falling -> rising
-                                        period = ctx->nets.at(clksig)->clkconstr->low.minDelay();
-                                    } else if (edge == FALLING_EDGE) {
-                                        // rising -> falling
-                                        period = ctx->nets.at(clksig)->clkconstr->high.minDelay();
-                                    }
-                                }
-                            }
-                            auto path_budget = period - endpoint_arrival;
-
-                            if (update) {
-                                auto budget_share = budget_override ? 0 : path_budget / net_length_plus_one;
-                                usr.budget = std::min(usr.budget, net_delay + budget_share);
-                                net_min_remaining_budget =
-                                        std::min(net_min_remaining_budget, path_budget - budget_share);
-                            }
-
-                            if (path_budget < min_slack)
-                                min_slack = path_budget;
-
-                            if (slack_histogram) {
-                                int slack_ps = ctx->getDelayNS(path_budget) * 1000;
-                                (*slack_histogram)[slack_ps]++;
-                            }
-                            ClockEvent dest_ev{clksig, edge};
-                            ClockPair clockPair{startdomain.first, dest_ev};
-                            nd.arrival_time[dest_ev] = std::max(nd.arrival_time[dest_ev], endpoint_arrival);
-
-                            // Store the detailed timing for each net and user (a.k.a. sink)
-                            if (detailed_net_timings) {
-                                NetSinkTiming sink_timing;
-                                sink_timing.clock_pair = clockPair;
-                                sink_timing.cell_port = std::make_pair(usr.cell->name, usr.port);
-                                sink_timing.delay = endpoint_arrival;
-                                sink_timing.budget = period;
-
-                                (*detailed_net_timings)[net->name].push_back(sink_timing);
-                            }
-
-                            if (crit_path) {
-                                if (!crit_nets.count(clockPair) || crit_nets.at(clockPair).first < endpoint_arrival) {
-                                    crit_nets[clockPair] = std::make_pair(endpoint_arrival, net);
-                                    (*crit_path)[clockPair].path_delay = endpoint_arrival;
-                                    (*crit_path)[clockPair].path_period = period;
-                                    (*crit_path)[clockPair].ports.clear();
-                                    (*crit_path)[clockPair].ports.push_back(&usr);
-                                }
-                            }
-                        };
-                        if (portClass == TMG_REGISTER_INPUT) {
-                            for (int i = 0; i < port_clocks; i++) {
-                                TimingClockingInfo clkInfo = ctx->getPortClockingInfo(usr.cell, usr.port, i);
-                                const NetInfo *clknet = usr.cell->getPort(clkInfo.clock_port);
-                                IdString clksig = clknet ? clknet->name : async_clock;
-                                process_endpoint(clksig, clknet ? clkInfo.edge : RISING_EDGE, clkInfo.setup.maxDelay());
-                            }
-                        } else {
-                            process_endpoint(async_clock, RISING_EDGE, 0);
-                        }
-
-                    } else if (update) {
-
-                        // Iterate over all output ports on the same cell as the sink
-                        for (const auto &port : usr.cell->ports) {
-                            if (port.second.type != PORT_OUT || !port.second.net)
-                                continue;
-                            DelayQuad comb_delay;
-                            bool is_path = ctx->getCellDelay(usr.cell, usr.port, port.first, comb_delay);
-                            if (!is_path)
-                                continue;
-                            if (net_data.count(port.second.net) &&
-                                net_data.at(port.second.net).count(startdomain.first)) {
-                                auto path_budget =
-                                        net_data.at(port.second.net).at(startdomain.first).min_remaining_budget;
-                                auto budget_share = budget_override ? 0 : path_budget / net_length_plus_one;
-                                usr.budget = std::min(usr.budget, net_delay + budget_share);
-                                net_min_remaining_budget =
-                                        std::min(net_min_remaining_budget, path_budget - budget_share);
-                            }
-                        }
-                    }
-                }
+                int slack_ps = ctx->getDelayNS(dp.period.minDelay() + pdp.second.setup_slack) * 1000;
+                histogram[slack_ps]++;
             }
         }
+    }
+    return histogram;
+}
 
-        if (crit_path) {
-            // Walk backwards from the most critical net
-            for (auto crit_pair : crit_nets) {
-                NetInfo *crit_net = crit_pair.second.second;
-                auto &cp_ports = (*crit_path)[crit_pair.first].ports;
-                while (crit_net) {
-                    const PortInfo *crit_ipin = nullptr;
-                    delay_t max_arrival = std::numeric_limits<delay_t>::min();
-                    // Look at all input ports on its driving cell
-                    for (const auto &port : crit_net->driver.cell->ports) {
-                        if (port.second.type != PORT_IN || !port.second.net)
-                            continue;
-                        DelayQuad comb_delay;
-                        bool is_path =
-                                ctx->getCellDelay(crit_net->driver.cell, port.first, crit_net->driver.port, comb_delay);
-                        if (!is_path)
-                            continue;
-                        // If input port is influenced by a clock, skip
-                        int port_clocks;
-                        TimingPortClass portClass =
-                                ctx->getPortTimingClass(crit_net->driver.cell, port.first, port_clocks);
-                        if (portClass == TMG_CLOCK_INPUT || portClass == TMG_ENDPOINT || portClass == TMG_IGNORE)
-                            continue;
-                        // And find the fanin net with the latest arrival time
-                        if (net_data.count(port.second.net) &&
-                            net_data.at(port.second.net).count(crit_pair.first.start)) {
-                            auto net_arrival = net_data.at(port.second.net).at(crit_pair.first.start).max_arrival;
-                            if (net_delays) {
-                                for (auto &user : port.second.net->users)
-                                    if (user.port == port.first && user.cell == crit_net->driver.cell) {
-                                        net_arrival += ctx->getNetinfoRouteDelay(port.second.net, user);
-                                        break;
-                                    }
-                            }
-                            net_arrival += comb_delay.maxDelay();
-                            if (net_arrival > max_arrival) {
-                                max_arrival = net_arrival;
-                                crit_ipin = &port.second;
-                            }
-                        }
-                    }
-
-                    if (!crit_ipin)
-                        break;
-                    // Now convert PortInfo* into a PortRef*
-                    for (auto &usr : crit_ipin->net->users) {
-                        if (usr.cell->name == crit_net->driver.cell->name && usr.port == crit_ipin->name) {
-                            cp_ports.push_back(&usr);
-                            break;
-                        }
-                    }
-                    crit_net = crit_ipin->net;
-                }
-                std::reverse(cp_ports.begin(), cp_ports.end());
+dict<IdString, std::vector<NetSinkTiming>> TimingAnalyser::get_detailed_net_timings() const
+{
+    dict<IdString, std::vector<NetSinkTiming>> net_timings;
+    for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+        for (auto &ep : domains.at(dom_id).endpoints) {
+            auto &pd = ports.at(ep.first);
+            const NetInfo *net = ctx->cells.at(ep.first.cell)->getPort(ep.first.port);
+            for (auto &pdp : pd.domain_pairs) {
+                auto &dp = domain_pairs.at(pdp.first);
+                if (dp.key.capture != dom_id)
+                    continue;
+                NetSinkTiming sink_timing;
+                sink_timing.clock_pair = ClockPair{clock_event(dp.key.launch), clock_event(dp.key.capture)};
+                sink_timing.cell_port = std::make_pair(ep.first.cell, ep.first.port);
+                sink_timing.delay =
+                        pd.arrival.at(dp.key.launch).value.maxDelay() - pd.required.at(dom_id).value.minDelay();
+                sink_timing.budget = dp.period.minDelay();
+                net_timings[net->name].push_back(sink_timing);
             }
         }
-        return min_slack;
     }
+    return net_timings;
+}
 
-    void assign_budget()
-    {
-        // Clear delays to a very high value first
-        for (auto &net : ctx->nets) {
-            for (auto &usr : net.second->users) {
-                usr.budget = std::numeric_limits<delay_t>::max();
+delay_t TimingAnalyser::assign_budgets()
+{
+    delay_t worst_slack = ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
+    for (auto &net : ctx->nets) {
+        NetInfo *ni = net.second.get();
+        for (auto &usr : ni->users) {
+            usr.budget = std::numeric_limits<delay_t>::max();
+            auto &pd = ports.at(CellPortKey(usr));
+            delay_t route_delay = pd.route_delay.maxDelay();
+            // Arcs with a fixed budget don't take a share of the path slack
+            bool fixed_budget = ctx->getBudgetOverride(ni, usr, route_delay);
+            for (auto &pdp : pd.domain_pairs) {
+                delay_t slack = domain_pairs.at(pdp.first).period.minDelay() + pdp.second.setup_slack;
+                worst_slack = std::min(worst_slack, slack);
+                // The path length counts the startpoint as well as the cells, so is one more than the number of nets
+                delay_t share = fixed_budget ? 0 : slack / std::max(1, pdp.second.max_path_length - 1);
+                usr.budget = std::min(usr.budget, route_delay + share);
             }
         }
+    }
+    return worst_slack;
+}
 
-        walk_paths();
+namespace {
+// The final report and budgets also cover paths to and from unclocked ports, such as top-level IO
+void setup_report_analyser(Context *ctx, TimingAnalyser &tmg)
+{
+    bool ignore_loops = bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false);
+    tmg.setup_only = true;
+    tmg.async_paths = true;
+    tmg.verbose_mode = !ignore_loops;
+    tmg.setup();
+    if (tmg.have_loops && !ignore_loops) {
+        if (ctx->force)
+            log_warning("timing analysis failed due to presence of combinatorial loops, incomplete specification "
+                        "of timing ports, etc.\n");
+        else
+            log_error("timing analysis failed due to presence of combinatorial loops, incomplete specification of "
+                      "timing ports, etc.\n");
     }
-};
+}
+} // namespace
 
 void assign_budget(Context *ctx, bool quiet)
 {
@@ -1238,8 +1113,9 @@ void assign_budget(Context *ctx, bool quiet)
                  ctx->setting<float>("target_freq") / 1e6);
     }
 
-    Timing timing(ctx, ctx->setting<int>("slack_redist_iter") > 0 /* net_delays */, true /* update */);
-    timing.assign_budget();
+    TimingAnalyser tmg(ctx);
+    setup_report_analyser(ctx, tmg);
+    delay_t min_slack = tmg.assign_budgets();
 
     if (!quiet || ctx->verbose) {
         for (auto &net : ctx->nets) {
@@ -1263,112 +1139,17 @@ void assign_budget(Context *ctx, bool quiet)
     // currently achieved maximum
     if (ctx->setting<bool>("auto_freq") && ctx->setting<int>("slack_redist_iter") > 0) {
         delay_t default_slack = delay_t((1.0e9 / ctx->getDelayNS(1)) / ctx->setting<float>("target_freq"));
-        ctx->settings[ctx->id("target_freq")] =
-                std::to_string(1.0e9 / ctx->getDelayNS(default_slack - timing.min_slack));
+        ctx->settings[ctx->id("target_freq")] = std::to_string(1.0e9 / ctx->getDelayNS(default_slack - min_slack));
         if (ctx->verbose)
             log_info("minimum slack for this assign = %.2f ns, target Fmax for next "
                      "update = %.2f MHz\n",
-                     ctx->getDelayNS(timing.min_slack), ctx->setting<float>("target_freq") / 1e6);
+                     ctx->getDelayNS(min_slack), ctx->setting<float>("target_freq") / 1e6);
     }
 
     if (!quiet)
         log_info("Checksum: 0x%08x\n", ctx->checksum());
 }
 
-CriticalPath build_critical_path_report(Context *ctx, ClockPair &clocks, const PortRefVector &crit_path)
-{
-
-    CriticalPath report;
-    report.clock_pair = clocks;
-
-    auto &front = crit_path.front();
-    auto &front_port = front->cell->ports.at(front->port);
-    auto &front_driver = front_port.net->driver;
-
-    int port_clocks;
-    auto portClass = ctx->getPortTimingClass(front_driver.cell, front_driver.port, port_clocks);
-
-    const CellInfo *last_cell = front->cell;
-    IdString last_port = front_driver.port;
-
-    int clock_start = -1;
-    if (portClass == TMG_REGISTER_OUTPUT) {
-        for (int i = 0; i < port_clocks; i++) {
-            TimingClockingInfo clockInfo = ctx->getPortClockingInfo(front_driver.cell, front_driver.port, i);
-            const NetInfo *clknet = front_driver.cell->getPort(clockInfo.clock_port);
-            if (clknet != nullptr && clknet->name == clocks.start.clock && clockInfo.edge == clocks.start.edge) {
-                last_port = clockInfo.clock_port;
-                clock_start = i;
-                break;
-            }
-        }
-    }
-
-    for (auto sink : crit_path) {
-        auto sink_cell = sink->cell;
-        auto &port = sink_cell->ports.at(sink->port);
-        auto net = port.net;
-        auto &driver = net->driver;
-        auto driver_cell = driver.cell;
-
-        CriticalPath::Segment seg_logic;
-
-        DelayQuad comb_delay;
-        if (clock_start != -1) {
-            auto clockInfo = ctx->getPortClockingInfo(driver_cell, driver.port, clock_start);
-            comb_delay = clockInfo.clockToQ;
-            clock_start = -1;
-            seg_logic.type = CriticalPath::Segment::Type::CLK_TO_Q;
-        } else if (last_port == driver.port) {
-            // Case where we start with a STARTPOINT etc
-            comb_delay = DelayQuad(0);
-            seg_logic.type = CriticalPath::Segment::Type::SOURCE;
-        } else {
-            ctx->getCellDelay(driver_cell, last_port, driver.port, comb_delay);
-            seg_logic.type = CriticalPath::Segment::Type::LOGIC;
-        }
-
-        seg_logic.delay = comb_delay.maxDelay();
-        seg_logic.budget = 0;
-        seg_logic.from = std::make_pair(last_cell->name, last_port);
-        seg_logic.to = std::make_pair(driver_cell->name, driver.port);
-        seg_logic.net = IdString();
-        report.segments.push_back(seg_logic);
-
-        auto net_delay = ctx->getNetinfoRouteDelay(net, *sink);
-
-        CriticalPath::Segment seg_route;
-        seg_route.type = CriticalPath::Segment::Type::ROUTING;
-        seg_route.delay = net_delay;
-        seg_route.budget = sink->budget;
-        seg_route.from = std::make_pair(driver_cell->name, driver.port);
-        seg_route.to = std::make_pair(sink_cell->name, sink->port);
-        seg_route.net = net->name;
-        report.segments.push_back(seg_route);
-
-        last_cell = sink_cell;
-        last_port = sink->port;
-    }
-
-    int clockCount = 0;
-    auto sinkClass = ctx->getPortTimingClass(crit_path.back()->cell, crit_path.back()->port, clockCount);
-    if (sinkClass == TMG_REGISTER_INPUT && clockCount > 0) {
-        auto sinkClockInfo = ctx->getPortClockingInfo(crit_path.back()->cell, crit_path.back()->port, 0);
-        delay_t setup = sinkClockInfo.setup.maxDelay();
-
-        CriticalPath::Segment seg_logic;
-        seg_logic.type = CriticalPath::Segment::Type::SETUP;
-        seg_logic.delay = setup;
-        seg_logic.budget = 0;
-        seg_logic.from = std::make_pair(last_cell->name, last_port);
-        seg_logic.to = seg_logic.from;
-        seg_logic.net = IdString();
-        report.segments.push_back(seg_logic);
-    }
-
-    return report;
-}
-
 void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool print_path, bool warn_on_failure,
                      bool update_results)
 {
@@ -1383,18 +1164,8 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
         return value;
     };
 
-    CriticalPathDataMap crit_paths;
-    DelayFrequency slack_histogram;
-    DetailedNetTimings detailed_net_timings;
-
-    Timing timing(ctx, true /* net_delays */, false /* update */, (print_path || print_fmax) ? &crit_paths : nullptr,
-                  print_histogram ? &slack_histogram : nullptr,
-                  (update_results && ctx->detailed_timing_report) ? &detailed_net_timings : nullptr);
-    timing.walk_paths();
-
-    // Use TimingAnalyser to determine clock-to-clock relations
-    TimingAnalyser timingAnalyser(ctx);
-    timingAnalyser.setup();
+    TimingAnalyser tmg(ctx);
+    setup_report_analyser(ctx, tmg);
 
     bool report_critical_paths = print_path || print_fmax || update_results;
 
@@ -1404,41 +1175,36 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
     std::set<IdString> empty_clocks; // set of clocks with no interior paths
 
     if (report_critical_paths) {
+        std::vector<CriticalPath> crit_paths = tmg.get_critical_paths();
 
-        for (auto path : crit_paths) {
-            const ClockEvent &a = path.first.start;
-            const ClockEvent &b = path.first.end;
-            empty_clocks.insert(a.clock);
-            empty_clocks.insert(b.clock);
+        for (auto &path : crit_paths) {
+            empty_clocks.insert(path.clock_pair.start.clock);
+            empty_clocks.insert(path.clock_pair.end.clock);
         }
-        for (auto path : crit_paths) {
-            const ClockEvent &a = path.first.start;
-            const ClockEvent &b = path.first.end;
+        for (auto &path : crit_paths) {
+            const ClockEvent &a = path.clock_pair.start;
+            const ClockEvent &b = path.clock_pair.end;
             if (a.clock != b.clock || a.clock == ctx->id("$async$"))
                 continue;
             double Fmax;
             empty_clocks.erase(a.clock);
             if (a.edge == b.edge)
-                Fmax = 1000 / ctx->getDelayNS(path.second.path_delay);
+                Fmax = 1000 / ctx->getDelayNS(path.delay);
             else
-                Fmax = 500 / ctx->getDelayNS(path.second.path_delay);
+                Fmax = 500 / ctx->getDelayNS(path.delay);
             if (!clock_fmax.count(a.clock) || Fmax < clock_fmax.at(a.clock).achieved) {
                 clock_fmax[a.clock].achieved = Fmax;
                 clock_fmax[a.clock].constraint = 0.0f; // Will be filled later
-                clock_reports[a.clock] = build_critical_path_report(ctx, path.first, path.second.ports);
-                clock_reports[a.clock].period = path.second.path_period;
+                clock_reports[a.clock] = path;
             }
         }
 
         for (auto &path : crit_paths) {
-            const ClockEvent &a = path.first.start;
-            const ClockEvent &b = path.first.end;
+            const ClockEvent &a = path.clock_pair.start;
+            const ClockEvent &b = path.clock_pair.end;
             if (a.clock == b.clock && a.clock != ctx->id("$async$"))
                 continue;
-
-            auto &crit_path = crit_paths.at(path.first).ports;
-            xclock_reports.push_back(build_critical_path_report(ctx, path.first, crit_path));
-            xclock_reports.back().period = path.second.path_period;
+            xclock_reports.push_back(path);
         }
 
         if (clock_reports.empty() && xclock_reports.empty()) {
@@ -1607,28 +1373,41 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
         for (auto &clock : clock_reports)
             max_width = std::max<unsigned>(max_width, clock.first.str(ctx).size());
 
-        for (auto &clock : clock_reports) {
-            const auto &clock_name = clock.first.str(ctx);
+        auto report_fmax = [&](const std::string &clock_name, const std::string &corner, float fmax, float target) {
             const int width = max_width - clock_name.size();
-
-            float fmax = clock_fmax[clock.first].achieved;
-            float target = clock_fmax[clock.first].constraint;
             bool passed = target < fmax;
 
             if (!warn_on_failure || passed)
-                log_info("Max frequency for clock %*s'%s': %.02f MHz (%s at %.02f MHz)\n", width, "",
-                         clock_name.c_str(), fmax, passed ? "PASS" : "FAIL", target);
+                log_info("Max frequency for clock %*s'%s'%s: %.02f MHz (%s at %.02f MHz)\n", width, "",
+                         clock_name.c_str(), corner.c_str(), fmax, passed ? "PASS" : "FAIL", target);
             else if (bool_or_default(ctx->settings, ctx->id("timing/allowFail"), false))
-                log_warning("Max frequency for clock %*s'%s': %.02f MHz (%s at %.02f MHz)\n", width, "",
-                            clock_name.c_str(), fmax, passed ? "PASS" : "FAIL", target);
+                log_warning("Max frequency for clock %*s'%s'%s: %.02f MHz (%s at %.02f MHz)\n", width, "",
+                            clock_name.c_str(), corner.c_str(), fmax, passed ? "PASS" : "FAIL", target);
             else
-                log_nonfatal_error("Max frequency for clock %*s'%s': %.02f MHz (%s at %.02f MHz)\n", width, "",
-                                   clock_name.c_str(), fmax, passed ? "PASS" : "FAIL", target);
-        }
+                log_nonfatal_error("Max frequency for clock %*s'%s'%s: %.02f MHz (%s at %.02f MHz)\n", width, "",
+                                   clock_name.c_str(), corner.c_str(), fmax, passed ? "PASS" : "FAIL", target);
+        };
+
+        for (auto &clock : clock_reports)
+            report_fmax(clock.first.str(ctx), "", clock_fmax[clock.first].achieved, clock_fmax[clock.first].constraint);
         log_break();
 
+        // The same checks at each extra corner
+        for (int i = 0; i < int(tmg.corners.size()); i++) {
+            const std::string corner = stringf(" at corner '%s'", tmg.corners.at(i).name.c_str(ctx));
+            auto corner_fmax = tmg.get_corner_fmax(i);
+            for (auto &clock : clock_reports)
+                if (corner_fmax.count(clock.first))
+                    report_fmax(clock.first.str(ctx), corner, corner_fmax.at(clock.first),
+                                clock_fmax[clock.first].constraint);
+            delay_t worst_slack = tmg.get_corner_setup_slack(i);
+            if (worst_slack != std::numeric_limits<delay_t>::max())
+                log_info("Worst setup slack%s: %.02f ns\n", corner.c_str(), ctx->getDelayNS(worst_slack));
+            log_break();
+        }
+
         // All clock to clock delays
-        const auto &clock_delays = timingAnalyser.get_clock_delays();
+        const auto &clock_delays = tmg.get_clock_delays();
 
         // Clock to clock delays for xpaths
         dict<ClockPair, delay_t> xclock_delays;
@@ -1753,6 +1532,9 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
         log_break();
     }
 
+    std::map<int, unsigned> slack_histogram;
+    if (print_histogram)
+        slack_histogram = tmg.get_slack_histogram();
     if (print_histogram && slack_histogram.size() > 0) {
         unsigned num_bins = 20;
         unsigned bar_width = 60;
@@ -1791,7 +1573,10 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
         results.clock_paths = std::move(clock_reports);
         results.xclock_paths = std::move(xclock_reports);
 
-        results.detailed_net_timings = std::move(detailed_net_timings);
+        if (ctx->detailed_timing_report)
+            results.detailed_net_timings = tmg.get_detailed_net_timings();
+        else
+            results.detailed_net_timings.clear();
     }
 }
 
@@ -20,6 +20,8 @@
 #ifndef TIMING_H
 #define TIMING_H
 
+#include <array>
+#include <map>
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -70,9 +72,22 @@ struct ClockDomainPairKey
     unsigned int hash() const { return mkhash(launch, capture); }
 };
 
+// A timing corner that is analysed alongside the delays given by the arch, by derating its cell and routing delays
+// (for example, a slower speed grade or a low voltage process corner)
+struct TimingCorner
+{
+    IdString name;
+    float cell_derate = 1.0f, route_derate = 1.0f;
+};
+
 struct TimingAnalyser
 {
   public:
+    // The most corners that can be analysed in one run. Per-corner delays are fixed size arrays, so that propagating
+    // them is a few vector operations per arc
+    static constexpr int MAX_CORNERS = 4;
+    typedef std::array<delay_t, MAX_CORNERS> CornerDelays;
+
     TimingAnalyser(Context *ctx) : ctx(ctx){};
     void setup();
     void run(bool update_route_delays = true);
@@ -81,6 +96,9 @@ struct TimingAnalyser
     // This is used when routers etc are not actually binding detailed routing (due to congestion or an abstracted
     // model), but want to re-run STA with their own calculated delays
     void set_route_delay(CellPortKey port, DelayPair value);
+    // Refresh the route delays of a single net from the current placement. Placers that track which nets have moved can
+    // use this followed by run(false) instead of recomputing the delay of every arc in the design.
+    void update_route_delays(const NetInfo *net);
 
     float get_criticality(CellPortKey port) const { return ports.at(port).worst_crit; }
     float get_setup_slack(CellPortKey port) const { return ports.at(port).worst_setup_slack; }
@@ -92,14 +110,38 @@ struct TimingAnalyser
         return slack;
     }
 
+    // Worst setup slack (including the clock period) of any path launched and captured in the same clock domain
+    delay_t get_worst_setup_slack() const;
+    // The same, and the achieved Fmax of each clock, for one of the extra corners
+    delay_t get_corner_setup_slack(int corner) const;
+    dict<IdString, float> get_corner_fmax(int corner) const;
+
     auto get_clock_delays() const { return clock_delays; }
 
+    // The worst path of each launch/capture domain pair, for the final timing report
+    std::vector<CriticalPath> get_critical_paths() const;
+    // Number of endpoints (per domain pair) at each setup slack, in ps
+    std::map<int, unsigned> get_slack_histogram() const;
+    // Delay and allowed time of every net sink that is a timing endpoint
+    dict<IdString, std::vector<NetSinkTiming>> get_detailed_net_timings() const;
+
+    // Set PortRef::budget of every net sink on a timing path, by sharing the slack of the worst path through it evenly
+    // between the nets on that path. Returns the worst slack of any path
+    delay_t assign_budgets();
+
+    // Extra corners to analyse. If empty when setup() is called, these are read from the timing/corners setting.
+    // get_criticality() gives the worst criticality of the arch delays and all of these corners
+    std::vector<TimingCorner> corners;
+
     bool setup_only = false;
+    // Also analyse paths from and to unclocked startpoints and endpoints (such as top level IO) as the '$async$' domain
+    bool async_paths = false;
     bool verbose_mode = false;
     bool have_loops = false;
     bool updated_domains = false;
 
   private:
+    void init_corners();
     void init_ports();
     void get_cell_delays();
     void get_route_delays();
@@ -120,14 +162,21 @@ struct TimingAnalyser
     std::vector<CellPortKey> get_failing_eps(domain_id_t domain_pair, int count);
     // print the critical path for an endpoint and domain pair
     void print_critical_path(CellPortKey endpoint, domain_id_t domain_pair);
+    // build the report of the path ending at an endpoint, following the latest arrival times back to its startpoint
+    CriticalPath build_critical_path(CellPortKey endpoint, domain_id_t domain_pair) const;
+    ClockEvent clock_event(domain_id_t domain) const;
+    delay_t clock_period(IdString clock) const;
+    TimingPortClass port_class(const CellPortKey &port);
+    CornerDelays corner_delays(delay_t delay, bool is_route) const;
 
     const DelayPair init_delay{std::numeric_limits<delay_t>::max(), std::numeric_limits<delay_t>::lowest()};
 
     // Set arrival/required times if more/less than the current value
-    void set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                          CellPortKey prev = CellPortKey());
-    void set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                           CellPortKey prev = CellPortKey());
+    // The corner arrival/required times are corner_from plus/minus corner_delay
+    void set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, const CornerDelays &corner_from,
+                          const CornerDelays &corner_delay, int path_length, CellPortKey prev = CellPortKey());
+    void set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, const CornerDelays &corner_from,
+                           const CornerDelays &corner_delay, int path_length, CellPortKey prev = CellPortKey());
 
     // To avoid storing the domain tag structure (which could get large when considering more complex constrained tag
     // cases), assign each domain an ID and use that instead
@@ -136,6 +185,8 @@ struct TimingAnalyser
     struct ArrivReqTime
     {
         DelayPair value;
+        // latest arrival/earliest required time at each corner
+        CornerDelays corner_value;
         CellPortKey bwd_min, bwd_max;
         int path_length;
     };
@@ -144,6 +195,7 @@ struct TimingAnalyser
     {
         delay_t setup_slack = std::numeric_limits<delay_t>::max(), hold_slack = std::numeric_limits<delay_t>::max();
         delay_t budget = std::numeric_limits<delay_t>::max();
+        CornerDelays corner_setup_slack;
         int max_path_length = 0;
         float criticality = 0;
     };
@@ -162,6 +214,8 @@ struct TimingAnalyser
 
         IdString other_port;
         DelayQuad value;
+        // max delay at each corner
+        CornerDelays corner_value{};
         // Clock polarity, not used for combinational arcs
         ClockEdge edge;
 
@@ -184,6 +238,7 @@ struct TimingAnalyser
         std::vector<CellArc> cell_arcs;
         // routing delay into this port (input ports only)
         DelayPair route_delay{0};
+        CornerDelays corner_route_delay{};
         // worst criticality and slack across domain pairs
         float worst_crit = 0;
         delay_t worst_setup_slack = std::numeric_limits<delay_t>::max(),
@@ -202,8 +257,10 @@ struct TimingAnalyser
     {
         PerDomainPair(ClockDomainPairKey key) : key(key){};
         ClockDomainPairKey key;
+        // between different clocks, this is the period of the capture clock
         DelayPair period{0};
         delay_t worst_setup_slack, worst_hold_slack;
+        CornerDelays corner_worst_setup_slack;
     };
 
     CellInfo *cell_info(const CellPortKey &key);
@@ -211,6 +268,7 @@ struct TimingAnalyser
 
     domain_id_t domain_id(IdString cell, IdString clock_port, ClockEdge edge);
     domain_id_t domain_id(const NetInfo *net, ClockEdge edge);
+    domain_id_t domain_id(const ClockDomainKey &key);
     domain_id_t domain_pair_id(domain_id_t launch, domain_id_t capture);
 
     void copy_domains(const CellPortKey &from, const CellPortKey &to, bool backwards);
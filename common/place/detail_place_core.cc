@@ -54,7 +54,17 @@ void PlacePartition::split(Context *ctx, bool yaxis, float pivot, PlacePartition
         Loc l0 = ctx->getBelLocation(a->bel), l1 = ctx->getBelLocation(b->bel);
         return yaxis ? (l0.y < l1.y) : (l0.x < l1.x);
     });
-    size_t pivot_point = size_t(cells.size() * pivot);
+    // Find the number of cells to the left of the pivot, balancing on weight where possible so dense regions aren't
+    // all given to one thread
+    double total = total_weight();
+    size_t pivot_point = 0;
+    if (total > 0) {
+        double target = total * pivot, accum = 0;
+        while (pivot_point < cells.size() && accum < target)
+            accum += cell_weight(cells.at(pivot_point++));
+    } else {
+        pivot_point = size_t(cells.size() * pivot);
+    }
     l.cells.clear();
     r.cells.clear();
     l.cells.reserve(pivot_point);
@@ -83,6 +93,27 @@ void PlacePartition::split(Context *ctx, bool yaxis, float pivot, PlacePartition
     }
 }
 
+double PlacePartition::cell_weight(const CellInfo *cell)
+{
+    // Fixed cells are never moved by the detail placer, so add no work of their own
+    if (cell->belStrength > STRENGTH_STRONG)
+        return 0;
+    // Every move of a cell requires bounding box and timing updates for each connected net
+    double weight = 1;
+    for (auto &port : cell->ports)
+        if (port.second.net)
+            weight += 1;
+    return weight;
+}
+
+double PlacePartition::total_weight() const
+{
+    double weight = 0;
+    for (auto cell : cells)
+        weight += cell_weight(cell);
+    return weight;
+}
+
 void DetailPlacerState::update_global_costs()
 {
     last_bounds.resize(flat_nets.size());
@@ -106,51 +137,6 @@ void DetailPlacerState::update_global_costs()
     }
 }
 
-NetBB NetBB::compute(const Context *ctx, const NetInfo *net, const dict<IdString, BelId> *cell2bel)
-{
-    NetBB result{};
-    if (!net->driver.cell)
-        return result;
-    auto bel_loc = [&](const CellInfo *cell) {
-        if (cell->isPseudo())
-            return cell->getLocation();
-        BelId bel = cell2bel ? cell2bel->at(cell->name) : cell->bel;
-        return ctx->getBelLocation(bel);
-    };
-    result.nx0 = result.nx1 = result.ny0 = result.ny1 = 1;
-    Loc drv_loc = bel_loc(net->driver.cell);
-    result.x0 = result.x1 = drv_loc.x;
-    result.y0 = result.y1 = drv_loc.y;
-    for (auto &usr : net->users) {
-        Loc l = bel_loc(usr.cell);
-        if (l.x == result.x0)
-            ++result.nx0; // on the edge
-        else if (l.x < result.x0) {
-            result.x0 = l.x; // extends the edge
-            result.nx0 = 1;
-        }
-        if (l.x == result.x1)
-            ++result.nx1; // on the edge
-        else if (l.x > result.x1) {
-            result.x1 = l.x; // extends the edge
-            result.nx1 = 1;
-        }
-        if (l.y == result.y0)
-            ++result.ny0; // on the edge
-        else if (l.y < result.y0) {
-            result.y0 = l.y; // extends the edge
-            result.ny0 = 1;
-        }
-        if (l.y == result.y1)
-            ++result.ny1; // on the edge
-        else if (l.y > result.y1) {
-            result.y1 = l.y; // extends the edge
-            result.ny1 = 1;
-        }
-    }
-    return result;
-}
-
 void DetailPlacerThreadState::set_partition(const PlacePartition &part)
 {
     p = part;
@@ -313,72 +299,9 @@ void DetailPlacerThreadState::compute_changes_for_cell(CellInfo *cell, BelId old
         // For the x-axis (i=0) and y-axis (i=1)
         for (int i = 0; i < 2; i++) {
             auto &axis = axes.at(i);
-            // New and old on this axis
-            int new_pos = i ? new_loc.y : new_loc.x, old_pos = i ? old_loc.y : old_loc.x;
-            // References to updated bounding box entries
-            auto &b0 = i ? new_bounds.y0 : new_bounds.x0;
-            auto &n0 = i ? new_bounds.ny0 : new_bounds.nx0;
-            auto &b1 = i ? new_bounds.y1 : new_bounds.x1;
-            auto &n1 = i ? new_bounds.ny1 : new_bounds.nx1;
-            auto &change = axis.already_bounds_changed.at(idx);
-            // Lower bound
-            if (new_pos < b0) {
-                // Further out than current lower bound
-                b0 = new_pos;
-                n0 = 1;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (new_pos == b0 && old_pos > b0) {
-                // Moved from inside into current bound
-                ++n0;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (old_pos == b0 && new_pos > b0) {
-                // Moved from current bound to inside
-                if (change == NO_CHANGE)
-                    axis.bounds_changed_nets.push_back(idx);
-                if (n0 == 1) {
-                    // Was the last cell on the bound; have to do a full recompute
-                    change = FULL_RECOMPUTE;
-                } else {
-                    --n0;
-                    if (change == NO_CHANGE)
-                        change = CELL_MOVED_INWARDS;
-                }
-            }
-            // Upper bound
-            if (new_pos > b1) {
-                // Further out than current upper bound
-                b1 = new_pos;
-                n1 = 1;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (new_pos == b1 && old_pos < b1) {
-                // Moved onto current bound
-                ++n1;
-                if (change == NO_CHANGE) {
-                    change = CELL_MOVED_OUTWARDS;
-                    axis.bounds_changed_nets.push_back(idx);
-                }
-            } else if (old_pos == b1 && new_pos < b1) {
-                // Moved from current bound to inside
-                if (change == NO_CHANGE)
-                    axis.bounds_changed_nets.push_back(idx);
-                if (n1 == 1) {
-                    // Was the last cell on the bound; have to do a full recompute
-                    change = FULL_RECOMPUTE;
-                } else {
-                    --n1;
-                    if (change == NO_CHANGE)
-                        change = CELL_MOVED_INWARDS;
-                }
-            }
+            if (new_bounds.update_axis(i, i ? old_loc.y : old_loc.x, i ? new_loc.y : new_loc.x,
+                                       axis.already_bounds_changed.at(idx)))
+                axis.bounds_changed_nets.push_back(idx);
         }
         // Timing updates if timing driven
         if (g.base_cfg.timing_driven && !tmg_ignored_nets.at(idx)) {
@@ -407,15 +330,16 @@ void DetailPlacerThreadState::compute_total_change()
 {
     auto &xa = axes.at(0), &ya = axes.at(1);
     for (auto &bc : xa.bounds_changed_nets)
-        if (xa.already_bounds_changed.at(bc) == FULL_RECOMPUTE)
+        if (xa.already_bounds_changed.at(bc) == NetBB::FULL_RECOMPUTE)
             new_net_bounds.at(bc) = NetBB::compute(ctx, thread_nets.at(bc), &local_cell2bel);
     for (auto &bc : ya.bounds_changed_nets)
-        if (xa.already_bounds_changed.at(bc) != FULL_RECOMPUTE && ya.already_bounds_changed.at(bc) == FULL_RECOMPUTE)
+        if (xa.already_bounds_changed.at(bc) != NetBB::FULL_RECOMPUTE &&
+            ya.already_bounds_changed.at(bc) == NetBB::FULL_RECOMPUTE)
             new_net_bounds.at(bc) = NetBB::compute(ctx, thread_nets.at(bc), &local_cell2bel);
     for (auto &bc : xa.bounds_changed_nets)
         wirelen_delta += (new_net_bounds.at(bc).hpwl(g.base_cfg) - net_bounds.at(bc).hpwl(g.base_cfg));
     for (auto &bc : ya.bounds_changed_nets)
-        if (xa.already_bounds_changed.at(bc) == NO_CHANGE)
+        if (xa.already_bounds_changed.at(bc) == NetBB::NO_CHANGE)
             wirelen_delta += (new_net_bounds.at(bc).hpwl(g.base_cfg) - net_bounds.at(bc).hpwl(g.base_cfg));
     if (g.base_cfg.timing_driven) {
         NPNR_ASSERT(new_timing_costs.empty());
@@ -434,7 +358,7 @@ void DetailPlacerThreadState::reset_move_state()
     for (auto &axis : axes) {
         for (auto bc : axis.bounds_changed_nets) {
             new_net_bounds.at(bc) = net_bounds.at(bc);
-            axis.already_bounds_changed[bc] = NO_CHANGE;
+            axis.already_bounds_changed[bc] = NetBB::NO_CHANGE;
         }
         axis.bounds_changed_nets.clear();
     }
@@ -48,6 +48,7 @@ aborts the entire move transaction.
 
 #include "detail_place_cfg.h"
 #include "fast_bels.h"
+#include "net_bb.h"
 #include "timing.h"
 
 #include <queue>
@@ -64,22 +65,11 @@ struct PlacePartition
     std::vector<CellInfo *> cells;
     PlacePartition() = default;
     explicit PlacePartition(Context *ctx);
+    // Split along an axis, such that a fraction `pivot` of the total cell weight ends up in the lower partition
     void split(Context *ctx, bool yaxis, float pivot, PlacePartition &l, PlacePartition &r);
-};
-
-typedef int64_t wirelen_t;
-
-struct NetBB
-{
-    // Actual bounding box
-    int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
-    // Number of cells at each extremity
-    int nx0 = 0, nx1 = 0, ny0 = 0, ny1 = 0;
-    inline wirelen_t hpwl(const DetailPlaceCfg &cfg) const
-    {
-        return wirelen_t(cfg.hpwl_scale_x * (x1 - x0) + cfg.hpwl_scale_y * (y1 - y0));
-    }
-    static NetBB compute(const Context *ctx, const NetInfo *net, const dict<IdString, BelId> *cell2bel = nullptr);
+    // Estimate of the work a cell adds to a partition, used to balance partitions between threads
+    static double cell_weight(const CellInfo *cell);
+    double total_weight() const;
 };
 
 struct DetailPlacerState
@@ -177,17 +167,10 @@ struct DetailPlacerThreadState
     wirelen_t wirelen_delta = 0;
     double timing_delta = 0;
     // Wirelen related are handled on a per-axis basis to reduce
-    enum BoundChange
-    {
-        NO_CHANGE,
-        CELL_MOVED_INWARDS,
-        CELL_MOVED_OUTWARDS,
-        FULL_RECOMPUTE
-    };
     struct AxisChanges
     {
         std::vector<int> bounds_changed_nets;
-        std::vector<BoundChange> already_bounds_changed;
+        std::vector<NetBB::BoundChange> already_bounds_changed;
     };
     std::array<AxisChanges, 2> axes;
     std::vector<NetBB> new_net_bounds;
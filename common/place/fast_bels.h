@@ -57,23 +57,14 @@ struct FastBels
         NPNR_ASSERT(bel_data.get() == nullptr);
         bel_data = std::make_unique<FastBelsData>();
 
-        for (auto bel : ctx->getBels()) {
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
-            cell_type_data.number_of_possible_bels += 1;
-        }
+        const auto &valid_bels = ctx->getBelsForCellType(cell_type);
+        cell_type_data.number_of_possible_bels = int(valid_bels.size());
 
-        for (auto bel : ctx->getBels()) {
+        for (auto bel : valid_bels) {
             if (check_bel_available && !ctx->checkBelAvail(bel)) {
                 continue;
             }
 
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
             Loc loc = ctx->getBelLocation(bel);
             if (minBelsForGridPick >= 0 && cell_type_data.number_of_possible_bels < minBelsForGridPick) {
                 loc.x = loc.y = 0;
@@ -108,23 +99,16 @@ struct FastBels
         NPNR_ASSERT(bel_data.get() == nullptr);
         bel_data = std::make_unique<FastBelsData>();
 
-        for (auto bel : ctx->getBels()) {
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
-            }
-
-            type_data.number_of_possible_bels += 1;
-        }
+        std::vector<BelId> bucket_bels;
+        for (auto bel : ctx->getBelsInBucket(partition))
+            bucket_bels.push_back(bel);
+        type_data.number_of_possible_bels = int(bucket_bels.size());
 
-        for (auto bel : ctx->getBels()) {
+        for (auto bel : bucket_bels) {
             if (check_bel_available && !ctx->checkBelAvail(bel)) {
                 continue;
             }
 
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
-            }
-
             Loc loc = ctx->getBelLocation(bel);
             if (minBelsForGridPick >= 0 && type_data.number_of_possible_bels < minBelsForGridPick) {
                 loc.x = loc.y = 0;
@@ -0,0 +1,200 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "multi_seed.h"
+#include "log.h"
+#include "net_bb.h"
+#include "parallel_chunks.h"
+#include "timing.h"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <sys/wait.h>
+#include <unistd.h>
+#define NPNR_HAVE_FORK
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+// Result of one placement attempt, passed back from the worker over a pipe
+struct SeedResult
+{
+    bool ok = false;
+    delay_t worst_slack = 0;
+    wirelen_t wirelen = 0;
+    // Hash of the cell-bel bindings, to check that the replay reproduced the worker's placement
+    unsigned int bel_hash = 0;
+
+    // Prefer the best worst-case slack; designs without timing constraints (or ties) fall back to HPWL
+    bool better_than(const SeedResult &other) const
+    {
+        if (ok != other.ok)
+            return ok;
+        if (worst_slack != other.worst_slack)
+            return worst_slack > other.worst_slack;
+        return wirelen < other.wirelen;
+    }
+};
+
+SeedResult score_placement(Context *ctx)
+{
+    SeedResult result;
+    result.ok = true;
+    for (auto &net : ctx->nets) {
+        NetInfo *ni = net.second.get();
+        if (ni->driver.cell == nullptr)
+            continue;
+        result.wirelen += NetBB::compute(ctx, ni).hpwl(1, 1);
+    }
+    TimingAnalyser tmg(ctx);
+    tmg.setup_only = true;
+    tmg.setup();
+    result.worst_slack = tmg.get_worst_setup_slack();
+    for (auto &cell : ctx->cells)
+        result.bel_hash = mkhash(result.bel_hash, mkhash(cell.first.hash(), cell.second->bel.hash()));
+    return result;
+}
+
+#ifdef NPNR_HAVE_FORK
+// Runs in the forked worker: place silently with the given seed and report the score
+NPNR_NORETURN void run_worker(Context *ctx, uint64_t seed, int fd)
+{
+    log_streams.clear();
+    log_write_function = nullptr;
+    SeedResult result;
+    try {
+        ctx->rngstate = seed;
+        if (ctx->place())
+            result = score_placement(ctx);
+    } catch (log_execution_error_exception) {
+        result.ok = false;
+    }
+    bool written = (write(fd, &result, sizeof(result)) == ssize_t(sizeof(result)));
+    close(fd);
+    // Skip destructors and atexit handlers, which belong to the parent
+    _exit(written ? 0 : 1);
+}
+#endif
+
+} // namespace
+
+bool place_multi_seed(Context *ctx, int n_seeds)
+{
+    if (n_seeds <= 1)
+        return ctx->place();
+#ifndef NPNR_HAVE_FORK
+    log_warning("Multi-seed placement is not supported on this platform, using a single seed.\n");
+    return ctx->place();
+#else
+    // The first candidate is the seed a normal run would have used, so --place-seeds never does worse than a single
+    // run by its own metric
+    std::vector<uint64_t> seeds;
+    DeterministicRNG seeder;
+    seeder.rngseed(ctx->rngstate);
+    seeds.push_back(ctx->rngstate);
+    while (int(seeds.size()) < n_seeds)
+        seeds.push_back(seeder.rng64());
+
+    log_info("Running placement with %d seeds in parallel worker processes...\n", n_seeds);
+    auto start = std::chrono::high_resolution_clock::now();
+    // Anything still buffered would otherwise be written again by each worker
+    log_flush();
+    std::cout.flush();
+    fflush(stdout);
+    fflush(stderr);
+
+    // Each worker holds its own copy of the design once it starts placing, so no more than --threads of them are run at
+    // once
+    int max_workers = get_parallel_threads(ctx);
+    std::vector<SeedResult> results(seeds.size());
+    std::vector<std::pair<pid_t, int>> workers;
+    auto finish_worker = [&](size_t i) {
+        if (read(workers.at(i).second, &results.at(i), sizeof(SeedResult)) != ssize_t(sizeof(SeedResult)))
+            results.at(i).ok = false;
+        close(workers.at(i).second);
+        int status = 0;
+        waitpid(workers.at(i).first, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            results.at(i).ok = false;
+    };
+    for (size_t i = 0; i < seeds.size(); i++) {
+        if (int(i) >= max_workers)
+            finish_worker(i - max_workers);
+        int fds[2];
+        if (pipe(fds) != 0)
+            log_error("Failed to create pipe for placement worker.\n");
+        pid_t pid = fork();
+        if (pid < 0)
+            log_error("Failed to fork placement worker.\n");
+        if (pid == 0) {
+            close(fds[0]);
+            run_worker(ctx, seeds.at(i), fds[1]);
+        }
+        close(fds[1]);
+        workers.emplace_back(pid, fds[0]);
+    }
+    for (size_t i = std::max<int>(0, int(seeds.size()) - max_workers); i < seeds.size(); i++)
+        finish_worker(i);
+
+    int best = 0;
+    for (int i = 0; i < int(results.size()); i++) {
+        auto &r = results.at(i);
+        if (r.ok && r.worst_slack == std::numeric_limits<delay_t>::max())
+            log_info("    seed %2d (0x%016llx): HPWL %lld\n", i, (unsigned long long)seeds.at(i), (long long)r.wirelen);
+        else if (r.ok)
+            log_info("    seed %2d (0x%016llx): worst slack %.02f ns, HPWL %lld\n", i, (unsigned long long)seeds.at(i),
+                     ctx->getDelayNS(r.worst_slack), (long long)r.wirelen);
+        else
+            log_info("    seed %2d (0x%016llx): failed\n", i, (unsigned long long)seeds.at(i));
+        if (r.better_than(results.at(best)))
+            best = i;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    float worker_time = std::chrono::duration<float>(end - start).count();
+    log_info("Placement workers finished in %.02fs\n", worker_time);
+
+    if (!results.at(best).ok)
+        log_warning("All placement workers failed, replaying seed 0 for diagnostics.\n");
+    else
+        log_info("Replaying placement with seed %d.\n", best);
+    // Replaying the winner rather than transferring its bindings keeps the arch-specific changes made as part of
+    // placement (DSP port remapping, post-placement optimisation, uarch hooks, etc) without needing to serialise them.
+    // This costs one more placement run on top of the workers, which is reported as part of the cost of this mode
+    ctx->rngstate = seeds.at(best);
+    start = std::chrono::high_resolution_clock::now();
+    if (!ctx->place())
+        return false;
+    end = std::chrono::high_resolution_clock::now();
+    float replay_time = std::chrono::duration<float>(end - start).count();
+    // Routing a placement that was never scored would silently defeat the point of --place-seeds
+    if (results.at(best).ok && score_placement(ctx).bel_hash != results.at(best).bel_hash)
+        log_error("Replayed placement with seed %d differs from the worker result (placer is not deterministic).\n",
+                  best);
+    log_info("Multi-seed placement took %.02fs (%.02fs in %d workers, %.02fs replaying seed %d)\n",
+             worker_time + replay_time, worker_time, n_seeds, replay_time, best);
+    return true;
+#endif
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,197 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2021-22  gatecat <gatecat@ds0.me>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+Net bounding boxes shared between the placers.
+
+As well as the extent of the net, the number of pins on each edge of the box is kept. This means that when a pin
+moves, the box can almost always be updated in constant time: only when the last pin on an edge moves inwards is a
+full recompute over the pins of the net needed. Callers track the per-axis BoundChange state of each net during a
+move (or between two HPWL evaluations) so that every changed net is accounted for exactly once.
+*/
+
+#ifndef NET_BB_H
+#define NET_BB_H
+
+#include "nextpnr.h"
+#include "place_common.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct NetBB
+{
+    // Actual bounding box
+    int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+    // Number of cells at each extremity
+    int nx0 = 0, nx1 = 0, ny0 = 0, ny1 = 0;
+
+    enum BoundChange
+    {
+        NO_CHANGE,
+        CELL_MOVED_INWARDS,
+        CELL_MOVED_OUTWARDS,
+        FULL_RECOMPUTE
+    };
+
+    inline wirelen_t hpwl(int scale_x, int scale_y) const
+    {
+        return wirelen_t(scale_x * (x1 - x0) + scale_y * (y1 - y0));
+    }
+    // Any placer config with hpwl_scale_x and hpwl_scale_y fields
+    template <typename TCfg> inline wirelen_t hpwl(const TCfg &cfg) const
+    {
+        return hpwl(cfg.hpwl_scale_x, cfg.hpwl_scale_y);
+    }
+
+    // Reset to a box containing a single pin
+    inline void init(Loc l)
+    {
+        x0 = x1 = l.x;
+        y0 = y1 = l.y;
+        nx0 = nx1 = ny0 = ny1 = 1;
+    }
+
+    // Add a pin to the box, maintaining the edge counts
+    inline void extend(Loc l)
+    {
+        if (l.x == x0)
+            ++nx0; // on the edge
+        else if (l.x < x0) {
+            x0 = l.x; // extends the edge
+            nx0 = 1;
+        }
+        if (l.x == x1)
+            ++nx1; // on the edge
+        else if (l.x > x1) {
+            x1 = l.x; // extends the edge
+            nx1 = 1;
+        }
+        if (l.y == y0)
+            ++ny0; // on the edge
+        else if (l.y < y0) {
+            y0 = l.y; // extends the edge
+            ny0 = 1;
+        }
+        if (l.y == y1)
+            ++ny1; // on the edge
+        else if (l.y > y1) {
+            y1 = l.y; // extends the edge
+            ny1 = 1;
+        }
+    }
+
+    // Incrementally update one axis of the box for a pin moving from old_pos to new_pos. `change` is the accumulated
+    // change state of this axis of the net; once it reaches FULL_RECOMPUTE the box is no longer maintained and the
+    // caller must recompute it. Returns true if this is the first change to the axis, i.e. the net needs to be added
+    // to the caller's list of changed nets.
+    inline bool update_axis(bool yaxis, int old_pos, int new_pos, BoundChange &change)
+    {
+        if (change == FULL_RECOMPUTE)
+            return false;
+        bool first_change = (change == NO_CHANGE);
+        auto &b0 = yaxis ? y0 : x0;
+        auto &n0 = yaxis ? ny0 : nx0;
+        auto &b1 = yaxis ? y1 : x1;
+        auto &n1 = yaxis ? ny1 : nx1;
+        // Lower bound
+        if (new_pos < b0) {
+            // Further out than current lower bound
+            b0 = new_pos;
+            n0 = 1;
+            if (change == NO_CHANGE)
+                change = CELL_MOVED_OUTWARDS;
+        } else if (new_pos == b0 && old_pos > b0) {
+            // Moved from inside into current bound
+            ++n0;
+            if (change == NO_CHANGE)
+                change = CELL_MOVED_OUTWARDS;
+        } else if (old_pos == b0 && new_pos > b0) {
+            // Moved from current bound to inside
+            if (n0 == 1) {
+                // Was the last cell on the bound; have to do a full recompute
+                change = FULL_RECOMPUTE;
+            } else {
+                --n0;
+                if (change == NO_CHANGE)
+                    change = CELL_MOVED_INWARDS;
+            }
+        }
+        // Upper bound
+        if (new_pos > b1) {
+            // Further out than current upper bound
+            b1 = new_pos;
+            n1 = 1;
+            if (change == NO_CHANGE)
+                change = CELL_MOVED_OUTWARDS;
+        } else if (new_pos == b1 && old_pos < b1) {
+            // Moved onto current bound
+            ++n1;
+            if (change == NO_CHANGE)
+                change = CELL_MOVED_OUTWARDS;
+        } else if (old_pos == b1 && new_pos < b1) {
+            // Moved from current bound to inside
+            if (n1 == 1) {
+                // Was the last cell on the bound; have to do a full recompute
+                change = FULL_RECOMPUTE;
+            } else {
+                --n1;
+                if (change == NO_CHANGE)
+                    change = CELL_MOVED_INWARDS;
+            }
+        }
+        return first_change && (change != NO_CHANGE);
+    }
+
+    // Compute the box of a net from scratch. get_loc(const CellInfo *cell, Loc &loc) returns false for pins that
+    // should not be considered (such as unplaced cells); nets without a driver get an empty box.
+    template <typename TGetLoc> static NetBB compute(const NetInfo *net, TGetLoc get_loc)
+    {
+        NetBB result{};
+        if (!net->driver.cell)
+            return result;
+        Loc l;
+        if (get_loc(net->driver.cell, l))
+            result.init(l);
+        else
+            return result;
+        for (auto &usr : net->users) {
+            if (get_loc(usr.cell, l))
+                result.extend(l);
+        }
+        return result;
+    }
+
+    // Compute the box of a net from either the current placement, or a cell-bel map that overrides it
+    static NetBB compute(const Context *ctx, const NetInfo *net, const dict<IdString, BelId> *cell2bel = nullptr)
+    {
+        return compute(net, [&](const CellInfo *cell, Loc &l) {
+            if (cell->isPseudo()) {
+                l = cell->getLocation();
+            } else {
+                BelId bel = cell2bel ? cell2bel->at(cell->name) : cell->bel;
+                l = ctx->getBelLocation(bel);
+            }
+            return true;
+        });
+    }
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
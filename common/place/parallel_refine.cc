@@ -53,6 +53,8 @@ struct ThreadState : DetailPlacerThreadState
     // Total made and accepted moved
     GlobalState &g;
     int n_move = 0, n_accept = 0;
+    // Wall-clock time of the last iteration, for load balance reporting
+    double iter_time = 0;
 
     dict<std::pair<int, int>, std::vector<CellInfo *>> tile2cell;
 
@@ -315,6 +317,7 @@ struct ThreadState : DetailPlacerThreadState
 
     void run_iter()
     {
+        auto iter_start = std::chrono::high_resolution_clock::now();
         setup_initial_state();
         n_accept = 0;
         n_move = 0;
@@ -344,6 +347,8 @@ struct ThreadState : DetailPlacerThreadState
             if ((m % 2) == 0)
                 do_tile_swaps();
         }
+        auto iter_end = std::chrono::high_resolution_clock::now();
+        iter_time = std::chrono::duration<double>(iter_end - iter_start).count();
     }
 };
 
@@ -403,22 +408,30 @@ struct ParallelRefine
         }
     };
     std::vector<PlacePartition> parts;
+    // Recursively bisect a partition between a number of threads, which need not be a power of two. Each cut is made
+    // along the longer axis, with the pivot chosen so each side gets cell weight proportional to its thread count.
+    void split_partition(PlacePartition &part, int n_threads)
+    {
+        if (n_threads == 1) {
+            parts.push_back(std::move(part));
+            return;
+        }
+        int n_lower = n_threads / 2;
+        bool yaxis = (part.y1 - part.y0) > (part.x1 - part.x0);
+        // Randomly permute pivot every iteration so we get different thread boundaries
+        const float delta = 0.1;
+        float pivot = float(n_lower) / n_threads + delta * (ctx->rng(10000) / 10000.0f - 0.5f);
+        PlacePartition l, r;
+        part.split(ctx, yaxis, pivot, l, r);
+        split_partition(l, n_lower);
+        split_partition(r, n_threads - n_lower);
+    }
+
     void do_partition()
     {
         parts.clear();
-        parts.emplace_back(ctx);
-        bool yaxis = false;
-        while (parts.size() < t.size()) {
-            std::vector<PlacePartition> next(parts.size() * 2);
-            for (size_t i = 0; i < parts.size(); i++) {
-                // Randomly permute pivot every iteration so we get different thread boundaries
-                const float delta = 0.1;
-                float pivot = (0.5 - (delta / 2)) + (delta / 2) * (ctx->rng(10000) / 10000.0f);
-                parts.at(i).split(ctx, yaxis, pivot, next.at(i * 2), next.at(i * 2 + 1));
-            }
-            std::swap(parts, next);
-            yaxis = !yaxis;
-        }
+        PlacePartition top(ctx);
+        split_partition(top, int(t.size()));
 
         NPNR_ASSERT(parts.size() == t.size());
         // TODO: thread pool to make this worthwhile...
@@ -430,6 +443,22 @@ struct ParallelRefine
             w.join();
     }
 
+    void log_thread_stats(int iter)
+    {
+        double max_time = 0, total_time = 0;
+        for (auto &t_data : t) {
+            max_time = std::max(max_time, t_data.iter_time);
+            total_time += t_data.iter_time;
+        }
+        log_info("  iteration #%d thread balance: max time = %.03fs, mean time = %.03fs\n", iter, max_time,
+                 total_time / t.size());
+        for (auto &t_data : t) {
+            log_info("    thread %2d: %6d cells, %8d moves (%.0f/s), accept ratio %.03f\n", t_data.idx,
+                     int(t_data.p.cells.size()), t_data.n_move, t_data.n_move / std::max(t_data.iter_time, 1e-9),
+                     t_data.n_accept / std::max<double>(t_data.n_move, 1));
+        }
+    }
+
     void run()
     {
 
@@ -487,6 +516,8 @@ struct ParallelRefine
                 workers.emplace_back([this, j]() { t.at(j).run_iter(); });
             for (auto &w : workers)
                 w.join();
+            if (ctx->verbose)
+                log_thread_stats(iter);
             g.tmg.run();
             g.update_global_costs();
             iter++;
@@ -501,11 +532,8 @@ struct ParallelRefine
 ParallelRefineCfg::ParallelRefineCfg(Context *ctx) : DetailPlaceCfg(ctx)
 {
     threads = ctx->setting<int>("threads", 8);
-    // snap to nearest power of two; and minimum thread size
-    int actual_threads = 1;
-    while ((actual_threads * 2) <= threads && (int(ctx->cells.size()) / (actual_threads * 2)) >= min_thread_size)
-        actual_threads *= 2;
-    threads = actual_threads;
+    // limit to the minimum thread size; partitions are balanced so any thread count may be used
+    threads = std::max(1, std::min(threads, int(ctx->cells.size()) / min_thread_size));
 }
 
 bool parallel_refine(Context *ctx, ParallelRefineCfg cfg)
@@ -117,27 +117,25 @@ bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality)
             ctx->unbindBel(cell->bel);
         }
         IdString targetType = cell->type;
-        for (auto bel : ctx->getBels()) {
-            if (ctx->isValidBelForCellType(targetType, bel)) {
-                if (ctx->checkBelAvail(bel)) {
-                    wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
-                    if (iters >= 4)
-                        wirelen += ctx->rng(25);
-                    if (wirelen <= best_wirelen) {
-                        best_wirelen = wirelen;
-                        best_bel = bel;
-                    }
-                } else {
-                    wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
-                    if (iters >= 4)
-                        wirelen += ctx->rng(25);
-                    if (wirelen <= best_ripup_wirelen) {
-                        CellInfo *curr_cell = ctx->getBoundBelCell(bel);
-                        if (curr_cell->belStrength < STRENGTH_STRONG) {
-                            best_ripup_wirelen = wirelen;
-                            ripup_bel = bel;
-                            ripup_target = curr_cell;
-                        }
+        for (auto bel : ctx->getBelsForCellType(targetType)) {
+            if (ctx->checkBelAvail(bel)) {
+                wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
+                if (iters >= 4)
+                    wirelen += ctx->rng(25);
+                if (wirelen <= best_wirelen) {
+                    best_wirelen = wirelen;
+                    best_bel = bel;
+                }
+            } else {
+                wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
+                if (iters >= 4)
+                    wirelen += ctx->rng(25);
+                if (wirelen <= best_ripup_wirelen) {
+                    CellInfo *curr_cell = ctx->getBoundBelCell(bel);
+                    if (curr_cell->belStrength < STRENGTH_STRONG) {
+                        best_ripup_wirelen = wirelen;
+                        ripup_bel = bel;
+                        ripup_target = curr_cell;
                     }
                 }
             }
@@ -41,6 +41,7 @@
 #include <vector>
 #include "fast_bels.h"
 #include "log.h"
+#include "net_bb.h"
 #include "place_common.h"
 #include "scope_lock.h"
 #include "timing.h"
@@ -50,19 +51,6 @@ NEXTPNR_NAMESPACE_BEGIN
 
 class SAPlacer
 {
-  private:
-    struct BoundingBox
-    {
-        // Actual bounding box
-        int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
-        // Number of cells at each extremity
-        int nx0 = 0, nx1 = 0, ny0 = 0, ny1 = 0;
-        wirelen_t hpwl(const Placer1Cfg &cfg) const
-        {
-            return wirelen_t(cfg.hpwl_scale_x * (x1 - x0) + cfg.hpwl_scale_y * (y1 - y0));
-        }
-    };
-
   public:
     SAPlacer(Context *ctx, Placer1Cfg cfg)
             : ctx(ctx), fast_bels(ctx, /*check_bel_available=*/false, cfg.minBelsForGridPick), cfg(cfg), tmg(ctx)
@@ -88,18 +76,21 @@ class SAPlacer
 
         net_bounds.resize(ctx->nets.size());
         net_arc_tcost.resize(ctx->nets.size());
+        net_arc_crit.resize(ctx->nets.size());
+        net_moved.resize(ctx->nets.size());
         old_udata.reserve(ctx->nets.size());
         net_by_udata.reserve(ctx->nets.size());
         decltype(NetInfo::udata) n = 0;
         for (auto &net : ctx->nets) {
             old_udata.emplace_back(net.second->udata);
             net_arc_tcost.at(n).resize(net.second->users.capacity());
+            net_arc_crit.at(n).resize(net.second->users.capacity());
             net.second->udata = n++;
             net_by_udata.push_back(net.second.get());
         }
         for (auto &region : ctx->region) {
             Region *r = region.second.get();
-            BoundingBox bb;
+            NetBB bb;
             if (r->constr_bels) {
                 bb.x0 = std::numeric_limits<int>::max();
                 bb.x1 = std::numeric_limits<int>::min();
@@ -351,8 +342,10 @@ class SAPlacer
             }
             // Once cooled below legalise threshold, run legalisation and start requiring
             // legal moves only
+            bool legalised = false;
             if (diameter < legalise_dia && require_legal) {
                 if (legalise_relative_constraints(ctx)) {
+                    legalised = true;
                     // Only increase temperature if something was moved
                     autoplaced.clear();
                     chain_basis.clear();
@@ -378,11 +371,16 @@ class SAPlacer
                 assign_budget(ctx, true /* quiet */);
             }
 
-            // Invoke timing analysis to obtain criticalities
-            if (!cfg.budgetBased && cfg.timing_driven)
-                tmg.run();
-            // Need to rebuild costs after criticalities change
-            setup_costs();
+            if (cfg.budgetBased || legalised) {
+                // Invoke timing analysis to obtain criticalities
+                if (!cfg.budgetBased && cfg.timing_driven)
+                    tmg.run();
+                // Need to rebuild costs after criticalities or budgets change
+                setup_costs();
+            } else {
+                // Only the nets touched by accepted moves have new delays, so update criticalities incrementally
+                update_costs();
+            }
             // Reset incremental bounds
             moveChange.reset(this);
             moveChange.new_net_bounds = net_bounds;
@@ -816,50 +814,15 @@ class SAPlacer
     }
 
     // Get the bounding box for a net
-    inline BoundingBox get_net_bounds(NetInfo *net)
+    inline NetBB get_net_bounds(NetInfo *net)
     {
-        BoundingBox bb;
         NPNR_ASSERT(net->driver.cell != nullptr);
-        Loc dloc = net->driver.cell->getLocation();
-        bb.x0 = dloc.x;
-        bb.x1 = dloc.x;
-        bb.y0 = dloc.y;
-        bb.y1 = dloc.y;
-        bb.nx0 = 1;
-        bb.nx1 = 1;
-        bb.ny0 = 1;
-        bb.ny1 = 1;
-        for (auto user : net->users) {
-            if (!user.cell->isPseudo() && user.cell->bel == BelId())
-                continue;
-            Loc uloc = user.cell->getLocation();
-            if (bb.x0 == uloc.x)
-                ++bb.nx0;
-            else if (uloc.x < bb.x0) {
-                bb.x0 = uloc.x;
-                bb.nx0 = 1;
-            }
-            if (bb.x1 == uloc.x)
-                ++bb.nx1;
-            else if (uloc.x > bb.x1) {
-                bb.x1 = uloc.x;
-                bb.nx1 = 1;
-            }
-            if (bb.y0 == uloc.y)
-                ++bb.ny0;
-            else if (uloc.y < bb.y0) {
-                bb.y0 = uloc.y;
-                bb.ny0 = 1;
-            }
-            if (bb.y1 == uloc.y)
-                ++bb.ny1;
-            else if (uloc.y > bb.y1) {
-                bb.y1 = uloc.y;
-                bb.ny1 = 1;
-            }
-        }
-
-        return bb;
+        return NetBB::compute(net, [](const CellInfo *cell, Loc &loc) {
+            if (!cell->isPseudo() && cell->bel == BelId())
+                return false;
+            loc = cell->getLocation();
+            return true;
+        });
     }
 
     // Get the timing cost for an arc of a net
@@ -883,17 +846,57 @@ class SAPlacer
     // Set up the cost maps
     void setup_costs()
     {
+        clear_moved_nets();
         for (auto &net : ctx->nets) {
             NetInfo *ni = net.second.get();
             if (ignore_net(ni))
                 continue;
             net_bounds[ni->udata] = get_net_bounds(ni);
             if (cfg.timing_driven && int(ni->users.entries()) < cfg.timingFanoutThresh)
-                for (auto usr : ni->users.enumerate())
+                for (auto usr : ni->users.enumerate()) {
                     net_arc_tcost[ni->udata][usr.index.idx()] = get_timing_cost(ni, usr.value);
+                    if (!cfg.budgetBased)
+                        net_arc_crit[ni->udata][usr.index.idx()] = tmg.get_criticality(CellPortKey(usr.value));
+                }
         }
     }
 
+    // Update the cost maps after a temperature step, when only the nets in moved_nets have changed placement. Route
+    // delays are only refreshed for those nets before re-running STA; arc timing costs are then recomputed only where
+    // the arc delay or its criticality changed.
+    void update_costs()
+    {
+        for (auto ni : moved_nets)
+            if (!ignore_net(ni))
+                net_bounds[ni->udata] = get_net_bounds(ni);
+        if (cfg.timing_driven) {
+            for (auto ni : moved_nets)
+                tmg.update_route_delays(ni);
+            tmg.run(false);
+            for (auto ni : net_by_udata) {
+                if (ignore_net(ni) || int(ni->users.entries()) >= cfg.timingFanoutThresh)
+                    continue;
+                bool moved = net_moved[ni->udata];
+                for (auto usr : ni->users.enumerate()) {
+                    float crit = tmg.get_criticality(CellPortKey(usr.value));
+                    float &last_crit = net_arc_crit[ni->udata][usr.index.idx()];
+                    if (!moved && crit == last_crit)
+                        continue;
+                    net_arc_tcost[ni->udata][usr.index.idx()] = get_timing_cost(ni, usr.value);
+                    last_crit = crit;
+                }
+            }
+        }
+        clear_moved_nets();
+    }
+
+    void clear_moved_nets()
+    {
+        for (auto ni : moved_nets)
+            net_moved[ni->udata] = false;
+        moved_nets.clear();
+    }
+
     // Get the total wiring cost for the design
     wirelen_t total_wirelen_cost()
     {
@@ -918,22 +921,15 @@ class SAPlacer
     // Cost-change-related data for a move
     struct MoveChangeData
     {
-
-        enum BoundChangeType
-        {
-            NO_CHANGE,
-            CELL_MOVED_INWARDS,
-            CELL_MOVED_OUTWARDS,
-            FULL_RECOMPUTE
-        };
-
         std::vector<decltype(NetInfo::udata)> bounds_changed_nets_x, bounds_changed_nets_y;
         std::vector<std::pair<decltype(NetInfo::udata), store_index<PortRef>>> changed_arcs;
 
-        std::vector<BoundChangeType> already_bounds_changed_x, already_bounds_changed_y;
+        std::vector<NetBB::BoundChange> already_bounds_changed_x, already_bounds_changed_y;
         std::vector<std::vector<bool>> already_changed_arcs;
 
-        std::vector<BoundingBox> new_net_bounds;
+        std::vector<NetBB> new_net_bounds;
+        // All nets with a pin that moved, whether or not their cost changed
+        std::vector<NetInfo *> touched_nets;
         std::vector<std::pair<std::pair<decltype(NetInfo::udata), store_index<PortRef>>, double>> new_arc_costs;
 
         wirelen_t wirelen_delta = 0;
@@ -954,17 +950,18 @@ class SAPlacer
         {
             for (auto bc : bounds_changed_nets_x) {
                 new_net_bounds[bc] = p->net_bounds[bc];
-                already_bounds_changed_x[bc] = NO_CHANGE;
+                already_bounds_changed_x[bc] = NetBB::NO_CHANGE;
             }
             for (auto bc : bounds_changed_nets_y) {
                 new_net_bounds[bc] = p->net_bounds[bc];
-                already_bounds_changed_y[bc] = NO_CHANGE;
+                already_bounds_changed_y[bc] = NetBB::NO_CHANGE;
             }
             for (const auto &tc : changed_arcs)
                 already_changed_arcs[tc.first][tc.second.idx()] = false;
             bounds_changed_nets_x.clear();
             bounds_changed_nets_y.clear();
             changed_arcs.clear();
+            touched_nets.clear();
             new_arc_costs.clear();
             wirelen_delta = 0;
             timing_delta = 0;
@@ -981,129 +978,20 @@ class SAPlacer
             NetInfo *pn = port.second.net;
             if (pn == nullptr)
                 continue;
+            mc.touched_nets.push_back(pn);
             if (ignore_net(pn))
                 continue;
-            BoundingBox &curr_bounds = mc.new_net_bounds[pn->udata];
+            NetBB &curr_bounds = mc.new_net_bounds[pn->udata];
             // Incremental bounding box updates
             // Note that everything other than full updates are applied immediately rather than being queued,
             // so further updates to the same net in the same move are dealt with correctly.
-            // If a full update is already queued, this can be considered a no-op
-            if (mc.already_bounds_changed_x[pn->udata] != MoveChangeData::FULL_RECOMPUTE) {
-                // Bounds x0
-                if (curr_loc.x < curr_bounds.x0) {
-                    // Further out than current bounds x0
-                    curr_bounds.x0 = curr_loc.x;
-                    curr_bounds.nx0 = 1;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        // Checking already_bounds_changed_x ensures that each net is only added once
-                        // to bounds_changed_nets, lest we add its HPWL change multiple times skewing the
-                        // overall cost change
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (curr_loc.x == curr_bounds.x0 && old_loc.x > curr_bounds.x0) {
-                    curr_bounds.nx0++;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (old_loc.x == curr_bounds.x0 && curr_loc.x > curr_bounds.x0) {
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    if (curr_bounds.nx0 == 1) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.nx0--;
-                        if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-
-                // Bounds x1
-                if (curr_loc.x > curr_bounds.x1) {
-                    // Further out than current bounds x1
-                    curr_bounds.x1 = curr_loc.x;
-                    curr_bounds.nx1 = 1;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        // Checking already_bounds_changed_x ensures that each net is only added once
-                        // to bounds_changed_nets, lest we add its HPWL change multiple times skewing the
-                        // overall cost change
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (curr_loc.x == curr_bounds.x1 && old_loc.x < curr_bounds.x1) {
-                    curr_bounds.nx1++;
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    }
-                } else if (old_loc.x == curr_bounds.x1 && curr_loc.x < curr_bounds.x1) {
-                    if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_x.push_back(pn->udata);
-                    if (curr_bounds.nx1 == 1) {
-                        mc.already_bounds_changed_x[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.nx1--;
-                        if (mc.already_bounds_changed_x[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_x[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-            }
-            if (mc.already_bounds_changed_y[pn->udata] != MoveChangeData::FULL_RECOMPUTE) {
-                // Bounds y0
-                if (curr_loc.y < curr_bounds.y0) {
-                    // Further out than current bounds y0
-                    curr_bounds.y0 = curr_loc.y;
-                    curr_bounds.ny0 = 1;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (curr_loc.y == curr_bounds.y0 && old_loc.y > curr_bounds.y0) {
-                    curr_bounds.ny0++;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (old_loc.y == curr_bounds.y0 && curr_loc.y > curr_bounds.y0) {
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    if (curr_bounds.ny0 == 1) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.ny0--;
-                        if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-
-                // Bounds y1
-                if (curr_loc.y > curr_bounds.y1) {
-                    // Further out than current bounds y1
-                    curr_bounds.y1 = curr_loc.y;
-                    curr_bounds.ny1 = 1;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (curr_loc.y == curr_bounds.y1 && old_loc.y < curr_bounds.y1) {
-                    curr_bounds.ny1++;
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_OUTWARDS;
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    }
-                } else if (old_loc.y == curr_bounds.y1 && curr_loc.y < curr_bounds.y1) {
-                    if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                        mc.bounds_changed_nets_y.push_back(pn->udata);
-                    if (curr_bounds.ny1 == 1) {
-                        mc.already_bounds_changed_y[pn->udata] = MoveChangeData::FULL_RECOMPUTE;
-                    } else {
-                        curr_bounds.ny1--;
-                        if (mc.already_bounds_changed_y[pn->udata] == MoveChangeData::NO_CHANGE)
-                            mc.already_bounds_changed_y[pn->udata] = MoveChangeData::CELL_MOVED_INWARDS;
-                    }
-                }
-            }
+            // If a full update is already queued, this can be considered a no-op.
+            // Checking for the first change ensures that each net is only added once to bounds_changed_nets, lest we
+            // add its HPWL change multiple times skewing the overall cost change
+            if (curr_bounds.update_axis(false, old_loc.x, curr_loc.x, mc.already_bounds_changed_x[pn->udata]))
+                mc.bounds_changed_nets_x.push_back(pn->udata);
+            if (curr_bounds.update_axis(true, old_loc.y, curr_loc.y, mc.already_bounds_changed_y[pn->udata]))
+                mc.bounds_changed_nets_y.push_back(pn->udata);
 
             if (cfg.timing_driven && int(pn->users.entries()) < cfg.timingFanoutThresh) {
                 // Output ports - all arcs change timing
@@ -1130,19 +1018,19 @@ class SAPlacer
     void compute_cost_changes(MoveChangeData &md)
     {
         for (const auto &bc : md.bounds_changed_nets_x) {
-            if (md.already_bounds_changed_x[bc] == MoveChangeData::FULL_RECOMPUTE)
+            if (md.already_bounds_changed_x[bc] == NetBB::FULL_RECOMPUTE)
                 md.new_net_bounds[bc] = get_net_bounds(net_by_udata[bc]);
         }
         for (const auto &bc : md.bounds_changed_nets_y) {
-            if (md.already_bounds_changed_x[bc] != MoveChangeData::FULL_RECOMPUTE &&
-                md.already_bounds_changed_y[bc] == MoveChangeData::FULL_RECOMPUTE)
+            if (md.already_bounds_changed_x[bc] != NetBB::FULL_RECOMPUTE &&
+                md.already_bounds_changed_y[bc] == NetBB::FULL_RECOMPUTE)
                 md.new_net_bounds[bc] = get_net_bounds(net_by_udata[bc]);
         }
 
         for (const auto &bc : md.bounds_changed_nets_x)
             md.wirelen_delta += md.new_net_bounds[bc].hpwl(cfg) - net_bounds[bc].hpwl(cfg);
         for (const auto &bc : md.bounds_changed_nets_y)
-            if (md.already_bounds_changed_x[bc] == MoveChangeData::NO_CHANGE)
+            if (md.already_bounds_changed_x[bc] == NetBB::NO_CHANGE)
                 md.wirelen_delta += md.new_net_bounds[bc].hpwl(cfg) - net_bounds[bc].hpwl(cfg);
 
         if (cfg.timing_driven) {
@@ -1167,6 +1055,12 @@ class SAPlacer
             net_arc_tcost[tc.first.first].at(tc.first.second.idx()) = tc.second;
         curr_wirelen_cost += md.wirelen_delta;
         curr_timing_cost += md.timing_delta;
+        for (auto ni : md.touched_nets) {
+            if (net_moved[ni->udata])
+                continue;
+            net_moved[ni->udata] = true;
+            moved_nets.push_back(ni);
+        }
     }
 
     // Simple routeability driven placement
@@ -1231,9 +1125,14 @@ class SAPlacer
     }
 
     // Map nets to their bounding box (so we can skip recompute for moves that do not exceed the bounds
-    std::vector<BoundingBox> net_bounds;
+    std::vector<NetBB> net_bounds;
     // Map net arcs to their timing cost (criticality * delay ns)
     std::vector<std::vector<double>> net_arc_tcost;
+    // Map net arcs to the criticality their timing cost was last computed with
+    std::vector<std::vector<float>> net_arc_crit;
+    // Nets with a pin moved by an accepted move since the costs were last updated
+    std::vector<NetInfo *> moved_nets;
+    std::vector<bool> net_moved;
 
     // Fast lookup for cell to clusters
     dict<ClusterId, std::vector<CellInfo *>> cluster2cell;
@@ -1250,7 +1149,7 @@ class SAPlacer
     int n_move, n_accept;
     int diameter = 35, max_x = 1, max_y = 1;
     dict<IdString, std::tuple<int, int>> bel_types;
-    dict<IdString, BoundingBox> region_bounds;
+    dict<IdString, NetBB> region_bounds;
     FastBels fast_bels;
     pool<BelId> locked_bels;
     std::vector<NetInfo *> net_by_udata;
@@ -43,6 +43,7 @@
 #include <tuple>
 #include "fast_bels.h"
 #include "log.h"
+#include "net_bb.h"
 #include "nextpnr.h"
 #include "parallel_refine.h"
 #include "place_common.h"
@@ -393,6 +394,8 @@ class HeAPPlacer
         int legal_x, legal_y;
         double rawx, rawy;
         bool locked, global;
+        // Location as of the last HPWL update
+        int hpwl_x, hpwl_y;
     };
     dict<IdString, CellLocation> cell_locs;
     // The set of cells that we will actually place. This excludes locked cells and children cells of macros/chains
@@ -405,6 +408,19 @@ class HeAPPlacer
 
     dict<ClusterId, std::vector<CellInfo *>> cluster2cells;
     dict<ClusterId, int> chain_size;
+
+    // Incrementally maintained net bounding boxes, so that HPWL evaluation only touches nets connected to cells that
+    // have moved since the last evaluation. Every change to the x/y of a cell location must queue the cell in
+    // hpwl_moved_cells (cells may be queued more than once)
+    dict<IdString, int> hpwl_net_idx;
+    std::vector<NetInfo *> hpwl_nets;
+    std::vector<NetBB> hpwl_bounds;
+    std::vector<NetBB::BoundChange> hpwl_changed_x, hpwl_changed_y;
+    std::vector<bool> hpwl_net_dirty;
+    std::vector<int> hpwl_changed_nets;
+    std::vector<IdString> hpwl_moved_cells;
+    wirelen_t curr_hpwl = 0;
+    bool hpwl_init = false;
     // Performance counting
     double solve_time = 0, cl_time = 0, sl_time = 0;
 
@@ -542,13 +558,9 @@ class HeAPPlacer
         pool<BelId> bels_used;
         dict<IdString, std::deque<BelId>> available_bels;
 
-        for (auto bel : ctx->getBels()) {
-            if (!ctx->checkBelAvail(bel)) {
-                continue;
-            }
-
-            for (auto cell_type : cell_types) {
-                if (ctx->isValidBelForCellType(cell_type, bel)) {
+        for (auto cell_type : cell_types) {
+            for (auto bel : ctx->getBelsForCellType(cell_type)) {
+                if (ctx->checkBelAvail(bel)) {
                     available_bels[cell_type].push_back(bel);
                 }
             }
@@ -653,6 +665,8 @@ class HeAPPlacer
                 continue;
             cell->udata = row++;
             solve_cells.push_back(cell);
+            // About to be moved by the solver, which may run the two axes on separate threads
+            hpwl_moved_cells.push_back(cell->name);
         }
         // Finally, update the udata of children
         for (auto &cluster : cluster2cells)
@@ -672,8 +686,14 @@ class HeAPPlacer
                     if (child != cell)
                         chain_size[cell->name]++;
                     Loc offset = ctx->getClusterOffset(child);
-                    cell_locs[child->name].x = std::max(0, std::min(max_x, base.x + offset.x));
-                    cell_locs[child->name].y = std::max(0, std::min(max_y, base.y + offset.y));
+                    CellLocation &child_loc = cell_locs[child->name];
+                    int x = std::max(0, std::min(max_x, base.x + offset.x));
+                    int y = std::max(0, std::min(max_y, base.y + offset.y));
+                    if (child_loc.x != x || child_loc.y != y) {
+                        child_loc.x = x;
+                        child_loc.y = y;
+                        hpwl_moved_cells.push_back(child->name);
+                    }
                 }
             }
         }
@@ -807,28 +827,84 @@ class HeAPPlacer
             }
     }
 
+    bool hpwl_skip_net(const NetInfo *ni)
+    {
+        return ni->driver.cell == nullptr || cell_locs.at(ni->driver.cell->name).global;
+    }
+
+    NetBB compute_net_bounds(const NetInfo *ni)
+    {
+        return NetBB::compute(ni, [&](const CellInfo *cell, Loc &loc) {
+            const CellLocation &cl = cell_locs.at(cell->name);
+            loc = Loc(cl.x, cl.y, 0);
+            return true;
+        });
+    }
+
     // Compute HPWL
     wirelen_t total_hpwl()
     {
-        wirelen_t hpwl = 0;
-        for (auto &net : ctx->nets) {
-            NetInfo *ni = net.second.get();
-            if (ni->driver.cell == nullptr)
-                continue;
-            CellLocation &drvloc = cell_locs.at(ni->driver.cell->name);
-            if (drvloc.global)
+        if (!hpwl_init) {
+            hpwl_nets.clear();
+            hpwl_net_idx.clear();
+            for (auto &net : ctx->nets) {
+                hpwl_net_idx[net.first] = int(hpwl_nets.size());
+                hpwl_nets.push_back(net.second.get());
+            }
+            hpwl_bounds.resize(hpwl_nets.size());
+            hpwl_changed_x.resize(hpwl_nets.size(), NetBB::NO_CHANGE);
+            hpwl_changed_y.resize(hpwl_nets.size(), NetBB::NO_CHANGE);
+            hpwl_net_dirty.resize(hpwl_nets.size(), false);
+            for (auto &cl : cell_locs) {
+                cl.second.hpwl_x = cl.second.x;
+                cl.second.hpwl_y = cl.second.y;
+            }
+            curr_hpwl = 0;
+            for (int i = 0; i < int(hpwl_nets.size()); i++) {
+                if (hpwl_skip_net(hpwl_nets.at(i)))
+                    continue;
+                hpwl_bounds.at(i) = compute_net_bounds(hpwl_nets.at(i));
+                curr_hpwl += hpwl_bounds.at(i).hpwl(cfg);
+            }
+            hpwl_moved_cells.clear();
+            hpwl_init = true;
+            return curr_hpwl;
+        }
+        // Apply the movement of each cell since the last update to the bounding boxes of its nets
+        for (IdString cell : hpwl_moved_cells) {
+            CellLocation &loc = cell_locs.at(cell);
+            if (loc.x == loc.hpwl_x && loc.y == loc.hpwl_y)
                 continue;
-            int xmin = drvloc.x, xmax = drvloc.x, ymin = drvloc.y, ymax = drvloc.y;
-            for (auto &user : ni->users) {
-                CellLocation &usrloc = cell_locs.at(user.cell->name);
-                xmin = std::min(xmin, usrloc.x);
-                xmax = std::max(xmax, usrloc.x);
-                ymin = std::min(ymin, usrloc.y);
-                ymax = std::max(ymax, usrloc.y);
+            for (auto &port : ctx->cells.at(cell)->ports) {
+                NetInfo *ni = port.second.net;
+                if (ni == nullptr || hpwl_skip_net(ni))
+                    continue;
+                int idx = hpwl_net_idx.at(ni->name);
+                NetBB &bb = hpwl_bounds.at(idx);
+                if (!hpwl_net_dirty.at(idx)) {
+                    // Remove the old wirelength of the net, the new one is added back once all moves are applied
+                    curr_hpwl -= bb.hpwl(cfg);
+                    hpwl_net_dirty.at(idx) = true;
+                    hpwl_changed_nets.push_back(idx);
+                }
+                bb.update_axis(false, loc.hpwl_x, loc.x, hpwl_changed_x.at(idx));
+                bb.update_axis(true, loc.hpwl_y, loc.y, hpwl_changed_y.at(idx));
             }
-            hpwl += cfg.hpwl_scale_x * (xmax - xmin) + cfg.hpwl_scale_y * (ymax - ymin);
+            loc.hpwl_x = loc.x;
+            loc.hpwl_y = loc.y;
+        }
+        hpwl_moved_cells.clear();
+        for (int idx : hpwl_changed_nets) {
+            NetBB &bb = hpwl_bounds.at(idx);
+            if (hpwl_changed_x.at(idx) == NetBB::FULL_RECOMPUTE || hpwl_changed_y.at(idx) == NetBB::FULL_RECOMPUTE)
+                bb = compute_net_bounds(hpwl_nets.at(idx));
+            curr_hpwl += bb.hpwl(cfg);
+            hpwl_changed_x.at(idx) = NetBB::NO_CHANGE;
+            hpwl_changed_y.at(idx) = NetBB::NO_CHANGE;
+            hpwl_net_dirty.at(idx) = false;
         }
-        return hpwl;
+        hpwl_changed_nets.clear();
+        return curr_hpwl;
     }
 
     // Strict placement legalisation, performed after the initial HeAP spreading
@@ -966,6 +1042,7 @@ class HeAPPlacer
                     Loc loc = ctx->getBelLocation(bestBel);
                     cell_locs[ci->name].x = loc.x;
                     cell_locs[ci->name].y = loc.y;
+                    hpwl_moved_cells.push_back(ci->name);
                     break;
                 }
 
@@ -1025,6 +1102,7 @@ class HeAPPlacer
                                 Loc loc = ctx->getBelLocation(sz);
                                 cell_locs[ci->name].x = loc.x;
                                 cell_locs[ci->name].y = loc.y;
+                                hpwl_moved_cells.push_back(ci->name);
                                 placed = true;
                                 break;
                             }
@@ -1079,6 +1157,7 @@ class HeAPPlacer
                             Loc loc = ctx->getBelLocation(target.second);
                             cell_locs[target.first->name].x = loc.x;
                             cell_locs[target.first->name].y = loc.y;
+                            hpwl_moved_cells.push_back(target.first->name);
                             // log_info("%s %d %d %d\n", target.first->name.c_str(ctx), loc.x, loc.y, loc.z);
                         }
                         for (auto &swap : swaps_made) {
@@ -1776,6 +1855,7 @@ class HeAPPlacer
                 auto &cl = p->cell_locs.at(cell->name);
                 cl.x = std::min(r.x1, std::max(r.x0, int(cl.rawx)));
                 cl.y = std::min(r.y1, std::max(r.y0, int(cl.rawy)));
+                p->hpwl_moved_cells.push_back(cell->name);
                 cells_at_location.at(cl.x).at(cl.y).push_back(cell);
             }
             SpreaderRegion rl, rr;
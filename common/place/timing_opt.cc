@@ -96,12 +96,11 @@ class TimingOptimiser
             if (port.second.type == PORT_IN) {
                 if (net->driver.cell == nullptr || net->driver.cell->bel == BelId())
                     continue;
-                for (auto user : net->users) {
-                    if (user.cell == cell && user.port == port.first) {
-                        if (ctx->predictArcDelay(net, user) >
-                            1.1 * max_net_delay.at(std::make_pair(cell->name, port.first)))
-                            return false;
-                    }
+                if (port.second.user_idx) {
+                    auto &user = net->users.at(port.second.user_idx);
+                    if (ctx->predictArcDelay(net, user) >
+                        1.1 * max_net_delay.at(std::make_pair(cell->name, port.first)))
+                        return false;
                 }
 
             } else if (port.second.type == PORT_OUT) {
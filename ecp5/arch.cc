@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/range/adaptor/reversed.hpp>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include "embed.h"
@@ -85,6 +86,7 @@ std::vector<std::string> Arch::get_supported_packages(ArchArgs::ArchArgsTypes ch
 
 Arch::Arch(ArchArgs args) : args(args)
 {
+    auto setup_start = std::chrono::high_resolution_clock::now();
     chip_info = get_chip_info(args.type);
     if (chip_info == nullptr)
         log_error("Unsupported ECP5 chip type.\n");
@@ -103,27 +105,13 @@ Arch::Arch(ArchArgs args) : args(args)
     if (!package_info)
         log_error("Unsupported package '%s' for '%s'.\n", args.package.c_str(), getChipName().c_str());
 
+    auto chipdb_end = std::chrono::high_resolution_clock::now();
+
     tile_status.resize(chip_info->num_tiles);
-    for (int i = 0; i < chip_info->num_tiles; i++) {
-        auto &ts = tile_status.at(i);
-        auto &tile_data = chip_info->tile_info[i];
-        ts.boundcells.resize(chip_info->locations[chip_info->location_type[i]].bel_data.size(), nullptr);
-        for (auto &name : tile_data.tile_names) {
-            if (strcmp(chip_info->tiletype_names[name.type_idx].get(), "PLC2") == 0) {
-                // Is a logic tile
-                ts.lts = new LogicTileStatus();
-                break;
-            }
-        }
-    }
 
     BaseArch::init_cell_types();
     BaseArch::init_bel_buckets();
-
-    for (int i = 0; i < chip_info->width; i++)
-        x_ids.push_back(idf("X%d", i));
-    for (int i = 0; i < chip_info->height; i++)
-        y_ids.push_back(idf("Y%d", i));
+    auto cell_types_end = std::chrono::high_resolution_clock::now();
 
     for (int i = 0; i < chip_info->width; i++) {
         IdString x_id = idf("X%d", i);
@@ -136,28 +124,33 @@ Arch::Arch(ArchArgs args) : args(args)
         id_to_y[y_id] = i;
     }
 
+    bel_index_by_name.resize(chip_info->locations.size());
+    wire_index_by_name.resize(chip_info->locations.size());
+
+    // Same order as getWires() and getPips(), but counted per tile rather than by visiting every wire and pip
     wire_tile_vecidx.resize(chip_info->num_tiles, -1);
-    int n_wires = 0;
-    for (auto e : getWires()) {
-        if (e.index == 0) {
-            wire_tile_vecidx.at(e.location.y * chip_info->width + e.location.x) = n_wires;
-        }
-        n_wires++;
+    pip_tile_vecidx.resize(chip_info->num_tiles, -1);
+    int n_wires = 0, n_pips = 0;
+    for (int i = 0; i < chip_info->num_tiles; i++) {
+        auto &loc = chip_info->locations[chip_info->location_type[i]];
+        if (loc.wire_data.ssize() > 0)
+            wire_tile_vecidx.at(i) = n_wires;
+        if (loc.pip_data.ssize() > 0)
+            pip_tile_vecidx.at(i) = n_pips;
+        n_wires += loc.wire_data.ssize();
+        n_pips += loc.pip_data.ssize();
     }
     wire2net.resize(n_wires, nullptr);
     wire_fanout.resize(n_wires, 0);
-
-    pip_tile_vecidx.resize(chip_info->num_tiles, -1);
-    int n_pips = 0;
-    for (auto e : getPips()) {
-        if (e.index == 0) {
-            pip_tile_vecidx.at(e.location.y * chip_info->width + e.location.x) = n_pips;
-        }
-        n_pips++;
-    }
     pip2net.resize(n_pips, nullptr);
 
     lutperm_allowed.resize(chip_info->width * chip_info->height * 4);
+
+    auto setup_end = std::chrono::high_resolution_clock::now();
+    auto secs = [](auto start, auto end) { return std::chrono::duration<float>(end - start).count(); };
+    log_info("Set up %s in %.02fs (chipdb %.02fs, cell types %.02fs, routing index %.02fs)\n", getChipName().c_str(),
+             secs(setup_start, setup_end), secs(setup_start, chipdb_end), secs(chipdb_end, cell_types_end),
+             secs(cell_types_end, setup_end));
 }
 
 // -----------------------------------------------------------------------
@@ -247,14 +240,18 @@ BelId Arch::getBelByName(IdStringList name) const
     loc.x = id_to_x.at(name[0]);
     loc.y = id_to_y.at(name[1]);
     ret.location = loc;
-    const LocationTypePOD *loci = loc_info(ret);
-    for (int i = 0; i < loci->bel_data.ssize(); i++) {
-        if (std::strcmp(loci->bel_data[i].name.get(), name[2].c_str(this)) == 0) {
-            ret.index = i;
-            return ret;
-        }
+    int loc_type = chip_info->location_type[tile_index(ret)];
+    auto &index = bel_index_by_name.at(loc_type);
+    if (index.empty()) {
+        const LocationTypePOD *loci = loc_info(ret);
+        for (int i = 0; i < loci->bel_data.ssize(); i++)
+            index[id(loci->bel_data[i].name.get())] = i;
     }
-    return BelId();
+    auto fnd = index.find(name[2]);
+    if (fnd == index.end())
+        return BelId();
+    ret.index = fnd->second;
+    return ret;
 }
 
 BelRange Arch::getBelsByTile(int x, int y) const
@@ -312,14 +309,18 @@ WireId Arch::getWireByName(IdStringList name) const
     loc.x = id_to_x.at(name[0]);
     loc.y = id_to_y.at(name[1]);
     ret.location = loc;
-    const LocationTypePOD *loci = loc_info(ret);
-    for (int i = 0; i < loci->wire_data.ssize(); i++) {
-        if (std::strcmp(loci->wire_data[i].name.get(), name[2].c_str(this)) == 0) {
-            ret.index = i;
-            return ret;
-        }
+    int loc_type = chip_info->location_type[tile_index(ret)];
+    auto &index = wire_index_by_name.at(loc_type);
+    if (index.empty()) {
+        const LocationTypePOD *loci = loc_info(ret);
+        for (int i = 0; i < loci->wire_data.ssize(); i++)
+            index[id(loci->wire_data[i].name.get())] = i;
     }
-    return WireId();
+    auto fnd = index.find(name[2]);
+    if (fnd == index.end())
+        return WireId();
+    ret.index = fnd->second;
+    return ret;
 }
 
 // -----------------------------------------------------------------------
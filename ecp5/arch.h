@@ -451,6 +451,9 @@ struct Arch : BaseArch<ArchRanges>
     const SpeedGradePOD *speed_grade;
 
     mutable dict<IdStringList, PipId> pip_by_name;
+    // Per location type maps from bel and wire name to index, each built the first time a name in a location of that
+    // type is looked up (so lookups don't need a linear scan, and only the location types actually used are indexed)
+    mutable std::vector<dict<IdString, int>> bel_index_by_name, wire_index_by_name;
 
     enum class LutPermRule
     {
@@ -486,6 +489,7 @@ struct Arch : BaseArch<ArchRanges>
         std::array<CellInfo *, 8 * (1 << lc_idx_shift)> cells;
     };
 
+    // Allocated on first bind (see bind_tile_status), as a small design on a large device only uses a few tiles
     struct TileStatus
     {
         std::vector<CellInfo *> boundcells;
@@ -566,8 +570,9 @@ struct Arch : BaseArch<ArchRanges>
     {
         CellInfo *act_cell = (old_cell == nullptr) ? new_cell : old_cell;
         if (act_cell->type.in(id_TRELLIS_FF, id_TRELLIS_COMB, id_TRELLIS_RAMW)) {
-            LogicTileStatus *lts = tile_status.at(tile_index(bel)).lts;
-            NPNR_ASSERT(lts != nullptr);
+            LogicTileStatus *&lts = tile_status.at(tile_index(bel)).lts;
+            if (lts == nullptr)
+                lts = new LogicTileStatus();
             int z = loc_info(bel)->bel_data[bel.index].z;
             lts->slices[(z >> lc_idx_shift) / 2].dirty = true;
             if (act_cell->type == id_TRELLIS_FF)
@@ -578,10 +583,24 @@ struct Arch : BaseArch<ArchRanges>
         }
     }
 
+    TileStatus &bind_tile_status(BelId bel)
+    {
+        auto &ts = tile_status.at(tile_index(bel));
+        if (ts.boundcells.empty())
+            ts.boundcells.resize(loc_info(bel)->bel_data.size(), nullptr);
+        return ts;
+    }
+
+    CellInfo *bound_cell(BelId bel) const
+    {
+        auto &ts = tile_status.at(tile_index(bel));
+        return ts.boundcells.empty() ? nullptr : ts.boundcells.at(bel.index);
+    }
+
     void bindBel(BelId bel, CellInfo *cell, PlaceStrength strength) override
     {
         NPNR_ASSERT(bel != BelId());
-        auto &slot = tile_status.at(tile_index(bel)).boundcells.at(bel.index);
+        auto &slot = bind_tile_status(bel).boundcells.at(bel.index);
         NPNR_ASSERT(slot == nullptr);
         slot = cell;
         cell->bel = bel;
@@ -601,7 +620,7 @@ struct Arch : BaseArch<ArchRanges>
     void unbindBel(BelId bel) override
     {
         NPNR_ASSERT(bel != BelId());
-        auto &slot = tile_status.at(tile_index(bel)).boundcells.at(bel.index);
+        auto &slot = bind_tile_status(bel).boundcells.at(bel.index);
         NPNR_ASSERT(slot != nullptr);
         update_bel(bel, slot, nullptr);
         slot->bel = BelId();
@@ -627,22 +646,19 @@ struct Arch : BaseArch<ArchRanges>
     bool checkBelAvail(BelId bel) const override
     {
         NPNR_ASSERT(bel != BelId());
-        const CellInfo *slot = tile_status.at(tile_index(bel)).boundcells.at(bel.index);
-        return slot == nullptr;
+        return bound_cell(bel) == nullptr;
     }
 
     CellInfo *getBoundBelCell(BelId bel) const override
     {
         NPNR_ASSERT(bel != BelId());
-        CellInfo *slot = tile_status.at(tile_index(bel)).boundcells.at(bel.index);
-        return slot;
+        return bound_cell(bel);
     }
 
     CellInfo *getConflictingBelCell(BelId bel) const override
     {
         NPNR_ASSERT(bel != BelId());
-        CellInfo *slot = tile_status.at(tile_index(bel)).boundcells.at(bel.index);
-        return slot;
+        return bound_cell(bel);
     }
 
     BelRange getBels() const override
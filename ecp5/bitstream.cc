@@ -27,6 +27,7 @@
 #include <streambuf>
 #include "config.h"
 #include "log.h"
+#include "parallel_chunks.h"
 #include "pio.h"
 #include "util.h"
 
@@ -446,35 +447,38 @@ struct ECP5Bitgen
         if (ctx->args.type == ArchArgs::LFE5U_12F || ctx->args.type == ArchArgs::LFE5U_25F ||
             ctx->args.type == ArchArgs::LFE5U_45F || ctx->args.type == ArchArgs::LFE5U_85F) {
             std::map<std::string, std::string> tiletype_xform;
-            for (const auto &tile : cc.tiles) {
-                std::string newname = tile.first;
-                auto cibdcu = tile.first.find("CIB_DCU");
+            for (int i = 0; i < cc.tiles.size(); i++) {
+                const std::string &name = cc.tiles.name(i);
+                std::string newname = name;
+                auto cibdcu = name.find("CIB_DCU");
                 if (cibdcu != std::string::npos) {
                     // Add the V
                     if (newname.at(cibdcu - 1) != 'V') {
                         newname.insert(cibdcu, 1, 'V');
-                        tiletype_xform[tile.first] = newname;
+                        tiletype_xform[name] = newname;
                     }
-                } else if (boost::ends_with(tile.first, "BMID_0H")) {
+                } else if (boost::ends_with(name, "BMID_0H")) {
                     newname.back() = 'V';
-                    tiletype_xform[tile.first] = newname;
-                } else if (boost::ends_with(tile.first, "BMID_2")) {
+                    tiletype_xform[name] = newname;
+                } else if (boost::ends_with(name, "BMID_2")) {
                     newname.push_back('V');
-                    tiletype_xform[tile.first] = newname;
+                    tiletype_xform[name] = newname;
                 }
             }
-            // Apply the name changes
+            // Apply the name changes, leaving the old tiles empty so they aren't written out
             for (auto xform : tiletype_xform) {
-                auto &existing = cc.tiles.at(xform.first);
+                int from = cc.tiles.index(xform.first), to = cc.tiles.index(xform.second);
+                auto &existing = cc.tiles.at(from);
+                auto &renamed = cc.tiles.at(to);
                 for (const auto &carc : existing.carcs)
-                    cc.tiles[xform.second].carcs.push_back(carc);
+                    renamed.carcs.push_back(carc);
                 for (const auto &cenum : existing.cenums)
-                    cc.tiles[xform.second].cenums.push_back(cenum);
+                    renamed.cenums.push_back(cenum);
                 for (const auto &cword : existing.cwords)
-                    cc.tiles[xform.second].cwords.push_back(cword);
+                    renamed.cwords.push_back(cword);
                 for (const auto &cunknown : existing.cunknowns)
-                    cc.tiles[xform.second].cunknowns.push_back(cunknown);
-                cc.tiles.erase(xform.first);
+                    renamed.cunknowns.push_back(cunknown);
+                existing = TileConfig();
             }
             for (auto &tg : cc.tilegroups) {
                 for (auto &t : tg.tiles) {
@@ -519,12 +523,74 @@ struct ECP5Bitgen
         }
     }
 
-    void set_pip(PipId pip)
+    // Add all set, configurable pips to the config. Scanning every pip of the device and building the arc names one
+    // at a time is slow on large parts, so instead the bound pips are collected from the nets, and the tile index and
+    // arc names of each pip are found in parallel. Arcs are then added in device pip order, so the output is the same
+    // as that of a scan over all pips.
+    void write_routing()
     {
-        std::string tile = ctx->get_pip_tilename(pip);
-        std::string source = get_trellis_wirename(pip.location, ctx->getPipSrcWire(pip));
-        std::string sink = get_trellis_wirename(pip.location, ctx->getPipDstWire(pip));
-        cc.tiles[tile].add_arc(sink, source);
+        // Tile indices of the tiles at each location, in the same order as in the chipdb
+        std::vector<std::vector<int>> tile_index(ctx->chip_info->width * ctx->chip_info->height);
+        for (int i = 0; i < int(tile_index.size()); i++)
+            for (auto &tn : ctx->chip_info->tile_info[i].tile_names)
+                tile_index.at(i).push_back(cc.tiles.index(tn.name.get()));
+
+        std::vector<NetInfo *> nets;
+        for (auto &net : ctx->nets)
+            nets.push_back(net.second.get());
+        // Each entry is the pip that fixes the position in device order, and the pip to set
+        auto collect_pips = [&](int begin, int end, std::vector<std::pair<PipId, PipId>> &pips) {
+            for (int i = begin; i < end; i++) {
+                for (auto &wire : nets.at(i)->wires) {
+                    PipId pip = wire.second.pip;
+                    if (pip == PipId() || ctx->get_pip_class(pip) != 0) // ignore fixed pips
+                        continue;
+                    WireId src = ctx->getPipSrcWire(pip);
+                    if (strstr(ctx->loc_info(src)->wire_data[src.index].name.get(), "CLKI_PLL") != nullptr) {
+                        // Special case - must set pip in all relevant tiles
+                        for (auto equiv_pip : ctx->getPipsUphill(ctx->getPipDstWire(pip))) {
+                            if (ctx->getPipSrcWire(equiv_pip) == src)
+                                pips.emplace_back(pip, equiv_pip);
+                        }
+                    } else {
+                        pips.emplace_back(pip, pip);
+                    }
+                }
+            }
+        };
+        auto chunk_pips =
+                parallel_chunks<std::vector<std::pair<PipId, PipId>>>(ctx, int(nets.size()), 1000, collect_pips);
+        std::vector<std::pair<PipId, PipId>> pips;
+        for (auto &chunk : chunk_pips)
+            pips.insert(pips.end(), chunk.begin(), chunk.end());
+        int width = ctx->chip_info->width;
+        std::stable_sort(pips.begin(), pips.end(), [&](const auto &a, const auto &b) {
+            int tile_a = a.first.location.y * width + a.first.location.x;
+            int tile_b = b.first.location.y * width + b.first.location.x;
+            return (tile_a < tile_b) || (tile_a == tile_b && a.first.index < b.first.index);
+        });
+
+        auto name_arcs = [&](int begin, int end, std::vector<std::pair<int, ConfigArc>> &arcs) {
+            for (int i = begin; i < end; i++) {
+                PipId pip = pips.at(i).second;
+                auto &tileloc = ctx->chip_info->tile_info[pip.location.y * width + pip.location.x];
+                int tile = -1;
+                for (int j = 0; j < int(tileloc.tile_names.size()); j++) {
+                    if (tileloc.tile_names[j].type_idx == ctx->loc_info(pip)->pip_data[pip.index].tile_type) {
+                        tile = tile_index.at(pip.location.y * width + pip.location.x).at(j);
+                        break;
+                    }
+                }
+                NPNR_ASSERT(tile != -1);
+                arcs.emplace_back(tile, ConfigArc{get_trellis_wirename(pip.location, ctx->getPipDstWire(pip)),
+                                                  get_trellis_wirename(pip.location, ctx->getPipSrcWire(pip))});
+            }
+        };
+        auto chunk_arcs =
+                parallel_chunks<std::vector<std::pair<int, ConfigArc>>>(ctx, int(pips.size()), 1000, name_arcs);
+        for (auto &chunk : chunk_arcs)
+            for (auto &arc : chunk)
+                cc.tiles.at(arc.first).carcs.push_back(std::move(arc.second));
     }
 
     unsigned permute_lut(CellInfo *cell, pool<IdString> &used_phys_pins, unsigned orig_init)
@@ -1417,32 +1483,16 @@ struct ECP5Bitgen
                 for (int i = 0; i < 12; i++) {
                     auto tiles = ctx->get_tiles_at_loc(loc.y - 1, loc.x + i);
                     for (const auto &tile : tiles) {
-                        auto cc_tile = cc.tiles.find(tile.first);
-                        if (cc_tile != cc.tiles.end()) {
-                            cc_tile->second.cenums.clear();
-                            cc_tile->second.cunknowns.clear();
+                        int cc_tile = cc.tiles.find(tile.first);
+                        if (cc_tile != -1) {
+                            cc.tiles.at(cc_tile).cenums.clear();
+                            cc.tiles.at(cc_tile).cunknowns.clear();
                         }
                     }
                 }
             }
         }
-        // Add all set, configurable pips to the config
-        for (auto pip : ctx->getPips()) {
-            if (ctx->getBoundPipNet(pip) != nullptr) {
-                if (ctx->get_pip_class(pip) == 0) { // ignore fixed pips
-                    std::string source = get_trellis_wirename(pip.location, ctx->getPipSrcWire(pip));
-                    if (source.find("CLKI_PLL") != std::string::npos) {
-                        // Special case - must set pip in all relevant tiles
-                        for (auto equiv_pip : ctx->getPipsUphill(ctx->getPipDstWire(pip))) {
-                            if (ctx->getPipSrcWire(equiv_pip) == ctx->getPipSrcWire(pip))
-                                set_pip(equiv_pip);
-                        }
-                    } else {
-                        set_pip(pip);
-                    }
-                }
-            }
-        }
+        write_routing();
 
         init_io_banks();
 
@@ -1592,7 +1642,8 @@ struct ECP5Bitgen
 };
 } // namespace
 
-void write_bitstream(Context *ctx, std::string base_config_file, std::string text_config_file)
+void write_bitstream(Context *ctx, std::string base_config_file, std::string text_config_file,
+                     std::string binary_config_file)
 {
     ECP5Bitgen bitgen(ctx);
     bitgen.run(base_config_file);
@@ -1602,6 +1653,12 @@ void write_bitstream(Context *ctx, std::string base_config_file, std::string tex
         std::ofstream out_config(text_config_file);
         out_config << bitgen.cc;
     }
+    if (!binary_config_file.empty()) {
+        std::ofstream out_config(binary_config_file, std::ios::binary);
+        if (!out_config)
+            log_error("failed to open binary config file '%s'\n", binary_config_file.c_str());
+        write_binary_config(out_config, bitgen.cc);
+    }
 }
 
 NEXTPNR_NAMESPACE_END
@@ -18,6 +18,7 @@
  */
 
 #include "config.h"
+#include <algorithm>
 #include <boost/range/adaptor/reversed.hpp>
 #include <iomanip>
 #include <set>
@@ -264,6 +265,31 @@ TileConfig TileConfig::from_string(const std::string &str)
 
 bool TileConfig::empty() const { return carcs.empty() && cwords.empty() && cenums.empty() && cunknowns.empty(); }
 
+int TileConfigs::index(const std::string &name)
+{
+    auto found = name_to_index.emplace(name, int(configs.size()));
+    if (found.second) {
+        names.push_back(name);
+        configs.emplace_back();
+    }
+    return found.first->second;
+}
+
+int TileConfigs::find(const std::string &name) const
+{
+    auto found = name_to_index.find(name);
+    return (found == name_to_index.end()) ? -1 : found->second;
+}
+
+std::vector<int> TileConfigs::sorted() const
+{
+    std::vector<int> order(configs.size());
+    for (int i = 0; i < int(order.size()); i++)
+        order.at(i) = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return names.at(a) < names.at(b); });
+    return order;
+}
+
 std::ostream &operator<<(std::ostream &out, const ChipConfig &cc)
 {
     out << ".device " << cc.chip_name << std::endl << std::endl;
@@ -272,10 +298,10 @@ std::ostream &operator<<(std::ostream &out, const ChipConfig &cc)
     for (const auto &sc : cc.sysconfig)
         out << ".sysconfig " << sc.first << " " << sc.second << std::endl;
     out << std::endl;
-    for (const auto &tile : cc.tiles) {
-        if (!tile.second.empty()) {
-            out << ".tile " << tile.first << std::endl;
-            out << tile.second;
+    for (int tile : cc.tiles.sorted()) {
+        if (!cc.tiles.at(tile).empty()) {
+            out << ".tile " << cc.tiles.name(tile) << std::endl;
+            out << cc.tiles.at(tile);
             out << std::endl;
         }
     }
@@ -324,7 +350,7 @@ std::istream &operator>>(std::istream &in, ChipConfig &cc)
             in >> tilename;
             TileConfig tc;
             in >> tc;
-            cc.tiles[tilename] = tc;
+            cc.tiles[tilename] = std::move(tc);
         } else if (verb == ".tile_group") {
             TileGroup tg;
             std::string line;
@@ -355,4 +381,111 @@ std::istream &operator>>(std::istream &in, ChipConfig &cc)
     return in;
 }
 
+/*
+The binary configuration has the same content as the textual one. All values are little-endian 32-bit words, and all
+names and string values are indices into a string table:
+
+  magic "E5CF", version
+  string table: count, then for each string its length and bytes (padded to a multiple of 4)
+  chip name, metadata (count, strings), sysconfig (count, key/value pairs)
+  tiles: count, then for each non-empty tile its name and tile config
+  bram init: count, then for each bram its index, the number of values and the values
+  tile groups: count, then for each group the number of tiles, the tile names and the tile config
+
+A tile config is the arcs (count, sink/source pairs), words (count, then name, number of bits and the bits packed
+into words, LSB first), enums (count, name/value pairs) and unknown bits (count, frame/bit pairs).
+*/
+void write_binary_config(std::ostream &out, const ChipConfig &cc)
+{
+    std::vector<uint32_t> body;
+    std::vector<const std::string *> strings;
+    std::unordered_map<std::string, uint32_t> string_index;
+    auto add_str = [&](const std::string &str) {
+        auto found = string_index.emplace(str, uint32_t(strings.size()));
+        if (found.second)
+            strings.push_back(&found.first->first);
+        body.push_back(found.first->second);
+    };
+    auto add_tile = [&](const TileConfig &tc) {
+        body.push_back(tc.carcs.size());
+        for (const auto &arc : tc.carcs) {
+            add_str(arc.sink);
+            add_str(arc.source);
+        }
+        body.push_back(tc.cwords.size());
+        for (const auto &cw : tc.cwords) {
+            add_str(cw.name);
+            body.push_back(cw.value.size());
+            for (size_t i = 0; i < cw.value.size(); i += 32) {
+                uint32_t bits = 0;
+                for (size_t j = i; j < std::min(i + 32, cw.value.size()); j++)
+                    if (cw.value.at(j))
+                        bits |= (1U << (j - i));
+                body.push_back(bits);
+            }
+        }
+        body.push_back(tc.cenums.size());
+        for (const auto &ce : tc.cenums) {
+            add_str(ce.name);
+            add_str(ce.value);
+        }
+        body.push_back(tc.cunknowns.size());
+        for (const auto &cu : tc.cunknowns) {
+            body.push_back(cu.frame);
+            body.push_back(cu.bit);
+        }
+    };
+
+    add_str(cc.chip_name);
+    body.push_back(cc.metadata.size());
+    for (const auto &meta : cc.metadata)
+        add_str(meta);
+    body.push_back(cc.sysconfig.size());
+    for (const auto &sc : cc.sysconfig) {
+        add_str(sc.first);
+        add_str(sc.second);
+    }
+    std::vector<int> tiles;
+    for (int tile : cc.tiles.sorted())
+        if (!cc.tiles.at(tile).empty())
+            tiles.push_back(tile);
+    body.push_back(tiles.size());
+    for (int tile : tiles) {
+        add_str(cc.tiles.name(tile));
+        add_tile(cc.tiles.at(tile));
+    }
+    body.push_back(cc.bram_data.size());
+    for (const auto &bram : cc.bram_data) {
+        body.push_back(bram.first);
+        body.push_back(bram.second.size());
+        body.insert(body.end(), bram.second.begin(), bram.second.end());
+    }
+    body.push_back(cc.tilegroups.size());
+    for (const auto &tg : cc.tilegroups) {
+        body.push_back(tg.tiles.size());
+        for (const auto &tile : tg.tiles)
+            add_str(tile);
+        add_tile(tg.config);
+    }
+
+    std::vector<uint32_t> header{0x46433545U /* E5CF */, 1, uint32_t(strings.size())};
+    for (auto str : strings) {
+        header.push_back(str->size());
+        for (size_t i = 0; i < str->size(); i += 4) {
+            uint32_t word = 0;
+            for (size_t j = i; j < std::min(i + 4, str->size()); j++)
+                word |= uint32_t(uint8_t(str->at(j))) << (8 * (j - i));
+            header.push_back(word);
+        }
+    }
+    auto write_words = [&](const std::vector<uint32_t> &words) {
+        for (uint32_t w : words) {
+            char bytes[4] = {char(w), char(w >> 8), char(w >> 16), char(w >> 24)};
+            out.write(bytes, 4);
+        }
+    };
+    write_words(header);
+    write_words(body);
+}
+
 NEXTPNR_NAMESPACE_END
@@ -21,6 +21,7 @@
 #define ECP5_CONFIG_H
 
 #include <map>
+#include <unordered_map>
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -106,13 +107,38 @@ struct TileGroup
     TileConfig config;
 };
 
+// The configuration of all tiles, stored by tile index. A tile gets an index the first time it is referred to by name;
+// code that sets a lot of configuration (such as routing) looks up the indices once and then uses them directly.
+class TileConfigs
+{
+  public:
+    // Index of the named tile, adding an empty config for it if it isn't known yet
+    int index(const std::string &name);
+    // Index of the named tile, or -1 if it isn't known
+    int find(const std::string &name) const;
+
+    TileConfig &operator[](const std::string &name) { return configs.at(index(name)); }
+    TileConfig &at(int index) { return configs.at(index); }
+    const TileConfig &at(int index) const { return configs.at(index); }
+    const std::string &name(int index) const { return names.at(index); }
+    int size() const { return int(configs.size()); }
+
+    // Tile indices sorted by tile name, the order tiles are written in
+    std::vector<int> sorted() const;
+
+  private:
+    std::vector<std::string> names;
+    std::vector<TileConfig> configs;
+    std::unordered_map<std::string, int> name_to_index;
+};
+
 // This represents the configuration of a chip at a high level
 class ChipConfig
 {
   public:
     std::string chip_name;
     std::vector<std::string> metadata;
-    std::map<std::string, TileConfig> tiles;
+    TileConfigs tiles;
     std::vector<TileGroup> tilegroups;
     std::map<std::string, std::string> sysconfig;
     std::map<uint16_t, std::vector<uint16_t>> bram_data;
@@ -122,6 +148,9 @@ std::ostream &operator<<(std::ostream &out, const ChipConfig &cc);
 
 std::istream &operator>>(std::istream &in, ChipConfig &cc);
 
+// Write the configuration in a compact binary form, with all names interned into a string table (see config.cc)
+void write_binary_config(std::ostream &out, const ChipConfig &cc);
+
 NEXTPNR_NAMESPACE_END
 
 #endif
@@ -78,6 +78,8 @@ po::options_description ECP5CommandHandler::getArchOptions()
     specific.add_options()("override-basecfg", po::value<std::string>(),
                            "base chip configuration in Trellis text format");
     specific.add_options()("textcfg", po::value<std::string>(), "textual configuration in Trellis format to write");
+    specific.add_options()("binarycfg", po::value<std::string>(),
+                           "configuration to write in a compact binary form with interned names");
 
     specific.add_options()("lpf", po::value<std::vector<std::string>>(), "LPF pin constraint file(s)");
     specific.add_options()("lpf-allow-unconstrained", "don't require LPF file(s) to constrain all IO");
@@ -107,13 +109,14 @@ void ECP5CommandHandler::customBitstream(Context *ctx)
         basecfg = vm["basecfg"].as<std::string>();
     }
 
-    if (bool_or_default(ctx->settings, ctx->id("arch.ooc")) && vm.count("textcfg"))
+    if (bool_or_default(ctx->settings, ctx->id("arch.ooc")) && (vm.count("textcfg") || vm.count("binarycfg")))
         log_error("bitstream generation is not available in out-of-context mode (use --write to create a post-PnR JSON "
                   "design)\n");
 
-    if (vm.count("textcfg")) {
-        std::string textcfg = vm["textcfg"].as<std::string>();
-        write_bitstream(ctx, basecfg, textcfg);
+    if (vm.count("textcfg") || vm.count("binarycfg")) {
+        std::string textcfg = vm.count("textcfg") ? vm["textcfg"].as<std::string>() : "";
+        std::string binarycfg = vm.count("binarycfg") ? vm["binarycfg"].as<std::string>() : "";
+        write_bitstream(ctx, basecfg, textcfg, binarycfg);
     }
 }
 
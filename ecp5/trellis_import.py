@@ -15,6 +15,7 @@ parser.add_argument("device", type=str, help="target device")
 parser.add_argument("-p", "--constids", type=str, help="path to constids.inc")
 parser.add_argument("-g", "--gfxh", type=str, help="path to gfx.h")
 parser.add_argument("-L", "--libdir", type=str, action="append", help="extra Python library path")
+parser.add_argument("--binary", action="store_true", help="write binary bbasm input instead of text")
 args = parser.parse_args()
 
 sys.path += args.libdir
@@ -172,19 +173,59 @@ constids = dict()
 
 
 class BinaryBlobAssembler:
+    def __init__(self, binary=False):
+        # In binary mode, write bbasm's compact binary input format (see bba/README.md) instead of text. Label names
+        # are declared once and then referred to by number; comments are dropped.
+        self.binary = binary
+        if binary:
+            self.out = sys.stdout.buffer
+            self.out.write(b"BBAB\x01")
+            self.symbols = dict()
+
+    def _varint(self, v):
+        v = int(v) & 0xffffffff
+        result = bytearray()
+        while v >= 0x80:
+            result.append((v & 0x7f) | 0x80)
+            v >>= 7
+        result.append(v)
+        return bytes(result)
+
+    def _str(self, s):
+        data = s.encode("utf-8")
+        return self._varint(len(data)) + data
+
+    def _sym(self, name):
+        if name not in self.symbols:
+            self.symbols[name] = len(self.symbols)
+            self.out.write(b"\x05" + self._str(name))
+        return self._varint(self.symbols[name])
+
     def l(self, name, ltype = None, export = False):
+        if self.binary:
+            sym = self._sym(name)
+            self.out.write(b"\x06" + sym)
+            return
         if ltype is None:
             print("label %s" % (name,))
         else:
             print("label %s %s" % (name, ltype))
 
     def r(self, name, comment):
+        if self.binary:
+            sym = self._sym(name)
+            self.out.write(b"\x07" + sym)
+            return
         if comment is None:
             print("ref %s" % (name,))
         else:
             print("ref %s %s" % (name, comment))
 
     def r_slice(self, name, length, comment):
+        if self.binary:
+            sym = self._sym(name)
+            self.out.write(b"\x07" + sym + b"\x0a" + self._varint(length))
+            return
         if comment is None:
             print("ref %s" % (name,))
         else:
@@ -193,10 +234,16 @@ class BinaryBlobAssembler:
 
     def s(self, s, comment):
         assert "|" not in s
+        if self.binary:
+            self.out.write(b"\x0b" + self._str(s))
+            return
         print("str |%s| %s" % (s, comment))
 
     def u8(self, v, comment):
         assert -128 <= int(v) <= 127
+        if self.binary:
+            self.out.write(b"\x08" + self._varint(v))
+            return
         if comment is None:
             print("u8 %d" % (v,))
         else:
@@ -205,27 +252,45 @@ class BinaryBlobAssembler:
     def u16(self, v, comment):
         # is actually used as signed 16 bit
         assert -32768 <= int(v) <= 32767
+        if self.binary:
+            self.out.write(b"\x09" + self._varint(v))
+            return
         if comment is None:
             print("u16 %d" % (v,))
         else:
             print("u16 %d %s" % (v, comment))
 
     def u32(self, v, comment):
+        if self.binary:
+            self.out.write(b"\x0a" + self._varint(v))
+            return
         if comment is None:
             print("u32 %d" % (v,))
         else:
             print("u32 %d %s" % (v, comment))
 
     def pre(self, s):
+        if self.binary:
+            self.out.write(b"\x01" + self._str(s))
+            return
         print("pre %s" % s)
 
     def post(self, s):
+        if self.binary:
+            self.out.write(b"\x02" + self._str(s))
+            return
         print("post %s" % s)
 
     def push(self, name):
+        if self.binary:
+            self.out.write(b"\x03" + self._str(name))
+            return
         print("push %s" % name)
 
     def pop(self):
+        if self.binary:
+            self.out.write(b"\x04")
+            return
         print("pop")
 
 def get_bel_index(ddrg, loc, name):
@@ -443,7 +508,7 @@ def get_pip_class(wire_from, wire_to):
 
 
 
-def write_database(dev_name, chip, ddrg, endianness):
+def write_database(dev_name, chip, ddrg, endianness, binary):
     def write_loc(loc, sym_name):
         bba.u16(loc.x, "%s.x" % sym_name)
         bba.u16(loc.y, "%s.y" % sym_name)
@@ -460,7 +525,7 @@ def write_database(dev_name, chip, ddrg, endianness):
         wire = ddrg.locationTypes[lt].wires[idx]
         return "R{}C{}_{}".format(loc[1] + rel.y, loc[0] + rel.x, ddrg.to_str(wire.name))
 
-    bba = BinaryBlobAssembler()
+    bba = BinaryBlobAssembler(binary)
     bba.pre('#include "nextpnr.h"')
     bba.pre('#include "embed.h"')
     bba.pre('NEXTPNR_NAMESPACE_BEGIN')
@@ -693,7 +758,7 @@ def main():
     process_pio_db(ddrg, args.device)
     process_loc_globals(chip)
     # print("{} unique location types".format(len(ddrg.locationTypes)))
-    bba = write_database(args.device, chip, ddrg, "le")
+    bba = write_database(args.device, chip, ddrg, "le", args.binary)
 
 
 
@@ -31,6 +31,7 @@
 #include <set>
 
 #include "constraints.impl.h"
+#include "embed.h"
 #include "fpga_interchange.h"
 #include "log.h"
 #include "nextpnr.h"
@@ -47,7 +48,6 @@
 #include <tcl.h>
 
 // #define DEBUG_BINDING
-// #define USE_LOOKAHEAD
 // #define DEBUG_CELL_PIN_MAPPING
 
 // Define to enable some idempotent sanity checks for some important
@@ -104,13 +104,14 @@ Arch::Arch(ArchArgs args) : args(args), disallow_site_routing(false)
         blob_file.open(args.chipdb);
         if (args.chipdb.empty() || !blob_file.is_open())
             log_error("Unable to read chipdb %s\n", args.chipdb.c_str());
-        const char *blob = reinterpret_cast<const char *>(blob_file.data());
-
-        chipdb_hash = sha1_hash(blob, blob_file.size());
-        chip_info = get_chip_info(reinterpret_cast<const RelPtr<ChipInfoPOD> *>(blob));
+        chipdb_hash = sha1_hash(blob_file.data(), blob_file.size());
     } catch (...) {
         log_error("Unable to read chipdb %s\n", args.chipdb.c_str());
     }
+    // Outside of the try block, so that header errors (such as a version mismatch) are reported as they are. The whole
+    // file has already been read for the hash above, so the checksum is always verified
+    const void *blob = get_chipdb_data(blob_file.data(), blob_file.size(), args.chipdb, true);
+    chip_info = get_chip_info(reinterpret_cast<const RelPtr<ChipInfoPOD> *>(blob));
 
     if (chip_info->version != kExpectedChipInfoVersion) {
         log_error("Expected chipdb with version %d found version %d\n", kExpectedChipInfoVersion, chip_info->version);
@@ -249,6 +250,11 @@ Arch::Arch(ArchArgs args) : args(args), disallow_site_routing(false)
                 lut.low_bit = lut_bel.low_bit;
                 lut.high_bit = lut_bel.high_bit;
 
+                // LUT equations are handled as 64-bit words (see LutEquation)
+                if (lut_bel.pins.size() > 6 || lut_bel.high_bit >= 64) {
+                    log_error("LUT BEL %s is wider than 64 bits, which is not supported\n", name.c_str(this));
+                }
+
                 lut.pins.reserve(lut_bel.pins.size());
                 for (size_t i = 0; i < lut_bel.pins.size(); ++i) {
                     IdString pin(lut_bel.pins[i]);
@@ -293,12 +299,19 @@ Arch::Arch(ArchArgs args) : args(args), disallow_site_routing(false)
 
 void Arch::init()
 {
-#ifdef USE_LOOKAHEAD
-    lookahead.init(getCtx(), getCtx());
-#endif
+    if (!args.disable_lookahead) {
+        lookahead.init(getCtx(), getCtx());
+    }
     dedicated_interconnect.init(getCtx());
     cell_parameters.init(getCtx());
 
+    size_t site_cache_bytes = size_t(args.site_cache_mb) * 1024 * 1024;
+    site_routing_cache.set_max_bytes(site_cache_bytes);
+    site_lut_mapping_cache.setMaxBytes(site_cache_bytes);
+    if (!args.site_cache.empty()) {
+        read_site_cache(args.site_cache);
+    }
+
     for (size_t tile_type = 0; tile_type < chip_info->tile_types.size(); ++tile_type) {
         pseudo_pip_data.init_tile_type(getCtx(), tile_type);
     }
@@ -791,6 +804,22 @@ static void prepare_for_placement(Context *ctx)
     }
 }
 
+static void log_cache_stats(const char *name, const CacheStats &stats)
+{
+    const size_t MB = 1024 * 1024;
+    log_info("%s cache stats:\n", name);
+    log_info("    miss ratio: %.1f%% (%zu hits, %zu misses)\n", stats.miss_ratio() * 100.0f, stats.hits, stats.misses);
+    log_info("    size      : %zuMB (%zu items, %zu evicted)\n", (stats.bytes + MB - 1) / MB, stats.count,
+             stats.evictions);
+}
+
+static void log_site_router_stats(SiteRouterStats &stats)
+{
+    log_info("Site router: routed %zu sites in %.02fs (%zu incremental, %zu fell back to a full route)\n",
+             size_t(stats.routes), stats.time_us / 1e6, size_t(stats.incremental), size_t(stats.fallbacks));
+    stats.clear();
+}
+
 bool Arch::place()
 {
     // Before placement, ripup placement specific bindings and unmask all cell
@@ -830,12 +859,17 @@ bool Arch::place()
     getCtx()->attrs[getCtx()->id("step")] = std::string("place");
     archInfoToAttributes();
 
-    // Print site LUT mapping caching stats
+    // Print site caching stats
+    log_site_router_stats(site_router_stats);
+    log_cache_stats("Site routing", site_routing_cache.stats());
     if (!getCtx()->arch_args.disable_lut_mapping_cache) {
-        log_info("Site LUT mapping cache stats:\n");
-        log_info("    miss ratio: %.1f%%\n", getCtx()->site_lut_mapping_cache.getMissRatio() * 100.0f);
-        log_info("    peak size : %zuMB (%zu items)\n", getCtx()->site_lut_mapping_cache.getSizeMB(),
-                 getCtx()->site_lut_mapping_cache.getCount());
+        log_cache_stats("Site LUT mapping", site_lut_mapping_cache.getStats());
+    }
+
+    // Save the caches now, as prepare_sites_for_routing clears them before
+    // routing adds its extra constraints.
+    if (!args.site_cache.empty()) {
+        write_site_cache(args.site_cache);
     }
 
     getCtx()->check();
@@ -878,6 +912,7 @@ static void prepare_sites_for_routing(Context *ctx)
 
         tile_pair.second.pseudo_pip_model.prepare_for_routing(ctx, tile_pair.second.sites);
     }
+    log_site_router_stats(ctx->site_router_stats);
 
     // Fixup LUT vcc pins.
     IdString vcc_net_name(ctx->chip_info->constants->vcc_net_name);
@@ -1028,11 +1063,12 @@ DecalXY Arch::getGroupDecal(GroupId pip) const { return {}; };
 
 delay_t Arch::estimateDelay(WireId src, WireId dst) const
 {
-#ifdef USE_LOOKAHEAD
-    return lookahead.estimateDelay(getCtx(), src, dst);
-#else
-    // Note: Something is better than nothing when USE_LOOKAHEAD is not
-    // defined.
+    if (!args.disable_lookahead) {
+        return lookahead.estimateDelay(getCtx(), src, dst);
+    }
+
+    // Note: Something is better than nothing when the lookahead is
+    // disabled.
     int src_tile = src.tile == -1 ? chip_info->nodes[src.index].tile_wires[0].tile : src.tile;
     int dst_tile = dst.tile == -1 ? chip_info->nodes[dst.index].tile_wires[0].tile : dst.tile;
 
@@ -1047,7 +1083,6 @@ delay_t Arch::estimateDelay(WireId src, WireId dst) const
 
     base = (base * 3) / 2;
     return base;
-#endif
 }
 
 delay_t Arch::predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const
@@ -51,7 +51,14 @@ struct ArchArgs
     std::string package;
     bool rebuild_lookahead;
     bool dont_write_lookahead;
+    bool disable_lookahead;
+    // Memory limit of each of the site routing and LUT mapping caches
+    int site_cache_mb = 512;
+    // File the site routing and LUT mapping caches are loaded from and saved to
+    std::string site_cache;
     bool disable_lut_mapping_cache;
+    // Keep the previous routes of a site when re-checking it
+    bool incremental_site_routing = false;
 };
 
 struct ArchRanges
@@ -1157,12 +1164,18 @@ struct Arch : ArchAPI<ArchRanges>
     mutable RouteNodeStorage node_storage;
     mutable SiteRoutingCache site_routing_cache;
     mutable SiteLutMappingCache site_lut_mapping_cache;
+    mutable SiteRouterStats site_router_stats;
     bool disallow_site_routing;
     CellParameters cell_parameters;
 
     std::string chipdb_hash;
     std::string get_chipdb_hash() const;
 
+    // Loads and saves the site routing and LUT mapping caches, so that they
+    // can be reused by later runs on the same chipdb (see --site-cache).
+    bool read_site_cache(const std::string &filename);
+    void write_site_cache(const std::string &filename) const;
+
     // Masking moves BEL pins from cell_bel_pins to masked_cell_bel_pins for
     // the purposes routing.  The idea is that masked BEL pins are already
     // handled during site routing, and they shouldn't be visible to the
@@ -0,0 +1,390 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <capnp/message.h>
+#include <capnp/serialize.h>
+#include <fstream>
+
+#include "context.h"
+#include "log.h"
+#include "nextpnr.h"
+#include "site_cache.capnp.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// Site routing and LUT mapping solutions only depend on the chipdb and on the
+// tile-relative state of a site, so they can be reused by later runs on the
+// same device. The in-memory caches already store tile-relative solutions
+// (they are relocated when read back), so entries are saved as they are, with
+// IdStrings replaced by indices into a string table.
+
+// Bump this when the meaning of the stored data changes.
+static constexpr uint32_t kSiteCacheVersion = 1;
+
+namespace {
+
+struct StringTable
+{
+    dict<IdString, uint32_t> index;
+    std::vector<IdString> strings;
+
+    uint32_t get(IdString str)
+    {
+        auto result = index.emplace(str, strings.size());
+        if (result.second) {
+            strings.push_back(str);
+        }
+        return result.first->second;
+    }
+};
+
+void write_site_routing(const SiteRoutingKey &key, const SiteRoutingSolution &solution,
+                        site_cache_storage::SiteRoutingEntry::Builder entry)
+{
+    entry.setTileType(key.tile_type);
+    entry.setSite(key.site);
+    entry.setNetType(uint16_t(key.net_type));
+    entry.setDriverType(key.driver_type);
+    entry.setDriverIndex(key.driver_index);
+
+    auto user_types = entry.initUserTypes(key.user_types.size());
+    for (size_t i = 0; i < key.user_types.size(); ++i) {
+        user_types.set(i, key.user_types[i]);
+    }
+    auto user_indicies = entry.initUserIndicies(key.user_indicies.size());
+    for (size_t i = 0; i < key.user_indicies.size(); ++i) {
+        user_indicies.set(i, key.user_indicies[i]);
+    }
+
+    auto offsets = entry.initSolutionOffsets(solution.solution_offsets.size());
+    for (size_t i = 0; i < solution.solution_offsets.size(); ++i) {
+        offsets.set(i, solution.solution_offsets[i]);
+    }
+
+    auto pips = entry.initSolutionPips(solution.solution_storage.size());
+    for (size_t i = 0; i < solution.solution_storage.size(); ++i) {
+        const SitePip &pip = solution.solution_storage[i];
+        auto out = pips[i];
+        out.setType(pip.type);
+        out.setPip(pip.pip.index);
+        out.setWireType(pip.wire.type);
+        out.setOtherPip(pip.other_pip.index);
+    }
+
+    auto sinks = entry.initSolutionSinks(solution.solution_sinks.size());
+    for (size_t i = 0; i < solution.solution_sinks.size(); ++i) {
+        const SiteWire &wire = solution.solution_sinks[i];
+        auto out = sinks[i];
+        out.setType(wire.type);
+        out.setWire(wire.wire.index);
+        out.setPip(wire.pip.index);
+    }
+
+    auto inverted = entry.initInverted(solution.inverted.size());
+    for (size_t i = 0; i < solution.inverted.size(); ++i) {
+        inverted.set(i, solution.inverted[i] != 0);
+    }
+    auto can_invert = entry.initCanInvert(solution.can_invert.size());
+    for (size_t i = 0; i < solution.can_invert.size(); ++i) {
+        can_invert.set(i, solution.can_invert[i] != 0);
+    }
+}
+
+void read_site_routing(site_cache_storage::SiteRoutingEntry::Reader entry, SiteRoutingKey *key,
+                       SiteRoutingSolution *solution)
+{
+    key->tile_type = entry.getTileType();
+    key->site = entry.getSite();
+    key->net_type = PhysicalNetlist::PhysNetlist::NetType(entry.getNetType());
+    key->driver_type = SiteWire::Type(entry.getDriverType());
+    key->driver_index = entry.getDriverIndex();
+
+    auto user_types = entry.getUserTypes();
+    key->user_types.reserve(user_types.size());
+    for (uint8_t type : user_types) {
+        key->user_types.push_back(SiteWire::Type(type));
+    }
+    auto user_indicies = entry.getUserIndicies();
+    key->user_indicies.assign(user_indicies.begin(), user_indicies.end());
+
+    auto offsets = entry.getSolutionOffsets();
+    solution->solution_offsets.assign(offsets.begin(), offsets.end());
+
+    auto pips = entry.getSolutionPips();
+    solution->solution_storage.reserve(pips.size());
+    for (auto pip : pips) {
+        SitePip out;
+        out.type = SitePip::Type(pip.getType());
+        out.pip.index = pip.getPip();
+        out.wire.type = SiteWire::Type(pip.getWireType());
+        out.other_pip.index = pip.getOtherPip();
+        solution->solution_storage.push_back(out);
+    }
+
+    auto sinks = entry.getSolutionSinks();
+    solution->solution_sinks.reserve(sinks.size());
+    for (auto sink : sinks) {
+        SiteWire out;
+        out.type = SiteWire::Type(sink.getType());
+        out.wire.index = sink.getWire();
+        out.pip.index = sink.getPip();
+        solution->solution_sinks.push_back(out);
+    }
+
+    auto inverted = entry.getInverted();
+    solution->inverted.assign(inverted.begin(), inverted.end());
+    auto can_invert = entry.getCanInvert();
+    solution->can_invert.assign(can_invert.begin(), can_invert.end());
+}
+
+void write_lut_mapping(StringTable &strings, const SiteLutMappingKey &key, const SiteLutMappingResult &result,
+                       site_cache_storage::LutMappingEntry::Builder entry)
+{
+    entry.setTileType(key.tileType);
+    entry.setSiteType(key.siteType);
+
+    auto cells = entry.initCells(key.numCells);
+    for (size_t i = 0; i < key.numCells; ++i) {
+        const auto &cell = key.cells[i];
+        auto out = cells[i];
+        out.setType(strings.get(cell.type));
+        out.setBelIndex(cell.belIndex);
+        auto conns = out.initConns(cell.conns.size());
+        for (size_t j = 0; j < cell.conns.size(); ++j) {
+            conns.set(j, cell.conns[j]);
+        }
+    }
+
+    entry.setIsValid(result.isValid);
+
+    // Only the parts of the result that SiteLutMappingResult::apply uses
+    // are stored.
+    auto results = entry.initResults(result.cells.size());
+    for (size_t i = 0; i < result.cells.size(); ++i) {
+        const auto &cell = result.cells[i];
+        auto out = results[i];
+        out.setBelIndex(cell.belIndex);
+
+        auto bel_pins = out.initBelPins(cell.belPins.size());
+        size_t j = 0;
+        for (const auto &pin_pair : cell.belPins) {
+            bel_pins[j].setFirst(strings.get(pin_pair.first));
+            bel_pins[j].setSecond(strings.get(pin_pair.second));
+            ++j;
+        }
+
+        auto pin_connections = out.initPinConnections(cell.lutCell.pin_connections.size());
+        j = 0;
+        for (const auto &conn : cell.lutCell.pin_connections) {
+            pin_connections[j].setPin(strings.get(conn.first));
+            pin_connections[j].setConnection(uint8_t(conn.second));
+            ++j;
+        }
+    }
+
+    auto blocked_wires = entry.initBlockedWires(result.blockedWires.size());
+    size_t i = 0;
+    for (const auto &wire : result.blockedWires) {
+        blocked_wires[i].setFirst(strings.get(wire.first));
+        blocked_wires[i].setSecond(strings.get(wire.second));
+        ++i;
+    }
+}
+
+void read_lut_mapping(const std::vector<IdString> &strings, site_cache_storage::LutMappingEntry::Reader entry,
+                      SiteLutMappingKey *key, SiteLutMappingResult *result)
+{
+    key->tileType = entry.getTileType();
+    key->siteType = entry.getSiteType();
+
+    auto cells = entry.getCells();
+    key->numCells = cells.size();
+    key->cells.resize(cells.size());
+    for (size_t i = 0; i < cells.size(); ++i) {
+        auto &cell = key->cells[i];
+        cell.type = strings.at(cells[i].getType());
+        cell.belIndex = cells[i].getBelIndex();
+        auto conns = cells[i].getConns();
+        cell.conns.assign(conns.begin(), conns.end());
+    }
+    // Cell types are IdStrings, so the hash is not the same as in the run
+    // that saved the entry.
+    key->computeHash();
+
+    result->isValid = entry.getIsValid();
+
+    auto results = entry.getResults();
+    result->cells.resize(results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto &cell = result->cells[i];
+        cell.belIndex = results[i].getBelIndex();
+        for (auto pin_pair : results[i].getBelPins()) {
+            cell.belPins[strings.at(pin_pair.getFirst())] = strings.at(pin_pair.getSecond());
+        }
+        for (auto conn : results[i].getPinConnections()) {
+            cell.lutCell.pin_connections[strings.at(conn.getPin())] = LutCell::PinConnection(conn.getConnection());
+        }
+    }
+
+    for (auto wire : entry.getBlockedWires()) {
+        result->blockedWires.emplace(strings.at(wire.getFirst()), strings.at(wire.getSecond()));
+    }
+}
+
+bool load_site_cache(Arch *arch, const std::string &filename, site_cache_storage::SiteCache::Reader cache)
+{
+    if (cache.getVersion() != kSiteCacheVersion) {
+        log_warning("Site cache '%s' has version %u, expected %u, ignoring it.\n", filename.c_str(),
+                    cache.getVersion(), kSiteCacheVersion);
+        return false;
+    }
+    if (std::string(cache.getChipdbHash().cStr()) != arch->get_chipdb_hash()) {
+        log_warning("Site cache '%s' was saved for a different chipdb, ignoring it.\n", filename.c_str());
+        return false;
+    }
+
+    std::vector<IdString> strings;
+    strings.reserve(cache.getStrList().size());
+    for (auto str : cache.getStrList()) {
+        strings.push_back(arch->id(str.cStr()));
+    }
+
+    for (auto entry : cache.getSiteRouting()) {
+        SiteRoutingKey key;
+        SiteRoutingSolution solution;
+        read_site_routing(entry, &key, &solution);
+        arch->site_routing_cache.add_solutions(key, solution);
+    }
+
+    if (!arch->args.disable_lut_mapping_cache) {
+        for (auto entry : cache.getLutMapping()) {
+            SiteLutMappingKey key;
+            SiteLutMappingResult result;
+            read_lut_mapping(strings, entry, &key, &result);
+            arch->site_lut_mapping_cache.add(key, result);
+        }
+    }
+
+    log_info("Loaded %zu site routing and %zu LUT mapping solutions from '%s'\n",
+             arch->site_routing_cache.stats().count, arch->site_lut_mapping_cache.getStats().count, filename.c_str());
+    return true;
+}
+
+} // namespace
+
+bool Arch::read_site_cache(const std::string &filename)
+{
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename.c_str());
+    } catch (std::ios_base::failure &fail) {
+        return false;
+    }
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    capnp::ReaderOptions reader_options;
+    reader_options.traversalLimitInWords = 32llu * 1024llu * 1024llu * 1024llu;
+
+    const kj::ArrayPtr<const ::capnp::word> words = kj::arrayPtr(
+            reinterpret_cast<const ::capnp::word *>(file.data()), file.size() / sizeof(::capnp::word));
+    try {
+        ::capnp::FlatArrayMessageReader reader(words, reader_options);
+        return load_site_cache(this, filename, reader.getRoot<site_cache_storage::SiteCache>());
+    } catch (kj::Exception &e) {
+        log_warning("Failed to read site cache '%s': %s\n", filename.c_str(), e.getDescription().cStr());
+        return false;
+    }
+}
+
+void Arch::write_site_cache(const std::string &filename) const
+{
+    // The entries are referenced in place, so the caches must not be in use
+    // by the site router while they are written.
+    std::vector<std::pair<const SiteRoutingKey *, const SiteRoutingSolution *>> routing;
+    site_routing_cache.for_each([&](const SiteRoutingKey &key, const SiteRoutingSolution &solution) {
+        routing.emplace_back(&key, &solution);
+    });
+
+    std::vector<std::pair<const SiteLutMappingKey *, const SiteLutMappingResult *>> lut_mapping;
+    if (!args.disable_lut_mapping_cache) {
+        site_lut_mapping_cache.forEach([&](const SiteLutMappingKey &key, const SiteLutMappingResult &result) {
+            lut_mapping.emplace_back(&key, &result);
+        });
+    }
+
+    ::capnp::MallocMessageBuilder message;
+    site_cache_storage::SiteCache::Builder cache = message.initRoot<site_cache_storage::SiteCache>();
+    cache.setChipdbHash(get_chipdb_hash());
+    cache.setVersion(kSiteCacheVersion);
+
+    auto routing_entries = cache.initSiteRouting(routing.size());
+    for (size_t i = 0; i < routing.size(); ++i) {
+        write_site_routing(*routing[i].first, *routing[i].second, routing_entries[i]);
+    }
+
+    StringTable strings;
+    auto lut_entries = cache.initLutMapping(lut_mapping.size());
+    for (size_t i = 0; i < lut_mapping.size(); ++i) {
+        write_lut_mapping(strings, *lut_mapping[i].first, *lut_mapping[i].second, lut_entries[i]);
+    }
+
+    auto str_list = cache.initStrList(strings.strings.size());
+    for (size_t i = 0; i < strings.strings.size(); ++i) {
+        str_list.set(i, strings.strings[i].c_str(getCtx()));
+    }
+
+    // Write to a temporary file first, so that an interrupted run never
+    // leaves a truncated cache behind.
+    kj::Array<capnp::word> words = messageToFlatArray(message);
+    kj::ArrayPtr<kj::byte> bytes = words.asBytes();
+    boost::filesystem::path temp;
+    std::string error;
+    try {
+        temp = boost::filesystem::unique_path(filename + ".%%%%-%%%%");
+        std::ofstream out(temp.string(), std::ios::binary);
+        out.write(reinterpret_cast<const char *>(bytes.begin()), bytes.size());
+        out.close();
+        if (!out) {
+            error = "failed to write tempfile";
+        } else {
+            boost::filesystem::rename(temp, filename);
+        }
+    } catch (const boost::filesystem::filesystem_error &e) {
+        error = e.what();
+    }
+
+    if (!error.empty()) {
+        // The cache is only an optimisation, so never fail the run over it.
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp, ec);
+        log_warning("Failed to write site cache to %s (%s).\n", filename.c_str(), error.c_str());
+        return;
+    }
+
+    log_info("Saved %zu site routing and %zu LUT mapping solutions to '%s'\n", routing.size(), lut_mapping.size(),
+             filename.c_str());
+}
+
+NEXTPNR_NAMESPACE_END
@@ -22,6 +22,7 @@
 
 #include "context.h"
 #include "log.h"
+#include "parallel_chunks.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -106,8 +107,7 @@ delay_t CostMap::get_delay(const Context *ctx, WireId src_wire, WireId dst_wire)
     int32_t closest_y = std::min(std::max(off_y, 0), y_dim - 1);
 
     // Get the cost entry from the cost map at the deltas values
-    auto cost = delay_matrix.data[closest_x][closest_y];
-    NPNR_ASSERT(cost >= 0);
+    delay_t cost = delay_t(delay_matrix.data[closest_x][closest_y]) * delay_matrix.scale;
 
     // Get the base penalty corresponding to the current segment.
     auto penalty = delay_matrix.penalty;
@@ -120,12 +120,9 @@ delay_t CostMap::get_delay(const Context *ctx, WireId src_wire, WireId dst_wire)
     return penalize(cost, distance, penalty);
 }
 
-void CostMap::set_cost_map(const Context *ctx, const TypeWirePair &wire_pair,
-                           const dict<std::pair<int32_t, int32_t>, delay_t> &delays)
+bool CostMap::build_entry(const DeltaDelays &delays, CostMapEntry *entry) const
 {
-    CostMapEntry delay_matrix;
-
-    auto &offset = delay_matrix.offset;
+    auto &offset = entry->offset;
     offset.first = 0;
     offset.second = 0;
 
@@ -143,11 +140,11 @@ void CostMap::set_cost_map(const Context *ctx, const TypeWirePair &wire_pair,
     int32_t x_dim = offset.first + max_x_offset + 1;
     int32_t y_dim = offset.second + max_y_offset + 1;
 
-    delay_matrix.data.resize(boost::extents[x_dim][y_dim]);
+    boost::multi_array<delay_t, 2> matrix(boost::extents[x_dim][y_dim]);
 
     // Fill matrix with sentinel of -1 to know where the holes in the matrix
     // are.
-    std::fill_n(delay_matrix.data.data(), delay_matrix.data.num_elements(), -1);
+    std::fill_n(matrix.data(), matrix.num_elements(), -1);
 
     for (const auto &delay_pair : delays) {
         auto &dx_dy = delay_pair.first;
@@ -158,20 +155,93 @@ void CostMap::set_cost_map(const Context *ctx, const TypeWirePair &wire_pair,
         NPNR_ASSERT(off_y >= 0);
         NPNR_ASSERT(off_y < y_dim);
 
-        delay_matrix.data[off_x][off_y] = delay_pair.second;
+        matrix[off_x][off_y] = delay_pair.second;
+    }
+
+    entry->penalty = get_penalty(matrix);
+    if (!fill_holes(matrix, entry->penalty)) {
+        return false;
     }
 
-    delay_matrix.penalty = get_penalty(delay_matrix.data);
-    fill_holes(ctx, wire_pair, delay_matrix.data, delay_matrix.penalty);
+    entry->data.resize(boost::extents[x_dim][y_dim]);
+    quantise(matrix.data(), matrix.num_elements(), entry);
+    return true;
+}
 
+void CostMap::quantise(const delay_t *costs, size_t count, CostMapEntry *entry)
+{
+    NPNR_ASSERT(entry->data.num_elements() == count);
+    delay_t max_cost = 0;
+    for (size_t i = 0; i < count; ++i) {
+        NPNR_ASSERT(costs[i] >= 0);
+        max_cost = std::max(max_cost, costs[i]);
+    }
+
+    // Round down, so that the lookahead never gets more pessimistic
+    const delay_t kMaxQuantised = std::numeric_limits<uint16_t>::max();
+    entry->scale = std::max<delay_t>(1, (max_cost + kMaxQuantised - 1) / kMaxQuantised);
+    uint16_t *out = entry->data.data();
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = costs[i] / entry->scale;
+    }
+}
+
+void CostMap::set_cost_maps(const Context *ctx, const dict<TypeWirePair, DeltaDelays> &delays)
+{
+    std::vector<const TypeWirePair *> wire_pairs;
+    std::vector<const DeltaDelays *> wire_pair_delays;
+    for (const auto &delay_pair : delays) {
+        wire_pairs.push_back(&delay_pair.first);
+        wire_pair_delays.push_back(&delay_pair.second);
+    }
+
+    struct EntryChunk
     {
-        cost_map_mutex_.lock();
-        auto result = cost_map_.emplace(wire_pair, delay_matrix);
-        NPNR_ASSERT(result.second);
-        cost_map_mutex_.unlock();
+        std::vector<CostMapEntry> entries;
+        std::vector<bool> filled;
+    };
+
+    auto chunks = parallel_chunks<EntryChunk>(ctx, wire_pairs.size(), 64, [&](int begin, int end, EntryChunk &chunk) {
+        chunk.entries.resize(end - begin);
+        chunk.filled.resize(end - begin);
+        for (int i = begin; i < end; ++i) {
+            chunk.filled.at(i - begin) = build_entry(*wire_pair_delays.at(i), &chunk.entries.at(i - begin));
+        }
+    });
+
+    cost_map_.reserve(cost_map_.size() + wire_pairs.size());
+    size_t index = 0;
+    for (auto &chunk : chunks) {
+        for (size_t i = 0; i < chunk.entries.size(); ++i) {
+            const TypeWirePair &type_pair = *wire_pairs.at(index++);
+            if (!chunk.filled.at(i)) {
+                auto &src_type_data = ctx->chip_info->tile_types[type_pair.src.type];
+                IdString src_type(src_type_data.name);
+                IdString src_wire(src_type_data.wire_data[type_pair.src.index].name);
+
+                auto &dst_type_data = ctx->chip_info->tile_types[type_pair.dst.type];
+                IdString dst_type(dst_type_data.name);
+                IdString dst_wire(dst_type_data.wire_data[type_pair.dst.index].name);
+
+                log_error("Couldn't fill holes in the cost matrix %s/%s -> %s/%s\n", src_type.c_str(ctx),
+                          src_wire.c_str(ctx), dst_type.c_str(ctx), dst_wire.c_str(ctx));
+            }
+
+            auto result = cost_map_.emplace(type_pair, std::move(chunk.entries.at(i)));
+            NPNR_ASSERT(result.second);
+        }
     }
 }
 
+size_t CostMap::memory_usage() const
+{
+    size_t usage = cost_map_.size() * sizeof(std::pair<TypeWirePair, CostMapEntry>);
+    for (const auto &entry : cost_map_) {
+        usage += entry.second.data.num_elements() * sizeof(uint16_t);
+    }
+    return usage;
+}
+
 static void assign_min_entry(delay_t *dst, const delay_t &src)
 {
     if (src >= 0) {
@@ -184,7 +254,7 @@ static void assign_min_entry(delay_t *dst, const delay_t &src)
 }
 
 std::pair<delay_t, int> CostMap::get_nearby_cost_entry(const boost::multi_array<delay_t, 2> &matrix, int cx, int cy,
-                                                       const BoundingBox &bounds)
+                                                       const BoundingBox &bounds) const
 {
 #ifdef DEBUG_FILL
     log_info("Filling %d, %d within (%d, %d, %d, %d)\n", cx, cy, bounds.x0, bounds.y0, bounds.x1, bounds.y1);
@@ -243,14 +313,11 @@ std::pair<delay_t, int> CostMap::get_nearby_cost_entry(const boost::multi_array<
     return std::make_pair(fill, n);
 }
 
-void CostMap::fill_holes(const Context *ctx, const TypeWirePair &type_pair, boost::multi_array<delay_t, 2> &matrix,
-                         delay_t delay_penalty)
+bool CostMap::fill_holes(boost::multi_array<delay_t, 2> &matrix, delay_t delay_penalty) const
 {
     // find missing cost entries and fill them in by copying a nearby cost entry
     std::vector<std::tuple<unsigned, unsigned, delay_t>> missing;
-    bool couldnt_fill = false;
     auto shifted_bounds = BoundingBox(0, 0, matrix.shape()[0] - 1, matrix.shape()[1] - 1);
-    int max_fill = 0;
     for (unsigned ix = 0; ix < matrix.shape()[0]; ix++) {
         for (unsigned iy = 0; iy < matrix.shape()[1]; iy++) {
             delay_t &cost_entry = matrix[ix][iy];
@@ -261,33 +328,12 @@ void CostMap::fill_holes(const Context *ctx, const TypeWirePair &type_pair, boos
                 std::tie(filler, distance) = get_nearby_cost_entry(matrix, ix, iy, shifted_bounds);
                 if (filler >= 0) {
                     missing.push_back(std::make_tuple(ix, iy, penalize(filler, distance, delay_penalty)));
-                    max_fill = std::max(max_fill, distance);
                 } else {
-                    couldnt_fill = true;
+                    // give up trying to fill an empty matrix
+                    return false;
                 }
             }
         }
-        if (couldnt_fill) {
-            // give up trying to fill an empty matrix
-            break;
-        }
-    }
-
-    if (!couldnt_fill && max_fill > 0) {
-        if (ctx->verbose) {
-            auto &src_type_data = ctx->chip_info->tile_types[type_pair.src.type];
-            IdString src_type(src_type_data.name);
-            IdString src_wire(src_type_data.wire_data[type_pair.src.index].name);
-
-            auto &dst_type_data = ctx->chip_info->tile_types[type_pair.dst.type];
-            IdString dst_type(dst_type_data.name);
-            IdString dst_wire(dst_type_data.wire_data[type_pair.dst.index].name);
-
-#ifdef DEBUG_FILL
-            log_info("At %s/%s -> %s/%s: max_fill = %d, delay_penalty = %d\n", src_type.c_str(ctx), src_wire.c_str(ctx),
-                     dst_type.c_str(ctx), dst_wire.c_str(ctx), max_fill, delay_penalty);
-#endif
-        }
     }
 
     // write back the missing entries
@@ -295,24 +341,7 @@ void CostMap::fill_holes(const Context *ctx, const TypeWirePair &type_pair, boos
         matrix[std::get<0>(xy_entry)][std::get<1>(xy_entry)] = std::get<2>(xy_entry);
     }
 
-    if (couldnt_fill) {
-        auto &src_type_data = ctx->chip_info->tile_types[type_pair.src.type];
-        IdString src_type(src_type_data.name);
-        IdString src_wire(src_type_data.wire_data[type_pair.src.index].name);
-
-        auto &dst_type_data = ctx->chip_info->tile_types[type_pair.dst.type];
-        IdString dst_type(dst_type_data.name);
-        IdString dst_wire(dst_type_data.wire_data[type_pair.dst.index].name);
-
-        log_warning("Couldn't fill holes in the cost matrix %s/%s -> %s/%s %d x %d bounding box\n", src_type.c_str(ctx),
-                    src_wire.c_str(ctx), dst_type.c_str(ctx), dst_wire.c_str(ctx), shifted_bounds.x1,
-                    shifted_bounds.y1);
-        for (unsigned y = 0; y < matrix.shape()[1]; y++) {
-            for (unsigned x = 0; x < matrix.shape()[0]; x++) {
-                NPNR_ASSERT(matrix[x][y] >= 0);
-            }
-        }
-    }
+    return true;
 }
 
 delay_t CostMap::get_penalty(const boost::multi_array<delay_t, 2> &matrix) const
@@ -352,17 +381,29 @@ void CostMap::from_reader(lookahead_storage::CostMap::Reader reader)
         NPNR_ASSERT(result.second);
 
         CostMapEntry &entry = result.first->second;
-        auto data = cost_entry.getData();
-        auto in_iter = data.begin();
-
         entry.data.resize(boost::extents[cost_entry.getXDim()][cost_entry.getYDim()]);
-        if (entry.data.num_elements() != data.size()) {
-            log_error("entry.data.num_elements() %zu != data.size() %u", entry.data.num_elements(), data.size());
-        }
 
-        delay_t *out = entry.data.origin();
-        for (; in_iter != data.end(); ++in_iter, ++out) {
-            *out = *in_iter;
+        auto quantised_data = cost_entry.getQuantisedData();
+        if (cost_entry.getScale() > 0) {
+            if (entry.data.num_elements() != quantised_data.size()) {
+                log_error("entry.data.num_elements() %zu != quantised_data.size() %u", entry.data.num_elements(),
+                          quantised_data.size());
+            }
+
+            uint16_t *out = entry.data.origin();
+            for (auto in_iter = quantised_data.begin(); in_iter != quantised_data.end(); ++in_iter, ++out) {
+                *out = *in_iter;
+            }
+            entry.scale = cost_entry.getScale();
+        } else {
+            // Lookahead written before costs were quantised
+            auto data = cost_entry.getData();
+            if (entry.data.num_elements() != data.size()) {
+                log_error("entry.data.num_elements() %zu != data.size() %u", entry.data.num_elements(), data.size());
+            }
+
+            std::vector<delay_t> costs(data.begin(), data.end());
+            quantise(costs.data(), costs.size(), &entry);
         }
 
         entry.penalty = cost_entry.getPenalty();
@@ -383,8 +424,8 @@ void CostMap::to_builder(lookahead_storage::CostMap::Builder builder) const
         in->first.to_builder(entry_iter->getKey());
         const CostMapEntry &entry = in->second;
 
-        auto data = entry_iter->initData(entry.data.num_elements());
-        const delay_t *data_in = entry.data.origin();
+        auto data = entry_iter->initQuantisedData(entry.data.num_elements());
+        const uint16_t *data_in = entry.data.origin();
         for (size_t i = 0; i < entry.data.num_elements(); ++i) {
             data.set(i, data_in[i]);
         }
@@ -394,6 +435,7 @@ void CostMap::to_builder(lookahead_storage::CostMap::Builder builder) const
         entry_iter->setXOffset(entry.offset.first);
         entry_iter->setYOffset(entry.offset.second);
         entry_iter->setPenalty(entry.penalty);
+        entry_iter->setScale(entry.scale);
     }
 }
 
@@ -22,7 +22,6 @@
 #define COST_MAP_H
 
 #include <boost/multi_array.hpp>
-#include <mutex>
 
 #include "lookahead.capnp.h"
 #include "nextpnr_namespaces.h"
@@ -36,30 +35,39 @@ struct Context;
 class CostMap
 {
   public:
+    // Delays sampled from one wire type to another, by dx/dy
+    using DeltaDelays = dict<std::pair<int32_t, int32_t>, delay_t>;
+
     delay_t get_delay(const Context *ctx, WireId src, WireId dst) const;
-    void set_cost_map(const Context *ctx, const TypeWirePair &wire_pair,
-                      const dict<std::pair<int32_t, int32_t>, delay_t> &delays);
+    // Build the cost maps of all wire type pairs, in parallel
+    void set_cost_maps(const Context *ctx, const dict<TypeWirePair, DeltaDelays> &delays);
 
     void from_reader(lookahead_storage::CostMap::Reader reader);
     void to_builder(lookahead_storage::CostMap::Builder builder) const;
 
+    size_t size() const { return cost_map_.size(); }
+    size_t memory_usage() const;
+
   private:
+    // Costs are quantised to 16 bits, the delay of each entry is data * scale.
     struct CostMapEntry
     {
-        boost::multi_array<delay_t, 2> data;
+        boost::multi_array<uint16_t, 2> data;
         std::pair<int32_t, int32_t> offset;
         delay_t penalty;
+        delay_t scale;
     };
 
-    std::mutex cost_map_mutex_;
     dict<TypeWirePair, CostMapEntry> cost_map_;
 
-    void fill_holes(const Context *ctx, const TypeWirePair &wire_pair, boost::multi_array<delay_t, 2> &matrix,
-                    delay_t delay_penality);
+    // Returns false if the holes could not be filled.
+    bool fill_holes(boost::multi_array<delay_t, 2> &matrix, delay_t delay_penality) const;
 
     std::pair<delay_t, int> get_nearby_cost_entry(const boost::multi_array<delay_t, 2> &matrix, int cx, int cy,
-                                                  const BoundingBox &bounds);
+                                                  const BoundingBox &bounds) const;
     delay_t get_penalty(const boost::multi_array<delay_t, 2> &matrix) const;
+    bool build_entry(const DeltaDelays &delays, CostMapEntry *entry) const;
+    static void quantise(const delay_t *costs, size_t count, CostMapEntry *entry);
 };
 
 NEXTPNR_NAMESPACE_END
@@ -18,6 +18,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "log.h"
 #include "nextpnr.h"
 #include "util.h"
@@ -103,6 +105,56 @@ static uint32_t get_num_pips(const Context *ctx, WireId wire, ExpansionDirection
     return num_pips;
 }
 
+void DedicatedPinTable::build(const dict<TileTypeBelPin, pool<DeltaTileTypeBelPin>> &map, size_t num_tile_types)
+{
+    std::vector<TileTypeBelPin> sorted_keys;
+    sorted_keys.reserve(map.size());
+    for (const auto &entry : map) {
+        sorted_keys.push_back(entry.first);
+    }
+    std::sort(sorted_keys.begin(), sorted_keys.end());
+
+    tile_type_offsets.assign(num_tile_types + 1, 0);
+    keys.clear();
+    other_offsets.clear();
+    others.clear();
+
+    other_offsets.push_back(0);
+    for (const TileTypeBelPin &key : sorted_keys) {
+        NPNR_ASSERT(key.tile_type >= 0 && size_t(key.tile_type) < num_tile_types);
+        tile_type_offsets[key.tile_type + 1] += 1;
+        keys.emplace_back(key.bel_index, key.bel_pin);
+
+        const pool<DeltaTileTypeBelPin> &key_others = map.at(key);
+        size_t others_begin = others.size();
+        others.insert(others.end(), key_others.begin(), key_others.end());
+        std::sort(others.begin() + others_begin, others.end());
+        other_offsets.push_back(others.size());
+    }
+
+    for (size_t tile_type = 0; tile_type < num_tile_types; ++tile_type) {
+        tile_type_offsets[tile_type + 1] += tile_type_offsets[tile_type];
+    }
+}
+
+int32_t DedicatedPinTable::find(const TileTypeBelPin &key) const
+{
+    auto begin = keys.begin() + tile_type_offsets.at(key.tile_type);
+    auto end = keys.begin() + tile_type_offsets.at(key.tile_type + 1);
+    auto found = std::lower_bound(begin, end, std::make_pair(key.bel_index, key.bel_pin));
+    if (found == end || found->first != key.bel_index || found->second != key.bel_pin) {
+        return -1;
+    }
+    return found - keys.begin();
+}
+
+bool DedicatedPinTable::contains(int32_t key_index, const DeltaTileTypeBelPin &other) const
+{
+    auto begin = others.begin() + other_offsets.at(key_index);
+    auto end = others.begin() + other_offsets.at(key_index + 1);
+    return std::binary_search(begin, end, other);
+}
+
 void DedicatedInterconnect::init(const Context *ctx)
 {
     this->ctx = ctx;
@@ -112,9 +164,16 @@ void DedicatedInterconnect::init(const Context *ctx)
     }
 
     find_dedicated_interconnect();
+    sink_table.build(sinks, ctx->chip_info->tile_types.size());
+    source_table.build(sources, ctx->chip_info->tile_types.size());
     if (ctx->debug) {
         print_dedicated_interconnect();
     }
+
+    // The maps are only needed to build the tables and for the debug dump,
+    // so don't keep both for the whole run.
+    sinks = dict<TileTypeBelPin, pool<DeltaTileTypeBelPin>>();
+    sources = dict<TileTypeBelPin, pool<DeltaTileTypeBelPin>>();
 }
 
 bool DedicatedInterconnect::check_routing(BelId src_bel, IdString src_bel_pin, BelId dst_bel, IdString dst_bel_pin,
@@ -264,8 +323,8 @@ bool DedicatedInterconnect::is_driver_on_net_valid(BelId driver_bel, const CellI
     for (IdString driver_bel_pin : ctx->getBelPinsForCellPin(cell, driver_port)) {
         type_bel_pin.bel_pin = driver_bel_pin;
 
-        auto iter = sources.find(type_bel_pin);
-        if (iter == sources.end()) {
+        int32_t source_index = source_table.find(type_bel_pin);
+        if (source_index == -1) {
             // This BEL pin doesn't have a dedicate interconnect.
             continue;
         }
@@ -309,7 +368,7 @@ bool DedicatedInterconnect::is_driver_on_net_valid(BelId driver_bel, const CellI
 
                 // Do fast routing check to see if the pair of driver and sink
                 // every are valid.
-                if (iter->second.count(sink_type_bel_pin) == 0) {
+                if (!source_table.contains(source_index, sink_type_bel_pin)) {
                     if (ctx->debug) {
                         log_info("BEL %s is not valid because pin %s cannot reach %s/%s\n", ctx->nameOfBel(driver_bel),
                                  driver_bel_pin.c_str(ctx), ctx->nameOfBel(sink_bel), sink_bel_pin.c_str(ctx));
@@ -351,8 +410,8 @@ bool DedicatedInterconnect::is_sink_on_net_valid(BelId bel, const CellInfo *cell
         type_bel_pin.bel_index = bel.index;
         type_bel_pin.bel_pin = bel_pin;
 
-        auto iter = sinks.find(type_bel_pin);
-        if (iter == sinks.end()) {
+        int32_t sink_index = sink_table.find(type_bel_pin);
+        if (sink_index == -1) {
             // This BEL pin doesn't have a dedicate interconnect.
             continue;
         }
@@ -388,7 +447,7 @@ bool DedicatedInterconnect::is_sink_on_net_valid(BelId bel, const CellInfo *cell
 
         // Do fast routing check to see if the pair of driver and sink
         // every are valid.
-        if (iter->second.count(driver_type_bel_pin) == 0) {
+        if (!sink_table.contains(sink_index, driver_type_bel_pin)) {
             if (ctx->debug) {
                 log_info("BEL %s is not valid because pin %s cannot be driven by %s/%s\n", ctx->nameOfBel(bel),
                          bel_pin.c_str(ctx), ctx->nameOfBel(driver_bel),
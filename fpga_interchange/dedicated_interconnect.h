@@ -23,6 +23,8 @@
 
 #include <boost/functional/hash.hpp>
 #include <cstdint>
+#include <tuple>
+#include <vector>
 
 #include "archdefs.h"
 #include "hashlib.h"
@@ -39,15 +41,7 @@ struct TileTypeBelPin
 
     bool operator<(const TileTypeBelPin &other) const
     {
-        if (tile_type >= other.tile_type) {
-            return false;
-        }
-
-        if (bel_index >= other.bel_index) {
-            return false;
-        }
-
-        return bel_pin < other.bel_pin;
+        return std::tie(tile_type, bel_index, bel_pin) < std::tie(other.tile_type, other.bel_index, other.bel_pin);
     }
 
     bool operator==(const TileTypeBelPin &other) const
@@ -76,6 +70,31 @@ struct DeltaTileTypeBelPin
         return delta_x != other.delta_x || delta_y != other.delta_y || type_bel_pin != other.type_bel_pin;
     }
     unsigned int hash() const { return mkhash(mkhash(delta_x, delta_y), type_bel_pin.hash()); }
+
+    bool operator<(const DeltaTileTypeBelPin &other) const
+    {
+        return std::tie(delta_x, delta_y, type_bel_pin) < std::tie(other.delta_x, other.delta_y, other.type_bel_pin);
+    }
+};
+
+// Read-only form of the sinks or sources map in DedicatedInterconnect, in
+// sorted flat arrays indexed by tile type, for the placement validity checks.
+struct DedicatedPinTable
+{
+    // The keys for tile type t are keys[tile_type_offsets[t]..tile_type_offsets[t + 1]],
+    // sorted, and the other end of key i is one of
+    // others[other_offsets[i]..other_offsets[i + 1]], also sorted.
+    std::vector<uint32_t> tile_type_offsets;
+    std::vector<std::pair<int32_t, IdString>> keys;
+    std::vector<uint32_t> other_offsets;
+    std::vector<DeltaTileTypeBelPin> others;
+
+    void build(const dict<TileTypeBelPin, pool<DeltaTileTypeBelPin>> &map, size_t num_tile_types);
+
+    // Returns the index of the key, or -1 if the BEL pin has no dedicated
+    // interconnect.
+    int32_t find(const TileTypeBelPin &key) const;
+    bool contains(int32_t key_index, const DeltaTileTypeBelPin &other) const;
 };
 
 struct Context;
@@ -97,9 +116,13 @@ struct DedicatedInterconnect
 {
     const Context *ctx;
 
+    // Only populated during init(), the tables below are used afterwards.
     dict<TileTypeBelPin, pool<DeltaTileTypeBelPin>> sinks;
     dict<TileTypeBelPin, pool<DeltaTileTypeBelPin>> sources;
 
+    DedicatedPinTable sink_table;
+    DedicatedPinTable source_table;
+
     void init(const Context *ctx);
 
     // Is this BEL placed in a location that is valid based on dedicated
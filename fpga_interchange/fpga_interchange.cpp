@@ -19,25 +19,48 @@
  */
 
 #include "fpga_interchange.h"
+#include <algorithm>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <capnp/message.h>
-#include <sstream>
+#include <cstring>
 #include <capnp/serialize.h>
-#include <kj/std/iostream.h>
 #include "PhysicalNetlist.capnp.h"
 #include "LogicalNetlist.capnp.h"
 #include "zlib.h"
 #include "frontend_base.h"
+#include "parallel_chunks.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
-static void write_message(::capnp::MallocMessageBuilder & message, const std::string &filename) {
-    kj::Array<capnp::word> words = messageToFlatArray(message);
-    kj::ArrayPtr<kj::byte> bytes = words.asBytes();
+// Write a message in the flat array format, gzipped. The segments are compressed one at a time straight out of the
+// builder, rather than first being copied into a single array.
+static void write_message(::capnp::MessageBuilder & message, const std::string &filename) {
+    kj::ArrayPtr<const kj::ArrayPtr<const capnp::word>> segments = message.getSegmentsForOutput();
+
+    // Segment table: the number of segments minus one, then the size of each segment in words, padded to a whole word
+    std::vector<uint32_t> table((segments.size() + 2) & ~size_t(1), 0);
+    table.at(0) = segments.size() - 1;
+    for(size_t i = 0; i < segments.size(); ++i) {
+        table.at(i + 1) = segments[i].size();
+    }
 
     gzFile file = gzopen(filename.c_str(), "w");
     NPNR_ASSERT(file != Z_NULL);
-
-    NPNR_ASSERT(gzwrite(file, &bytes[0], bytes.size()) == (int)bytes.size());
+    NPNR_ASSERT(gzbuffer(file, 1 << 20) == 0);
+
+    auto write = [&](const void *data, size_t size) {
+        const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data);
+        while(size > 0) {
+            unsigned chunk = std::min<size_t>(size, 1u << 30);
+            NPNR_ASSERT(gzwrite(file, ptr, chunk) == (int)chunk);
+            ptr += chunk;
+            size -= chunk;
+        }
+    };
+    write(table.data(), table.size() * sizeof(uint32_t));
+    for(auto segment : segments) {
+        write(segment.begin(), segment.size() * sizeof(capnp::word));
+    }
     NPNR_ASSERT(gzclose(file) == Z_OK);
 }
 
@@ -59,7 +82,7 @@ struct StringEnumerator {
 static PhysicalNetlist::PhysNetlist::RouteBranch::Builder emit_branch(
         const Context * ctx,
         StringEnumerator * strings,
-        const dict<PipId, PlaceStrength> &pip_place_strength,
+        bool is_fixed,
         PipId pip,
         PhysicalNetlist::PhysNetlist::RouteBranch::Builder branch) {
     if(ctx->is_pip_synthetic(pip)) {
@@ -89,7 +112,7 @@ static PhysicalNetlist::PhysNetlist::RouteBranch::Builder emit_branch(
         pip_obj.setWire0(strings->get_index(src_wire_name.str(ctx)));
         pip_obj.setWire1(strings->get_index(dst_wire_name.str(ctx)));
         pip_obj.setForward(true);
-        pip_obj.setIsFixed(pip_place_strength.at(pip) >= STRENGTH_FIXED);
+        pip_obj.setIsFixed(is_fixed);
 
         // If this is a pseudo PIP, get its name
         if (pip_data.pseudo_cell_wires.size() != 0) {
@@ -169,7 +192,7 @@ static PhysicalNetlist::PhysNetlist::RouteBranch::Builder emit_branch(
             site_pip.setSite(site_idx);
             site_pip.setBel(strings->get_index(pip_name[1].str(ctx)));
             site_pip.setPin(strings->get_index(pip_name[2].str(ctx)));
-            site_pip.setIsFixed(pip_place_strength.at(pip) >= STRENGTH_FIXED);
+            site_pip.setIsFixed(is_fixed);
 
             // FIXME: Mark inverter state.
             // This is required for US/US+ inverters, because those inverters
@@ -261,14 +284,34 @@ static void init_bel_pin(
 }
 
 
-static void emit_net(
+// The route tree of a net, worked out from its wires and pips. This only reads the routing of the net, so is done for
+// many nets in parallel, before they are written to the message in order.
+struct RouteTreeBranch {
+    // A pip, or a bel pin if pip is PipId()
+    PipId pip;
+    BelPin bel_pin;
+    bool is_fixed = false;
+    // The number of sub-branches that follow this one, or -1 for leaves that don't get a list of branches
+    int32_t num_branches = -1;
+};
+
+struct NetRouteTree {
+    // Source branches and all of their sub-branches, depth first
+    size_t num_sources = 0;
+    std::vector<RouteTreeBranch> branches;
+    std::vector<RouteTreeBranch> stubs;
+    // Warnings, which are logged when the net is written
+    std::vector<PortRef> sinks_without_bel_pins;
+    std::vector<WireId> unreached_wires;
+};
+
+static void add_route_tree(
         const Context * ctx,
-        StringEnumerator * strings,
         const dict<WireId, std::vector<PipId>> &pip_downhill,
         const dict<WireId, std::vector<BelPin>> &sinks,
         pool<PipId> *pips,
         const dict<PipId, PlaceStrength> &pip_place_strength,
-        WireId wire, PhysicalNetlist::PhysNetlist::RouteBranch::Builder branch) {
+        WireId wire, size_t parent, std::vector<RouteTreeBranch> *tree) {
     size_t number_branches = 0;
 
     auto downhill_iter = pip_downhill.find(wire);
@@ -281,27 +324,27 @@ static void emit_net(
         number_branches += sink_iter->second.size();
     }
 
-    size_t branch_index = 0;
-    auto branches = branch.initBranches(number_branches);
+    tree->at(parent).num_branches = number_branches;
 
     if(downhill_iter != pip_downhill.end()) {
         const std::vector<PipId> & wire_pips = downhill_iter->second;
         for(size_t i = 0; i < wire_pips.size(); ++i) {
             PipId pip = wire_pips.at(i);
             NPNR_ASSERT(pips->erase(pip) == 1);
-            PhysicalNetlist::PhysNetlist::RouteBranch::Builder leaf_branch = emit_branch(
-                ctx, strings, pip_place_strength, pip, branches[branch_index++]);
+            tree->emplace_back();
+            tree->back().pip = pip;
+            tree->back().is_fixed = pip_place_strength.at(pip) >= STRENGTH_FIXED;
 
-            emit_net(ctx, strings, pip_downhill, sinks, pips,
+            add_route_tree(ctx, pip_downhill, sinks, pips,
                     pip_place_strength,
-                    ctx->getPipDstWire(pip), leaf_branch);
+                    ctx->getPipDstWire(pip), tree->size() - 1, tree);
         }
     }
 
     if(sink_iter != sinks.end()) {
         for(const auto bel_pin : sink_iter->second) {
-            auto leaf_branch = branches[branch_index++];
-            init_bel_pin(ctx, strings, bel_pin, leaf_branch);
+            tree->emplace_back();
+            tree->back().bel_pin = bel_pin;
         }
     }
 }
@@ -349,29 +392,30 @@ static BelPin find_source(const Context *ctx, WireId source_wire) {
 }
 
 // Initial a local signal source (usually VCC/GND).
-static PhysicalNetlist::PhysNetlist::RouteBranch::Builder init_local_source(
+static void add_local_source(
         const Context *ctx,
-        StringEnumerator * strings,
-        PhysicalNetlist::PhysNetlist::RouteBranch::Builder source_branch,
         PipId root,
         const dict<PipId, PlaceStrength> &pip_place_strength,
+        std::vector<RouteTreeBranch> *tree,
         WireId *root_wire) {
     WireId source_wire = ctx->getPipSrcWire(root);
     BelPin source_bel_pin = find_source(ctx, source_wire);
     if(source_bel_pin.bel != BelId()) {
         // This branch should first emit the BEL pin that is the source, followed
         // by the pip that brings the source to the net.
-        init_bel_pin(ctx, strings, source_bel_pin, source_branch);
-
-        source_branch = source_branch.initBranches(1)[0];
+        tree->emplace_back();
+        tree->back().bel_pin = source_bel_pin;
+        tree->back().num_branches = 1;
     }
     *root_wire = ctx->getPipDstWire(root);
-    return emit_branch(ctx, strings, pip_place_strength, root, source_branch);
+    tree->emplace_back();
+    tree->back().pip = root;
+    tree->back().is_fixed = pip_place_strength.at(root) >= STRENGTH_FIXED;
 }
 
 static void find_non_synthetic_edges(const Context * ctx, WireId root_wire,
         const dict<WireId, std::vector<PipId>> &pip_downhill,
-        std::vector<PipId> *root_pips) {
+        std::vector<PipId> *root_pips, std::vector<WireId> *unreached_wires) {
     std::vector<WireId> wires_to_expand;
 
     wires_to_expand.push_back(root_wire);
@@ -382,8 +426,7 @@ static void find_non_synthetic_edges(const Context * ctx, WireId root_wire,
         auto downhill_iter = pip_downhill.find(wire);
         if(downhill_iter == pip_downhill.end()) {
             if(root_wire != wire) {
-                log_warning("Wire %s never entered the real fabric?\n",
-                        ctx->nameOfWire(wire));
+                unreached_wires->push_back(wire);
             }
             continue;
         }
@@ -391,7 +434,7 @@ static void find_non_synthetic_edges(const Context * ctx, WireId root_wire,
         for(PipId pip : pip_downhill.at(wire)) {
             if(!ctx->is_pip_synthetic(pip)) {
                 // Stop following edges that are non-synthetic, they will be
-                // followed during emit_net
+                // followed by add_route_tree
                 root_pips->push_back(pip);
             } else {
                 // Continue to follow synthetic edges.
@@ -401,14 +444,165 @@ static void find_non_synthetic_edges(const Context * ctx, WireId root_wire,
     }
 }
 
+// Work out the route tree of a net. sinks_without_bel_pins and unreached_wires are filled in rather than being
+// logged, so that this can be run outside of the main thread.
+static void build_route_tree(const Context * ctx, const NetInfo & net,
+        const pool<IdString> &valid_cells, NetRouteTree *tree) {
+    const CellInfo *driver_cell = net.driver.cell;
+
+    dict<WireId, BelPin> root_wires;
+    dict<WireId, std::vector<PipId>> pip_downhill;
+    pool<PipId> pips;
+
+    if (driver_cell != nullptr && driver_cell->bel != BelId() && valid_cells.count(driver_cell->name)) {
+        for(IdString bel_pin_name : driver_cell->cell_bel_pins.at(net.driver.port)) {
+            BelPin driver_bel_pin;
+            driver_bel_pin.bel = driver_cell->bel;
+            driver_bel_pin.pin = bel_pin_name;
+
+            WireId driver_wire = ctx->getBelPinWire(driver_bel_pin.bel, bel_pin_name);
+            if(driver_wire != WireId()) {
+                root_wires[driver_wire] = driver_bel_pin;
+            }
+        }
+    }
+
+    dict<WireId, std::vector<BelPin>> sinks;
+    for(const auto &port_ref : net.users) {
+        if(port_ref.cell != nullptr && port_ref.cell->bel != BelId() && valid_cells.count(port_ref.cell->name)) {
+            auto pin_iter = port_ref.cell->cell_bel_pins.find(port_ref.port);
+            if(pin_iter == port_ref.cell->cell_bel_pins.end()) {
+                tree->sinks_without_bel_pins.push_back(port_ref);
+                continue;
+            }
+
+            for(IdString bel_pin_name : pin_iter->second) {
+                BelPin sink_bel_pin;
+                sink_bel_pin.bel = port_ref.cell->bel;
+                sink_bel_pin.pin = bel_pin_name;
+
+                WireId sink_wire = ctx->getBelPinWire(sink_bel_pin.bel, bel_pin_name);
+                if(sink_wire != WireId()) {
+                    sinks[sink_wire].push_back(sink_bel_pin);
+                }
+            }
+        }
+    }
+
+    dict<PipId, PlaceStrength> pip_place_strength;
+
+    for(auto &wire_pair : net.wires) {
+        WireId downhill_wire = wire_pair.first;
+        PipId pip = wire_pair.second.pip;
+        PlaceStrength strength = wire_pair.second.strength;
+        pip_place_strength[pip] = strength;
+        if(pip != PipId()) {
+            pips.emplace(pip);
+
+            WireId uphill_wire = ctx->getPipSrcWire(pip);
+            NPNR_ASSERT(downhill_wire != uphill_wire);
+            pip_downhill[uphill_wire].push_back(pip);
+        } else {
+            // This is a root wire.
+            NPNR_ASSERT(root_wires.count(downhill_wire));
+        }
+    }
+
+    std::vector<PipId> root_pips;
+    std::vector<WireId> roots_to_remove;
+
+    for(const auto & root_pair : root_wires) {
+        WireId root_wire = root_pair.first;
+        BelPin src_bel_pin = root_pair.second;
+
+        if(!ctx->is_bel_synthetic(src_bel_pin.bel)) {
+            continue;
+        }
+
+        roots_to_remove.push_back(root_wire);
+        find_non_synthetic_edges(ctx, root_wire, pip_downhill, &root_pips, &tree->unreached_wires);
+    }
+
+    // Remove wires that have a synthetic root.
+    for(WireId wire : roots_to_remove) {
+        NPNR_ASSERT(root_wires.erase(wire) == 1);
+    }
+
+    tree->num_sources = root_wires.size() + root_pips.size();
+
+    for(const auto & root_pair : root_wires) {
+        WireId root_wire = root_pair.first;
+
+        tree->branches.emplace_back();
+        tree->branches.back().bel_pin = root_pair.second;
+
+        add_route_tree(ctx, pip_downhill, sinks, &pips, pip_place_strength, root_wire,
+                tree->branches.size() - 1, &tree->branches);
+    }
+
+    for(const PipId root : root_pips) {
+        NPNR_ASSERT(pips.erase(root) == 1);
+        WireId root_wire;
+        add_local_source(ctx, root, pip_place_strength, &tree->branches, &root_wire);
+        add_route_tree(ctx, pip_downhill, sinks, &pips, pip_place_strength, root_wire,
+                tree->branches.size() - 1, &tree->branches);
+    }
+
+    // Any pips that were not part of a tree starting from the source are
+    // stubs.
+    for(PipId pip : pips) {
+        if(ctx->is_pip_synthetic(pip)) {
+            continue;
+        }
+        tree->stubs.emplace_back();
+        tree->stubs.back().pip = pip;
+        tree->stubs.back().is_fixed = pip_place_strength.at(pip) >= STRENGTH_FIXED;
+    }
+}
+
+// Write the branch at *index of a route tree, and all of its sub-branches.
+static void write_branch(
+        const Context * ctx,
+        StringEnumerator * strings,
+        const std::vector<RouteTreeBranch> &tree,
+        size_t *index,
+        PhysicalNetlist::PhysNetlist::RouteBranch::Builder branch) {
+    const RouteTreeBranch &node = tree.at((*index)++);
+    if(node.pip != PipId()) {
+        branch = emit_branch(ctx, strings, node.is_fixed, node.pip, branch);
+    } else {
+        init_bel_pin(ctx, strings, node.bel_pin, branch);
+    }
+
+    if(node.num_branches < 0) {
+        return;
+    }
+
+    auto branches = branch.initBranches(node.num_branches);
+    for(auto sub_branch : branches) {
+        write_branch(ctx, strings, tree, index, sub_branch);
+    }
+}
+
 void FpgaInterchange::write_physical_netlist(const Context * ctx, const std::string &filename) {
-    ::capnp::MallocMessageBuilder message;
+    // Most of the message is the route trees of the nets; size the first segment from a rough estimate of them, so
+    // that large designs are built in a few big segments rather than many small ones.
+    size_t estimated_words = 0;
+    for(auto & net_pair : ctx->nets) {
+        estimated_words += 8 * (net_pair.second->wires.size() + net_pair.second->users.size());
+    }
+    for(auto & cell_pair : ctx->cells) {
+        estimated_words += 16 + 4 * cell_pair.second->cell_bel_pins.size();
+    }
+    ::capnp::MallocMessageBuilder message(std::min<size_t>(std::max<size_t>(estimated_words, 1024), 1 << 28));
 
     PhysicalNetlist::PhysNetlist::Builder phys_netlist = message.initRoot<PhysicalNetlist::PhysNetlist>();
 
     phys_netlist.setPart(ctx->get_part());
 
     pool<IdString> placed_cells;
+    // Checking BEL locations isn't thread safe, so this is done up front for the route trees
+    pool<IdString> valid_cells;
     for(const auto & cell_pair : ctx->cells) {
         const CellInfo & cell = *cell_pair.second;
         if(cell.bel == BelId()) {
@@ -427,6 +621,11 @@ void FpgaInterchange::write_physical_netlist(const Context * ctx, const std::str
     for(auto & cell_name : placed_cells) {
         const CellInfo & cell = *ctx->cells.at(cell_name);
 
+        bool location_valid = ctx->isBelLocationValid(cell.bel);
+        if(location_valid) {
+            valid_cells.insert(cell.name);
+        }
+
         if(cell.type == nextpnr_inv) {
             continue;
         }
@@ -435,7 +634,7 @@ void FpgaInterchange::write_physical_netlist(const Context * ctx, const std::str
             continue;
         }
 
-        if(!ctx->isBelLocationValid(cell.bel)) {
+        if(!location_valid) {
             log_error("Cell '%s' is placed at BEL '%s', but this location is currently invalid.  Not writing physical netlist.\n",
                     cell.name.c_str(ctx), ctx->nameOfBel(cell.bel));
         }
@@ -540,163 +739,81 @@ void FpgaInterchange::write_physical_netlist(const Context * ctx, const std::str
         phys_cell.setPhysType(PhysicalNetlist::PhysNetlist::PhysCellType::PORT);
     }
 
-    int nets_to_remove = 0;
+    std::vector<const NetInfo *> nets_to_write;
     for(auto & net_pair : ctx->nets) {
         auto &net = *net_pair.second;
 
         // Remove disconnected nets that do not have any users
-        auto net_name = std::string(net.name.c_str(ctx));
-        if (net.users.empty() && net_name.rfind("$frontend$", 0) == 0)
-            nets_to_remove++;
-    }
-
-    auto nets = phys_netlist.initPhysNets(ctx->nets.size() - nets_to_remove);
-    auto net_iter = nets.begin();
-    for(auto & net_pair : ctx->nets) {
-        auto &net = *net_pair.second;
-
         auto net_name = std::string(net.name.c_str(ctx));
         if (net.users.empty() && net_name.rfind("$frontend$", 0) == 0)
             continue;
 
-        const CellInfo *driver_cell = net.driver.cell;
-
-        auto net_out = *net_iter++;
-
-        // Handle GND and VCC nets.
-        if(driver_cell != nullptr && driver_cell->bel == ctx->get_gnd_bel()) {
-            IdString gnd_net_name(ctx->chip_info->constants->gnd_net_name);
-            net_out.setName(strings.get_index(gnd_net_name.str(ctx)));
-            net_out.setType(PhysicalNetlist::PhysNetlist::NetType::GND);
-        } else if(driver_cell != nullptr && driver_cell->bel == ctx->get_vcc_bel()) {
-            IdString vcc_net_name(ctx->chip_info->constants->vcc_net_name);
-            net_out.setName(strings.get_index(vcc_net_name.str(ctx)));
-            net_out.setType(PhysicalNetlist::PhysNetlist::NetType::VCC);
-        } else {
-            net_out.setName(strings.get_index(net.name.str(ctx)));
-        }
-
-        dict<WireId, BelPin> root_wires;
-        dict<WireId, std::vector<PipId>> pip_downhill;
-        pool<PipId> pips;
-
-        if (driver_cell != nullptr && driver_cell->bel != BelId() && ctx->isBelLocationValid(driver_cell->bel)) {
-            for(IdString bel_pin_name : driver_cell->cell_bel_pins.at(net.driver.port)) {
-                BelPin driver_bel_pin;
-                driver_bel_pin.bel = driver_cell->bel;
-                driver_bel_pin.pin = bel_pin_name;
+        nets_to_write.push_back(&net);
+    }
 
-                WireId driver_wire = ctx->getBelPinWire(driver_bel_pin.bel, bel_pin_name);
-                if(driver_wire != WireId()) {
-                    root_wires[driver_wire] = driver_bel_pin;
+    // Route trees are found in parallel, and then written out in net order, as the message builders are not thread
+    // safe (and the string table must be filled in the same order every time). This is done a batch of nets at a time,
+    // so that only the route trees of one batch are held in memory at once.
+    const int nets_per_chunk = 4096;
+    const int nets_per_batch = nets_per_chunk * get_parallel_threads(ctx);
+    auto nets = phys_netlist.initPhysNets(nets_to_write.size());
+    auto net_iter = nets.begin();
+    for (int batch_start = 0; batch_start < int(nets_to_write.size()); batch_start += nets_per_batch) {
+        int batch_size = std::min(nets_per_batch, int(nets_to_write.size()) - batch_start);
+        auto route_trees = parallel_chunks<std::vector<NetRouteTree>>(
+                ctx, batch_size, nets_per_chunk, [&](int begin, int end, std::vector<NetRouteTree> &trees) {
+                    trees.resize(end - begin);
+                    for (int i = begin; i < end; ++i) {
+                        build_route_tree(ctx, *nets_to_write.at(batch_start + i), valid_cells,
+                                         &trees.at(i - begin));
+                    }
+                });
+
+        size_t net_index = batch_start;
+        for (auto &chunk : route_trees) {
+            for (auto &tree : chunk) {
+                const NetInfo &net = *nets_to_write.at(net_index++);
+                const CellInfo *driver_cell = net.driver.cell;
+
+                auto net_out = *net_iter++;
+
+                // Handle GND and VCC nets.
+                if (driver_cell != nullptr && driver_cell->bel == ctx->get_gnd_bel()) {
+                    IdString gnd_net_name(ctx->chip_info->constants->gnd_net_name);
+                    net_out.setName(strings.get_index(gnd_net_name.str(ctx)));
+                    net_out.setType(PhysicalNetlist::PhysNetlist::NetType::GND);
+                } else if (driver_cell != nullptr && driver_cell->bel == ctx->get_vcc_bel()) {
+                    IdString vcc_net_name(ctx->chip_info->constants->vcc_net_name);
+                    net_out.setName(strings.get_index(vcc_net_name.str(ctx)));
+                    net_out.setType(PhysicalNetlist::PhysNetlist::NetType::VCC);
+                } else {
+                    net_out.setName(strings.get_index(net.name.str(ctx)));
                 }
-            }
-        }
 
-        dict<WireId, std::vector<BelPin>> sinks;
-        for(const auto &port_ref : net.users) {
-            if(port_ref.cell != nullptr && port_ref.cell->bel != BelId() && ctx->isBelLocationValid(port_ref.cell->bel)) {
-                auto pin_iter = port_ref.cell->cell_bel_pins.find(port_ref.port);
-                if(pin_iter == port_ref.cell->cell_bel_pins.end()) {
+                for (const PortRef &port_ref : tree.sinks_without_bel_pins) {
                     log_warning("Cell %s port %s on net %s is legal, but has no BEL pins?\n",
-                            port_ref.cell->name.c_str(ctx),
-                            port_ref.port.c_str(ctx),
-                            net.name.c_str(ctx));
-                    continue;
+                                port_ref.cell->name.c_str(ctx), port_ref.port.c_str(ctx), net.name.c_str(ctx));
                 }
-
-                for(IdString bel_pin_name : pin_iter->second) {
-                    BelPin sink_bel_pin;
-                    sink_bel_pin.bel = port_ref.cell->bel;
-                    sink_bel_pin.pin = bel_pin_name;
-
-                    WireId sink_wire = ctx->getBelPinWire(sink_bel_pin.bel, bel_pin_name);
-                    if(sink_wire != WireId()) {
-                        sinks[sink_wire].push_back(sink_bel_pin);
-                    }
+                for (WireId wire : tree.unreached_wires) {
+                    log_warning("Wire %s never entered the real fabric?\n", ctx->nameOfWire(wire));
                 }
-            }
-        }
-
-        dict<PipId, PlaceStrength> pip_place_strength;
-
-        for(auto &wire_pair : net.wires) {
-            WireId downhill_wire = wire_pair.first;
-            PipId pip = wire_pair.second.pip;
-            PlaceStrength strength = wire_pair.second.strength;
-            pip_place_strength[pip] = strength;
-            if(pip != PipId()) {
-                pips.emplace(pip);
-
-                WireId uphill_wire = ctx->getPipSrcWire(pip);
-                NPNR_ASSERT(downhill_wire != uphill_wire);
-                pip_downhill[uphill_wire].push_back(pip);
-            } else {
-                // This is a root wire.
-                NPNR_ASSERT(root_wires.count(downhill_wire));
-            }
-        }
-
-        std::vector<PipId> root_pips;
-        std::vector<WireId> roots_to_remove;
-
-        for(const auto & root_pair : root_wires) {
-            WireId root_wire = root_pair.first;
-            BelPin src_bel_pin = root_pair.second;
 
-            if(!ctx->is_bel_synthetic(src_bel_pin.bel)) {
-                continue;
-            }
-
-            roots_to_remove.push_back(root_wire);
-            find_non_synthetic_edges(ctx, root_wire, pip_downhill, &root_pips);
-        }
-
-        // Remove wires that have a synthetic root.
-        for(WireId wire : roots_to_remove) {
-            NPNR_ASSERT(root_wires.erase(wire) == 1);
-        }
-
-        auto sources = net_out.initSources(root_wires.size() + root_pips.size());
-        auto source_iter = sources.begin();
-
-        for(const auto & root_pair : root_wires) {
-            WireId root_wire = root_pair.first;
-            BelPin src_bel_pin = root_pair.second;
-
-            PhysicalNetlist::PhysNetlist::RouteBranch::Builder source_branch = *source_iter++;
-            init_bel_pin(ctx, &strings, src_bel_pin, source_branch);
-
-            emit_net(ctx, &strings, pip_downhill, sinks, &pips, pip_place_strength, root_wire, source_branch);
-        }
-
-        for(const PipId root : root_pips) {
-            PhysicalNetlist::PhysNetlist::RouteBranch::Builder source_branch = *source_iter++;
-
-            NPNR_ASSERT(pips.erase(root) == 1);
-            WireId root_wire;
-            source_branch = init_local_source(ctx, &strings, source_branch, root, pip_place_strength, &root_wire);
-            emit_net(ctx, &strings, pip_downhill, sinks, &pips, pip_place_strength, root_wire, source_branch);
-        }
+                auto sources = net_out.initSources(tree.num_sources);
+                size_t index = 0;
+                for (auto source_branch : sources) {
+                    write_branch(ctx, &strings, tree.branches, &index, source_branch);
+                }
+                NPNR_ASSERT(index == tree.branches.size());
 
-        // Any pips that were not part of a tree starting from the source are
-        // stubs.
-        size_t real_pips = 0;
-        for(PipId pip : pips) {
-            if(ctx->is_pip_synthetic(pip)) {
-                continue;
-            }
-            real_pips += 1;
-        }
-        auto stubs = net_out.initStubs(real_pips);
-        auto stub_iter = stubs.begin();
-        for(PipId pip : pips) {
-            if(ctx->is_pip_synthetic(pip)) {
-                continue;
+                auto stubs = net_out.initStubs(tree.stubs.size());
+                auto stub_iter = stubs.begin();
+                for (const RouteTreeBranch &stub : tree.stubs) {
+                    emit_branch(ctx, &strings, stub.is_fixed, stub.pip, *stub_iter++);
+                }
             }
-            emit_branch(ctx, &strings, pip_place_strength, pip, *stub_iter++);
         }
     }
+    NPNR_ASSERT(net_iter == nets.end());
 
     auto site_instances = phys_netlist.initSiteInsts(sites.size());
     auto site_inst_iter = site_instances.begin();
@@ -1099,35 +1216,83 @@ ModuleReader::ModuleReader(const LogicalNetlistImpl *root,
     }
 }
 
-void FpgaInterchange::read_logical_netlist(Context * ctx, const std::string &filename) {
-    gzFile file = gzopen(filename.c_str(), "r");
-    NPNR_ASSERT(file != Z_NULL);
-
-    std::vector<uint8_t> output_data;
-    output_data.resize(4096);
-    std::stringstream sstream(std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+// Inflate a gzip file (which may have several members) straight into a word buffer for FlatArrayMessageReader.
+static std::vector<capnp::word> inflate_message(const std::string &filename, const uint8_t *data, size_t size) {
+    // The gzip trailer has the uncompressed size modulo 2^32, which is used as a first guess of the buffer size
+    uint32_t size_hint = 0;
+    if(size >= 4)
+        memcpy(&size_hint, data + size - 4, sizeof(size_hint));
+    std::vector<capnp::word> words((size_t(size_hint) + sizeof(capnp::word) - 1) / sizeof(capnp::word) + 1);
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    // 16 + MAX_WBITS: expect a gzip header
+    if(inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK)
+        log_error("Failed to initialise zlib for '%s'.\n", filename.c_str());
+    const size_t max_chunk = size_t(1) << 30;
+    size_t in_pos = 0, out_pos = 0;
     while(true) {
-        int ret = gzread(file, output_data.data(), output_data.size());
-        NPNR_ASSERT(ret >= 0);
-        if(ret > 0) {
-            sstream.write((const char*)output_data.data(), ret);
-            NPNR_ASSERT(sstream);
-        } else {
-            NPNR_ASSERT(ret == 0);
-            int error;
-            gzerror(file, &error);
-            NPNR_ASSERT(error == Z_OK);
-            break;
+        size_t out_size = words.size() * sizeof(capnp::word);
+        if(out_pos == out_size) {
+            words.resize(words.size() * 2);
+            out_size = words.size() * sizeof(capnp::word);
+        }
+        uint8_t *out = reinterpret_cast<uint8_t *>(words.data());
+        strm.next_in = const_cast<Bytef *>(data + in_pos);
+        strm.avail_in = std::min(size - in_pos, max_chunk);
+        strm.next_out = out + out_pos;
+        strm.avail_out = std::min(out_size - out_pos, max_chunk);
+        size_t avail_in = strm.avail_in, avail_out = strm.avail_out;
+        int ret = inflate(&strm, Z_NO_FLUSH);
+        in_pos += avail_in - strm.avail_in;
+        out_pos += avail_out - strm.avail_out;
+        if(ret == Z_STREAM_END) {
+            if(in_pos == size)
+                break;
+            // Another gzip member follows
+            NPNR_ASSERT(inflateReset(&strm) == Z_OK);
+        } else if(ret != Z_OK && !(ret == Z_BUF_ERROR && strm.avail_out == 0)) {
+            std::string msg = strm.msg ? strm.msg : "truncated file";
+            inflateEnd(&strm);
+            log_error("Failed to decompress '%s' (%s).\n", filename.c_str(), msg.c_str());
         }
     }
+    inflateEnd(&strm);
 
-    NPNR_ASSERT(gzclose(file) == Z_OK);
+    if(out_pos % sizeof(capnp::word) != 0)
+        log_error("'%s' is not a valid Cap'n Proto message.\n", filename.c_str());
+    words.resize(out_pos / sizeof(capnp::word));
+    return words;
+}
+
+void FpgaInterchange::read_logical_netlist(Context * ctx, const std::string &filename) {
+    // The file is mapped rather than read; uncompressed messages are then used in place, and gzipped ones are inflated
+    // in one pass into the buffer that is read from, rather than being copied through several streams
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch(std::ios_base::failure &) {
+    }
+    if(!file.is_open())
+        log_error("Failed to open logical netlist '%s'.\n", filename.c_str());
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(file.data());
+    size_t size = file.size();
+
+    std::vector<capnp::word> inflated;
+    kj::ArrayPtr<const capnp::word> words;
+    if(size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+        inflated = inflate_message(filename, data, size);
+        file.close();
+        words = kj::arrayPtr(inflated.data(), inflated.size());
+    } else {
+        if(size % sizeof(capnp::word) != 0)
+            log_error("'%s' is not a valid Cap'n Proto message.\n", filename.c_str());
+        words = kj::arrayPtr(reinterpret_cast<const capnp::word *>(data), size / sizeof(capnp::word));
+    }
 
-    sstream.seekg(0);
-    kj::std::StdInputStream istream(sstream);
     capnp::ReaderOptions reader_options;
     reader_options.traversalLimitInWords = 32llu*1024llu*1024llu*1024llu;
-    capnp::InputStreamMessageReader message_reader(istream, reader_options);
+    capnp::FlatArrayMessageReader message_reader(words, reader_options);
 
     LogicalNetlist::Netlist::Reader netlist = message_reader.getRoot<LogicalNetlist::Netlist>();
     LogicalNetlistImpl netlist_reader(netlist);
@@ -33,12 +33,8 @@
 #include "context.h"
 #include "flat_wire_map.h"
 #include "log.h"
+#include "parallel_chunks.h"
 #include "sampler.h"
-#include "scope_lock.h"
-
-#if defined(NEXTPNR_USE_TBB)
-#include <tbb/parallel_for_each.h>
-#endif
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -641,183 +637,62 @@ void write_lookahead_csv(const Context *ctx, const DelayStorage &all_tiles_stora
     fclose(lookahead_data);
 }
 
-// Storage for tile type expansion for lookahead.
-struct ExpandLocals
+// Results of expanding a range of wire types. Each thread expands into its own shard, and the shards are merged in
+// order afterwards, so no locking is needed and the result doesn't depend on the number of threads.
+struct ExpandShard
 {
-    virtual ~ExpandLocals() {}
-    const std::vector<Sampler> *tiles_of_type;
-    DeterministicRNG *rng;
-    FlatWireMap<PipAndCost> *best_path;
-    DelayStorage *storage;
-    pool<TypeWireSet> *explored;
-    pool<TypeWireId> *deferred;
-
-    virtual void lock() {}
-    virtual void unlock() {}
-    virtual void copy_back(int32_t tile_type) {}
+    DelayStorage storage;
+    pool<TypeWireSet> explored;
+    pool<TypeWireId> deferred;
 };
 
-// Do tile type expansion for 1 tile.
-static void expand_tile_type(const Context *ctx, int32_t tile_type, ExpandLocals *locals)
+struct OutputExpandShard
 {
-    auto &type_data = ctx->chip_info->tile_types[tile_type];
-    if (ctx->verbose) {
-        ScopeLock<ExpandLocals> lock(locals);
-        log_info("Expanding all wires in type %s\n", IdString(type_data.name).c_str(ctx));
-    }
-
-    auto &tile_sampler = (*locals->tiles_of_type)[tile_type];
-    for (size_t wire_index = 0; wire_index < type_data.wire_data.size(); ++wire_index) {
-        auto &wire_data = type_data.wire_data[wire_index];
-        if (wire_data.site != -1) {
-            // Skip site wires
-            continue;
-        }
+    std::vector<Lookahead::OutputSiteWireCost> output_costs;
+    dict<TypeWirePair, delay_t> site_to_site_cost;
+};
 
-        if (ctx->debug) {
-            ScopeLock<ExpandLocals> lock(locals);
-            log_info("Expanding wire %s in type %s (%d/%zu, seen %zu types, deferred %zu types)\n",
-                     IdString(wire_data.name).c_str(ctx), IdString(type_data.name).c_str(ctx), tile_type,
-                     ctx->chip_info->tile_types.size(), locals->explored->size(), locals->deferred->size());
+// Merge costs into another map, keeping the cheapest cost for keys in both.
+template <typename Key> static void merge_min_costs(const dict<Key, delay_t> &from, dict<Key, delay_t> *into)
+{
+    for (const auto &cost_pair : from) {
+        auto result = into->emplace(cost_pair.first, cost_pair.second);
+        if (!result.second && cost_pair.second < result.first->second) {
+            result.first->second = cost_pair.second;
         }
-
-        TypeWireId wire;
-        wire.type = tile_type;
-        wire.index = wire_index;
-
-        expand_routing_graph(ctx, locals->rng, tile_sampler, wire, locals->explored, locals->storage, locals->deferred,
-                             locals->best_path);
     }
-
-    locals->copy_back(tile_type);
 }
 
-// Function that does all tile expansions serially.
-static void expand_tile_type_serial(const Context *ctx, const std::vector<int32_t> &tile_types,
-                                    const std::vector<Sampler> &tiles_of_type, DeterministicRNG *rng,
-                                    FlatWireMap<PipAndCost> *best_path, DelayStorage *storage,
-                                    pool<TypeWireSet> *explored, pool<TypeWireId> *deferred, pool<int32_t> *tiles_left)
+static void merge_shard(const ExpandShard &shard, ExpandShard *all)
 {
-
-    for (int32_t tile_type : tile_types) {
-        ExpandLocals locals;
-
-        locals.tiles_of_type = &tiles_of_type;
-        locals.rng = rng;
-        locals.best_path = best_path;
-        locals.storage = storage;
-        locals.explored = explored;
-        expand_tile_type(ctx, tile_type, &locals);
-
-        NPNR_ASSERT(tiles_left->erase(tile_type) == 1);
+    for (const auto &type_pair : shard.storage.storage) {
+        merge_min_costs(type_pair.second, &all->storage.storage[type_pair.first]);
     }
-
-    NPNR_ASSERT(tiles_left->empty());
-}
-
-// Additional storage for doing tile type expansion in parallel.
-struct TbbExpandLocals : public ExpandLocals
-{
-    const Context *ctx;
-    std::mutex *all_costs_mutex;
-
-    DelayStorage *all_tiles_storage;
-    pool<TypeWireSet> *types_explored;
-    pool<TypeWireId> *types_deferred;
-    pool<int32_t> *tiles_left;
-
-    void lock() override { all_costs_mutex->lock(); }
-
-    void unlock() override { all_costs_mutex->unlock(); }
-
-    void copy_back(int32_t tile_type) override
-    {
-        ScopeLock<TbbExpandLocals> locker(this);
-
-        auto &type_data = ctx->chip_info->tile_types[tile_type];
-
-        // Copy per tile data by to over all data structures.
-        if (ctx->verbose) {
-            log_info("Expanded all wires in type %s, merging data back\n", IdString(type_data.name).c_str(ctx));
-            log_info("Testing %zu wires, saw %zu types, deferred %zu types\n", type_data.wire_data.size(),
-                     explored->size(), deferred->size());
-        }
-
-        // Copy cheapest explored paths back to all_tiles_storage.
-        for (const auto &type_pair : storage->storage) {
-            auto &type_pair_data = all_tiles_storage->storage[type_pair.first];
-            for (const auto &delta_pair : type_pair.second) {
-                // See if this dx/dy already has data.
-                auto result = type_pair_data.emplace(delta_pair.first, delta_pair.second);
-                if (!result.second) {
-                    // This was already in the map, check if this new result is
-                    // better
-                    if (delta_pair.second < result.first->second) {
-                        result.first->second = delta_pair.second;
-                    }
-                }
-            }
-        }
-
-        // Update explored and deferred sets.
-        for (auto &key : *explored) {
-            types_explored->emplace(key);
-        }
-        for (auto &key : *deferred) {
-            types_deferred->emplace(key);
-        }
-
-        NPNR_ASSERT(tiles_left->erase(tile_type));
-
-        if (ctx->verbose) {
-            log_info("Done merging data from type %s, %zu tiles left\n", IdString(type_data.name).c_str(ctx),
-                     tiles_left->size());
-        }
+    for (auto &key : shard.explored) {
+        all->explored.emplace(key);
     }
-};
+    for (auto &key : shard.deferred) {
+        all->deferred.emplace(key);
+    }
+}
 
-// Wrapper method used if running expansion in parallel.
-//
-// expand_tile_type is invoked using thread local data, and then afterwards
-// the data is joined with the global data.
-static void expand_tile_type_parallel(const Context *ctx, int32_t tile_type, const std::vector<Sampler> &tiles_of_type,
-                                      DeterministicRNG *rng, std::mutex *all_costs_mutex,
-                                      DelayStorage *all_tiles_storage, pool<TypeWireSet> *types_explored,
-                                      pool<TypeWireId> *types_deferred, pool<int32_t> *tiles_left)
+// Each wire type is sampled with its own random number generator, so that the samples don't depend on how the work
+// was split between threads.
+static DeterministicRNG wire_type_rng(uint64_t seed, TypeWireId wire_type)
 {
-    TbbExpandLocals locals;
-
-    DeterministicRNG rng_copy = *rng;
-    FlatWireMap<PipAndCost> best_path(ctx);
-    pool<TypeWireSet> explored;
-    pool<TypeWireId> deferred;
-    DelayStorage storage;
-    storage.max_explore_depth = all_tiles_storage->max_explore_depth;
-
-    locals.tiles_of_type = &tiles_of_type;
-    locals.rng = &rng_copy;
-    locals.best_path = &best_path;
-    locals.storage = &storage;
-    locals.explored = &explored;
-    locals.deferred = &deferred;
-
-    locals.ctx = ctx;
-    locals.all_costs_mutex = all_costs_mutex;
-    locals.all_tiles_storage = all_tiles_storage;
-    locals.types_explored = types_explored;
-    locals.types_deferred = types_deferred;
-    locals.tiles_left = tiles_left;
-
-    expand_tile_type(ctx, tile_type, &locals);
+    DeterministicRNG rng;
+    rng.rngseed(seed ^ ((uint64_t(uint32_t(wire_type.type)) << 32) | uint32_t(wire_type.index)));
+    return rng;
 }
 
 void Lookahead::build_lookahead(const Context *ctx, DeterministicRNG *rng)
 {
     auto start = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        return std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+    };
 
-    if (ctx->verbose) {
-        log_info("Building lookahead, first gathering input and output site wires\n");
-    }
+    log_info("Building router lookahead...\n");
 
     pool<TypeWireId> input_site_ports;
     for (BelId bel : ctx->getBels()) {
@@ -880,14 +755,34 @@ void Lookahead::build_lookahead(const Context *ctx, DeterministicRNG *rng)
         }
     }
 
+    uint64_t seed = rng->rng64();
+
     if (ctx->verbose) {
         log_info("Expanding input site wires\n");
     }
 
     // Expand backwards from each input site wire to find the cheapest
     // non-site wire.
+    std::vector<TypeWireId> input_wire_types;
     for (auto &input_pair : input_site_wires) {
-        expand_input_type(ctx, rng, tiles_of_type[input_pair.first.type], input_pair.first, &input_pair.second);
+        input_wire_types.push_back(input_pair.first);
+    }
+    auto input_costs = parallel_chunks<std::vector<std::vector<InputSiteWireCost>>>(
+            ctx, input_wire_types.size(), 64,
+            [&](int begin, int end, std::vector<std::vector<InputSiteWireCost>> &costs) {
+                costs.resize(end - begin);
+                for (int i = begin; i < end; ++i) {
+                    TypeWireId input_wire = input_wire_types.at(i);
+                    DeterministicRNG input_rng = wire_type_rng(seed, input_wire);
+                    expand_input_type(ctx, &input_rng, tiles_of_type[input_wire.type], input_wire,
+                                      &costs.at(i - begin));
+                }
+            });
+    size_t input_index = 0;
+    for (auto &chunk : input_costs) {
+        for (auto &costs : chunk) {
+            input_site_wires.at(input_wire_types.at(input_index++)) = std::move(costs);
+        }
     }
 
     if (ctx->verbose) {
@@ -896,40 +791,37 @@ void Lookahead::build_lookahead(const Context *ctx, DeterministicRNG *rng)
 
     // Expand forward from each output site wire to find the cheapest
     // non-site wire.
+    std::vector<TypeWireId> output_wire_types;
     for (auto &output_pair : output_site_wires) {
-        output_pair.second.cost = std::numeric_limits<delay_t>::max();
-        expand_output_type(ctx, rng, tiles_of_type[output_pair.first.type], output_pair.first, &output_pair.second,
-                           &site_to_site_cost);
+        output_wire_types.push_back(output_pair.first);
     }
+    size_t number_output_wires = output_wire_types.size();
     for (TypeWireId input_site_port : input_site_ports) {
-        expand_output_type(ctx, rng, tiles_of_type[input_site_port.type], input_site_port, nullptr, &site_to_site_cost);
-    }
-
-    if (ctx->verbose) {
-        log_info("Expanding all wire types\n");
-    }
-
-    DelayStorage all_tiles_storage;
-    all_tiles_storage.max_explore_depth = kInitialExploreDepth;
-
-    // These are wire types that have been explored.
-    pool<TypeWireSet> types_explored;
-
-    // These are wire types that have been deferred because they are trival
-    // copies of another wire type.  These can be cheaply computed after the
-    // graph has been explored.
-    pool<TypeWireId> types_deferred;
-
-    std::vector<int32_t> tile_types;
-    pool<int32_t> tiles_left;
-    tile_types.reserve(ctx->chip_info->tile_types.size());
-    for (int32_t tile_type = 0; tile_type < ctx->chip_info->tile_types.ssize(); ++tile_type) {
-        tile_types.push_back(tile_type);
-        tiles_left.emplace(tile_type);
+        output_wire_types.push_back(input_site_port);
+    }
+    auto output_shards = parallel_chunks<OutputExpandShard>(
+            ctx, output_wire_types.size(), 64, [&](int begin, int end, OutputExpandShard &shard) {
+                for (int i = begin; i < end; ++i) {
+                    TypeWireId output_wire = output_wire_types.at(i);
+                    DeterministicRNG output_rng = wire_type_rng(seed, output_wire);
+                    OutputSiteWireCost *output_cost = nullptr;
+                    if (size_t(i) < number_output_wires) {
+                        shard.output_costs.emplace_back();
+                        output_cost = &shard.output_costs.back();
+                        output_cost->cost = std::numeric_limits<delay_t>::max();
+                    }
+                    expand_output_type(ctx, &output_rng, tiles_of_type[output_wire.type], output_wire, output_cost,
+                                       &shard.site_to_site_cost);
+                }
+            });
+    size_t output_index = 0;
+    for (auto &shard : output_shards) {
+        for (auto &output_cost : shard.output_costs) {
+            output_site_wires.at(output_wire_types.at(output_index++)) = output_cost;
+        }
+        merge_min_costs(shard.site_to_site_cost, &site_to_site_cost);
     }
 
-    FlatWireMap<PipAndCost> best_path(ctx);
-
     // Walk each tile type, and expand all non-site wires in the tile.
     // Wires that are nodes will expand as if the node type is the first node
     // in the wire.
@@ -937,75 +829,91 @@ void Lookahead::build_lookahead(const Context *ctx, DeterministicRNG *rng)
     // Wires that only have 1 output pip are deferred until the next loop,
     // because generally those wires will get explored via another wire.
     // The deferred will be expanded if this assumption doesn't hold.
-    bool expand_serially = true;
-#if defined(NEXTPNR_USE_TBB) // Run parallely
-    {
-        std::mutex all_costs_mutex;
-
-        expand_serially = false;
-        tbb::parallel_for_each(tile_types, [&](int32_t tile_type) {
-            expand_tile_type_parallel(ctx, tile_type, tiles_of_type, rng, &all_costs_mutex, &all_tiles_storage,
-                                      &types_explored, &types_deferred, &tiles_left);
-        });
+    std::vector<TypeWireId> routing_wire_types;
+    for (int32_t tile_type = 0; tile_type < ctx->chip_info->tile_types.ssize(); ++tile_type) {
+        auto &type_data = ctx->chip_info->tile_types[tile_type];
+        for (size_t wire_index = 0; wire_index < type_data.wire_data.size(); ++wire_index) {
+            if (type_data.wire_data[wire_index].site != -1) {
+                // Skip site wires
+                continue;
+            }
+
+            TypeWireId wire;
+            wire.type = tile_type;
+            wire.index = wire_index;
+            routing_wire_types.push_back(wire);
+        }
     }
-#else
-    // Supress warning that expand_tile_type_parallel if not running in
-    // parallel.
-    (void)expand_tile_type_parallel;
-#endif
-    if (expand_serially) {
-        expand_tile_type_serial(ctx, tile_types, tiles_of_type, rng, &best_path, &all_tiles_storage, &types_explored,
-                                &types_deferred, &tiles_left);
+
+    log_info("Expanding %zu routing wire types...\n", routing_wire_types.size());
+
+    ExpandShard all_tiles;
+    all_tiles.storage.max_explore_depth = kInitialExploreDepth;
+    float expand_start = elapsed();
+
+    // Wire types are expanded in batches, with the shards of each batch merged (and progress reported) between them,
+    // which also bounds the memory used by the shards.
+    const int kMinWiresPerChunk = 16;
+    size_t batch_size = std::max<size_t>(routing_wire_types.size() / 20,
+                                         size_t(get_parallel_threads(ctx)) * kMinWiresPerChunk);
+    for (size_t batch_begin = 0; batch_begin < routing_wire_types.size(); batch_begin += batch_size) {
+        size_t batch_end = std::min(batch_begin + batch_size, routing_wire_types.size());
+        auto shards = parallel_chunks<ExpandShard>(
+                ctx, batch_end - batch_begin, kMinWiresPerChunk, [&](int begin, int end, ExpandShard &shard) {
+                    FlatWireMap<PipAndCost> best_path(ctx);
+                    shard.storage.max_explore_depth = kInitialExploreDepth;
+                    for (int i = begin; i < end; ++i) {
+                        TypeWireId wire = routing_wire_types.at(batch_begin + i);
+                        DeterministicRNG wire_rng = wire_type_rng(seed, wire);
+                        expand_routing_graph(ctx, &wire_rng, tiles_of_type[wire.type], wire, &shard.explored,
+                                             &shard.storage, &shard.deferred, &best_path);
+                    }
+                });
+        for (auto &shard : shards) {
+            merge_shard(shard, &all_tiles);
+        }
+
+        float done = float(batch_end) / routing_wire_types.size();
+        float expand_time = elapsed() - expand_start;
+        log_info("    %zu/%zu wire types expanded (%.0f%%), %.1fs elapsed, ETA %.1fs\n", batch_end,
+                 routing_wire_types.size(), 100.0f * done, expand_time, expand_time * (1.0f - done) / done);
     }
 
     // Check to see if deferred wire types were expanded.  If they were not
     // expanded, expand them now.  If they were expanded, copy_types is
     // populated with the wire types that can just copy the relevant data from
     // another wire type.
-    for (TypeWireId wire_type : types_deferred) {
+    FlatWireMap<PipAndCost> best_path(ctx);
+    for (TypeWireId wire_type : all_tiles.deferred) {
         auto &type_data = ctx->chip_info->tile_types[wire_type.type];
         auto &tile_sampler = tiles_of_type[wire_type.type];
         auto &wire_data = type_data.wire_data[wire_type.index];
 
-        if (ctx->verbose) {
+        if (ctx->debug) {
             log_info("Expanding deferred wire %s in type %s (seen %zu types)\n", IdString(wire_data.name).c_str(ctx),
-                     IdString(type_data.name).c_str(ctx), types_explored.size());
+                     IdString(type_data.name).c_str(ctx), all_tiles.explored.size());
         }
 
-        expand_deferred_routing_graph(ctx, rng, tile_sampler, wire_type, &types_explored, &all_tiles_storage,
-                                      &best_path);
+        DeterministicRNG wire_rng = wire_type_rng(seed, wire_type);
+        expand_deferred_routing_graph(ctx, &wire_rng, tile_sampler, wire_type, &all_tiles.explored,
+                                      &all_tiles.storage, &best_path);
     }
 
-    auto end = std::chrono::high_resolution_clock::now();
     if (ctx->verbose) {
-        log_info("Done with expansion, dt %02fs\n", std::chrono::duration<float>(end - start).count());
+        log_info("Done with expansion, dt %02fs\n", elapsed());
     }
 
     if (kWriteLookaheadCsv) {
-        write_lookahead_csv(ctx, all_tiles_storage);
-        end = std::chrono::high_resolution_clock::now();
+        write_lookahead_csv(ctx, all_tiles.storage);
         if (ctx->verbose) {
-            log_info("Done writing data to disk, dt %02fs\n", std::chrono::duration<float>(end - start).count());
+            log_info("Done writing data to disk, dt %02fs\n", elapsed());
         }
     }
 
-#if defined(NEXTPNR_USE_TBB) // Run parallely
-    tbb::parallel_for_each(all_tiles_storage.storage,
-                           [&](const std::pair<TypeWirePair, dict<std::pair<int32_t, int32_t>, delay_t>> &type_pair) {
-#else
-    for (const auto &type_pair : all_tiles_storage.storage) {
-#endif
-                               cost_map.set_cost_map(ctx, type_pair.first, type_pair.second);
-#if defined(NEXTPNR_USE_TBB) // Run parallely
-                           });
-#else
-    }
-#endif
+    cost_map.set_cost_maps(ctx, all_tiles.storage.storage);
 
-    end = std::chrono::high_resolution_clock::now();
-    if (ctx->verbose) {
-        log_info("build_lookahead time %.02fs\n", std::chrono::duration<float>(end - start).count());
-    }
+    log_info("Built router lookahead in %.02fs, %zu cost maps using %.1f MiB\n", elapsed(), cost_map.size(),
+             cost_map.memory_usage() / (1024.0 * 1024.0));
 }
 
 constexpr static bool kUseGzipForLookahead = false;
@@ -1015,60 +923,69 @@ static void write_message(::capnp::MallocMessageBuilder &message, const std::str
     kj::Array<capnp::word> words = messageToFlatArray(message);
     kj::ArrayPtr<kj::byte> bytes = words.asBytes();
 
-    boost::filesystem::path temp = boost::filesystem::unique_path();
+    // The tempfile is created next to the lookahead, as it can only be renamed into place on the same filesystem
+    boost::filesystem::path target(filename);
+    boost::filesystem::path temp = target.parent_path() / boost::filesystem::unique_path();
     log_info("Writing tempfile to %s\n", temp.c_str());
 
-    if (kUseGzipForLookahead) {
-        gzFile file = gzopen(temp.c_str(), "w");
-        NPNR_ASSERT(file != Z_NULL);
-
-        size_t bytes_written = 0;
-        int result;
-        while (bytes_written < bytes.size()) {
-            size_t bytes_remaining = bytes.size() - bytes_written;
-            size_t bytes_to_write = bytes_remaining;
-            if (bytes_to_write >= std::numeric_limits<int>::max()) {
-                bytes_to_write = std::numeric_limits<int>::max();
-            }
-            result = gzwrite(file, &bytes[0] + bytes_written, bytes_to_write);
-            if (result < 0) {
-                break;
-            }
-
-            bytes_written += result;
-        }
+    // The lookahead is only a cache, so if it can't be written (for example, if the chipdb directory is read-only) the
+    // run carries on without it
+    std::string error;
+    try {
+        if (kUseGzipForLookahead) {
+            gzFile file = gzopen(temp.c_str(), "w");
+            size_t bytes_written = 0;
+            int result = 0;
+            while (file != Z_NULL && bytes_written < bytes.size()) {
+                size_t bytes_remaining = bytes.size() - bytes_written;
+                size_t bytes_to_write = bytes_remaining;
+                if (bytes_to_write >= std::numeric_limits<int>::max()) {
+                    bytes_to_write = std::numeric_limits<int>::max();
+                }
+                result = gzwrite(file, &bytes[0] + bytes_written, bytes_to_write);
+                if (result <= 0) {
+                    break;
+                }
 
-        int error;
-        std::string error_str;
-        if (result < 0) {
-            error_str.assign(gzerror(file, &error));
-        }
-        NPNR_ASSERT(gzclose(file) == Z_OK);
-        if (bytes_written != bytes.size()) {
-            // Remove failed writes before reporting error.
-            boost::filesystem::remove(temp);
-        }
+                bytes_written += result;
+            }
 
-        if (result < 0) {
-            log_error("Failed to write lookahead, error from gzip %s\n", error_str.c_str());
-        } else {
-            if (bytes_written != bytes.size()) {
-                log_error("Failed to write lookahead, wrote %d bytes, had %zu bytes\n", result, bytes.size());
+            if (file == Z_NULL) {
+                error = "failed to create tempfile";
             } else {
-                // Written, move file into place
-                boost::filesystem::rename(temp, filename);
+                if (result < 0) {
+                    int gz_error;
+                    error = stringf("error from gzip %s", gzerror(file, &gz_error));
+                } else if (bytes_written != bytes.size()) {
+                    error = stringf("wrote %zu bytes, had %zu bytes", bytes_written, bytes.size());
+                }
+                if (gzclose(file) != Z_OK && error.empty()) {
+                    error = "failed to close tempfile";
+                }
             }
-        }
-    } else {
-        {
+        } else {
             kj::Own<kj::Filesystem> fs = kj::newDiskFilesystem();
 
-            auto path = kj::Path::parse(temp);
-            auto file = fs->getCurrent().openFile(path, kj::WriteMode::CREATE);
+            auto path = fs->getCurrentPath().evalNative(temp.string());
+            auto file = fs->getRoot().openFile(path, kj::WriteMode::CREATE);
             file->writeAll(bytes);
         }
 
-        boost::filesystem::rename(temp, filename);
+        if (error.empty()) {
+            // Written, move file into place
+            boost::filesystem::rename(temp, target);
+        }
+    } catch (const boost::filesystem::filesystem_error &e) {
+        error = e.what();
+    } catch (const kj::Exception &e) {
+        error = e.getDescription().cStr();
+    }
+
+    if (!error.empty()) {
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp, ec);
+        log_warning("Failed to write lookahead to %s (%s), it will be rebuilt on the next run.\n", filename.c_str(),
+                    error.c_str());
     }
 }
 
@@ -28,65 +28,116 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
-bool rotate_and_merge_lut_equation(std::vector<LogicLevel> *result, const LutBel &lut_bel,
-                                   const DynamicBitarray<> &old_equation, const std::vector<int32_t> &pin_map,
-                                   uint32_t used_pins)
-{
-    // pin_map maps pin indicies from the old pin to the new pin.
-    // So a reversal of a LUT4 would have a pin map of:
-    // pin_map[0] = 3;
-    // pin_map[1] = 2;
-    // pin_map[2] = 1;
-    // pin_map[3] = 0;
+// Truth tables of the LUT inputs: bit a is set when input i is high at address a.
+static constexpr uint64_t kInputMask[6] = {
+        0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull,
+};
 
-    size_t bel_width = 1 << lut_bel.pins.size();
-    for (size_t bel_address = 0; bel_address < bel_width; ++bel_address) {
-        bool address_reachable = true;
-        size_t cell_address = 0;
-        for (size_t bel_pin_idx = 0; bel_pin_idx < lut_bel.pins.size(); ++bel_pin_idx) {
-            // This address line is 0, so don't translate this bit to the cell
-            // address.
-            if ((bel_address & (1 << bel_pin_idx)) == 0) {
-                if ((used_pins & (1 << bel_pin_idx)) == 0) {
-                    address_reachable = false;
-                    break;
-                }
+// Mask of the addresses of a LUT with num_pins inputs.
+static uint64_t address_mask(size_t num_pins) { return num_pins >= 6 ? ~0ull : (1ull << (1 << num_pins)) - 1; }
 
-                continue;
-            }
+// Exchanges inputs i < j of a truth table.
+static uint64_t swap_lut_inputs(uint64_t table, size_t i, size_t j)
+{
+    size_t shift = (1 << j) - (1 << i);
+    uint64_t diff = (table ^ (table >> shift)) & kInputMask[i] & ~kInputMask[j];
+    return table ^ diff ^ (diff << shift);
+}
 
-            auto cell_pin_idx = pin_map[bel_pin_idx];
+uint64_t lut_equation_word(const DynamicBitarray<> &equation)
+{
+    uint64_t word = 0;
+    size_t bits = std::min<size_t>(equation.size(), 64);
+    for (size_t bit = 0; bit < bits; ++bit) {
+        if (equation.get(bit)) {
+            word |= 1ull << bit;
+        }
+    }
+    return word;
+}
 
-            // Is this BEL pin used for this cell?
-            if (cell_pin_idx < 0) {
-                // This BEL pin is not used for the LUT cell, skip
-                continue;
-            }
+// Rotates a cell equation onto the BEL addresses of lut_bel, and returns it
+// shifted into its place in the element equation.
+static LutEquation rotate_lut_equation(const LutBel &lut_bel, uint64_t cell_equation,
+                                       const std::vector<int32_t> &pin_map, uint32_t used_pins)
+{
+    size_t num_pins = lut_bel.pins.size();
+
+    // Cell pins beyond the last one on a BEL pin are tied low, so only the
+    // low part of the cell equation is reachable.
+    size_t cell_pins = 0;
+    uint32_t mapped_cell_pins = 0;
+    for (size_t bel_pin_idx = 0; bel_pin_idx < num_pins; ++bel_pin_idx) {
+        if (pin_map[bel_pin_idx] >= 0) {
+            cell_pins = std::max(cell_pins, size_t(pin_map[bel_pin_idx] + 1));
+            mapped_cell_pins |= (1 << pin_map[bel_pin_idx]);
+        }
+    }
+    NPNR_ASSERT(cell_pins <= 6);
+
+    // Make the table 64 bits wide, so that it doesn't depend on the inputs
+    // beyond cell_pins.
+    uint64_t table = cell_equation & address_mask(cell_pins);
+    for (size_t width = size_t(1) << cell_pins; width < 64; width *= 2) {
+        table |= table << width;
+    }
 
-            cell_address |= (1 << cell_pin_idx);
+    // Tie the other cell pins low.
+    for (size_t cell_pin_idx = 0; cell_pin_idx < cell_pins; ++cell_pin_idx) {
+        if ((mapped_cell_pins & (1 << cell_pin_idx)) == 0) {
+            uint64_t low = table & ~kInputMask[cell_pin_idx];
+            table = low | (low << (1 << cell_pin_idx));
         }
+    }
 
-        if (!address_reachable) {
+    // Move each cell pin input to its BEL pin.  input_at[i] is the cell pin
+    // currently at input i.  The inputs left on unused BEL pins are ones the
+    // table doesn't depend on.
+    int32_t input_at[6] = {0, 1, 2, 3, 4, 5};
+    for (size_t bel_pin_idx = 0; bel_pin_idx < num_pins; ++bel_pin_idx) {
+        int32_t cell_pin_idx = pin_map[bel_pin_idx];
+        if (cell_pin_idx < 0 || input_at[bel_pin_idx] == cell_pin_idx) {
             continue;
         }
+        size_t from = std::find(input_at, input_at + 6, cell_pin_idx) - input_at;
+        table = swap_lut_inputs(table, std::min(bel_pin_idx, from), std::max(bel_pin_idx, from));
+        std::swap(input_at[bel_pin_idx], input_at[from]);
+    }
 
-        bel_address += lut_bel.low_bit;
-        if (old_equation.get(cell_address)) {
-            if ((*result)[bel_address] == LL_Zero) {
-                // Output equation has a conflict!
-                return false;
-            }
-
-            (*result)[bel_address] = LL_One;
-        } else {
-            if ((*result)[bel_address] == LL_One) {
-                // Output equation has a conflict!
-                return false;
-            }
-            (*result)[bel_address] = LL_Zero;
+    // Unused BEL pins are tied high, so addresses where they are low are
+    // unreachable.
+    uint64_t reachable = address_mask(num_pins);
+    for (size_t bel_pin_idx = 0; bel_pin_idx < num_pins; ++bel_pin_idx) {
+        if ((used_pins & (1 << bel_pin_idx)) == 0) {
+            reachable &= kInputMask[bel_pin_idx];
         }
     }
 
+    LutEquation rotated;
+    rotated.care = reachable << lut_bel.low_bit;
+    rotated.value = (table & reachable) << lut_bel.low_bit;
+    return rotated;
+}
+
+bool rotate_and_merge_lut_equation(LutEquation *result, const LutBel &lut_bel, uint64_t old_equation,
+                                   const std::vector<int32_t> &pin_map, uint32_t used_pins)
+{
+    // pin_map maps pin indicies from the old pin to the new pin.
+    // So a reversal of a LUT4 would have a pin map of:
+    // pin_map[0] = 3;
+    // pin_map[1] = 2;
+    // pin_map[2] = 1;
+    // pin_map[3] = 0;
+    LutEquation rotated = rotate_lut_equation(lut_bel, old_equation, pin_map, used_pins);
+
+    if ((result->care & rotated.care & (result->value ^ rotated.value)) != 0) {
+        // Output equation has a conflict!
+        return false;
+    }
+
+    result->value |= rotated.value;
+    result->care |= rotated.care;
     return true;
 }
 
@@ -198,13 +249,16 @@ uint32_t LutMapper::check_wires(const std::vector<std::vector<int32_t>> &bel_to_
 
     uint32_t pin_mask = 0;
 
-    DynamicBitarray<> wire_equation;
-    wire_equation.resize(2);
-    wire_equation.set(0, false);
-    wire_equation.set(1, true);
+    // The wire is a LUT1 buffer
+    const uint64_t wire_equation = 0x2;
+
+    std::vector<uint64_t> cell_equations(cells.size());
+    for (size_t cell_idx = 0; cell_idx < cells.size(); ++cell_idx) {
+        cell_equations[cell_idx] = lut_equation_word(cells[cell_idx]->lut_cell.equation);
+    }
 
     std::vector<int32_t> wire_bel_to_cell_pin_map;
-    std::vector<LogicLevel> equation_result;
+    LutEquation equation_result;
     for (int32_t pin_idx = 0; pin_idx < (int32_t)element.pins.size(); ++pin_idx) {
         if (used_pins & (1 << pin_idx)) {
             // This pin is already used, so it cannot be used for a wire.
@@ -227,15 +281,13 @@ uint32_t LutMapper::check_wires(const std::vector<std::vector<int32_t>> &bel_to_
             wire_bel_to_cell_pin_map.resize(lut_bel->pins.size(), -1);
             wire_bel_to_cell_pin_map[lut_bel->pin_to_index.at(element.pins[pin_idx])] = 0;
 
-            equation_result.clear();
-            equation_result.resize(element.width, LL_DontCare);
+            equation_result = LutEquation();
 
             uint32_t used_pins_with_wire = used_pins | (1 << pin_idx);
 
             for (size_t cell_idx = 0; cell_idx < cells.size(); ++cell_idx) {
-                const CellInfo *cell = cells[cell_idx];
                 auto &lut_bel_for_cell = *lut_bels[cell_idx];
-                if (!rotate_and_merge_lut_equation(&equation_result, lut_bel_for_cell, cell->lut_cell.equation,
+                if (!rotate_and_merge_lut_equation(&equation_result, lut_bel_for_cell, cell_equations[cell_idx],
                                                    bel_to_cell_pin_remaps[cell_idx], used_pins_with_wire)) {
                     invalid_pin_for_wire = true;
                     break;
@@ -348,12 +400,11 @@ bool LutMapper::remap_luts(const Context *ctx, SiteLutMappingResult *lut_mapping
     }
 
     // Try to see if the equations are mergable!
-    std::vector<LogicLevel> equation_result;
-    equation_result.resize(element.width, LL_DontCare);
+    LutEquation equation_result;
     for (size_t cell_idx = 0; cell_idx < cells.size(); ++cell_idx) {
         const CellInfo *cell = cells[cell_idx];
         auto &lut_bel = *lut_bels[cell_idx];
-        if (!rotate_and_merge_lut_equation(&equation_result, lut_bel, cell->lut_cell.equation,
+        if (!rotate_and_merge_lut_equation(&equation_result, lut_bel, lut_equation_word(cell->lut_cell.equation),
                                            bel_to_cell_pin_remaps[cell_idx], used_pins)) {
 #ifdef DEBUG_LUT_ROTATION
             log_info("Failed to find a solution!\n");
@@ -461,13 +512,11 @@ bool LutMapper::remap_luts(const Context *ctx, SiteLutMappingResult *lut_mapping
 }
 
 void check_equation(const LutCell &lut_cell, const dict<IdString, IdString> &cell_to_bel_map, const LutBel &lut_bel,
-                    const std::vector<LogicLevel> &equation, uint32_t used_pins)
+                    const LutEquation &equation, uint32_t used_pins)
 {
-    std::vector<int8_t> pin_map;
+    std::vector<int32_t> pin_map;
     pin_map.resize(lut_bel.pins.size(), -1);
 
-    NPNR_ASSERT(lut_cell.pins.size() < (size_t)std::numeric_limits<decltype(pin_map)::value_type>::max());
-
     for (size_t cell_pin_idx = 0; cell_pin_idx < lut_cell.pins.size(); ++cell_pin_idx) {
         IdString cell_pin = lut_cell.pins[cell_pin_idx];
         IdString bel_pin = cell_to_bel_map.at(cell_pin);
@@ -476,49 +525,12 @@ void check_equation(const LutCell &lut_cell, const dict<IdString, IdString> &cel
         pin_map[bel_pin_idx] = cell_pin_idx;
     }
 
-    // Iterate over all BEL addresses in the LUT, and ensure that the original
-    // LUT equation is respected.
-    size_t bel_width = 1 << lut_bel.pins.size();
-    NPNR_ASSERT(lut_bel.low_bit + bel_width == lut_bel.high_bit + 1);
-    for (size_t bel_address = 0; bel_address < bel_width; ++bel_address) {
-        LogicLevel level = equation[bel_address + lut_bel.low_bit];
-
-        bool address_reachable = true;
-        size_t cell_address = 0;
-        for (size_t bel_pin_idx = 0; bel_pin_idx < lut_bel.pins.size(); ++bel_pin_idx) {
-            // This address line is 0, so don't translate this bit to the cell
-            // address.
-            if ((bel_address & (1 << bel_pin_idx)) == 0) {
-                // This pin is unused, so the line will be tied high, this
-                // address is unreachable.
-                if ((used_pins & (1 << bel_pin_idx)) == 0) {
-                    address_reachable = false;
-                    break;
-                }
-                continue;
-            }
-
-            auto cell_pin_idx = pin_map[bel_pin_idx];
-
-            // Is this BEL pin used for this cell?
-            if (cell_pin_idx < 0) {
-                // This BEL pin is not used for the LUT cell, skip
-                continue;
-            }
-
-            cell_address |= (1 << cell_pin_idx);
-        }
-
-        if (!address_reachable) {
-            continue;
-        }
-
-        if (lut_cell.equation.get(cell_address)) {
-            NPNR_ASSERT(level == LL_One);
-        } else {
-            NPNR_ASSERT(level == LL_Zero);
-        }
-    }
+    // Ensure that the original LUT equation is respected at every reachable
+    // BEL address.
+    NPNR_ASSERT(lut_bel.low_bit + (1 << lut_bel.pins.size()) == lut_bel.high_bit + 1);
+    LutEquation expected = rotate_lut_equation(lut_bel, lut_equation_word(lut_cell.equation), pin_map, used_pins);
+    NPNR_ASSERT((equation.care & expected.care) == expected.care);
+    NPNR_ASSERT(((equation.value ^ expected.value) & expected.care) == 0);
 }
 
 void LutElement::compute_pin_order()
@@ -33,13 +33,20 @@ struct Context;
 
 struct SiteLutMappingResult;
 
-enum LogicLevel
+// The equation of a LUT element, one bit per address.  Addresses that are
+// clear in care are not constrained by any LUT cell yet.
+//
+// Elements (and so LUT BELs) are at most 64 bits wide, which is checked
+// when the chipdb is loaded.
+struct LutEquation
 {
-    LL_Zero,
-    LL_One,
-    LL_DontCare
+    uint64_t value = 0;
+    uint64_t care = 0;
 };
 
+// Returns the (at most 64 bit) truth table of a LUT cell equation.
+uint64_t lut_equation_word(const DynamicBitarray<> &equation);
+
 struct LutCell
 {
     enum class PinConnection
@@ -90,7 +97,7 @@ struct SiteLutMapping
 // Work forward from cell definition and cell -> bel pin map and check that
 // equation is valid.
 void check_equation(const LutCell &lut_cell, const dict<IdString, IdString> &cell_to_bel_map, const LutBel &lut_bel,
-                    const std::vector<LogicLevel> &equation, uint32_t used_pins);
+                    const LutEquation &equation, uint32_t used_pins);
 
 struct LutElement
 {
@@ -127,12 +134,16 @@ struct LutMapper
     uint32_t check_wires(const Context *ctx) const;
 };
 
-// Rotate and merge a LUT equation into an array of levels.
+// Rotate a LUT cell equation (see lut_equation_word) onto a LUT BEL and merge
+// it into the element equation.
+//
+// pin_map maps BEL pin indicies to cell pin indicies, -1 for BEL pins that
+// are not used by the cell.  BEL pins outside used_pins are tied high, so
+// addresses where they are low are not constrained.
 //
-// If a conflict arises, return false and result is in an indeterminate state.
-bool rotate_and_merge_lut_equation(std::vector<LogicLevel> *result, const LutBel &lut_bel,
-                                   const DynamicBitarray<> &old_equation, const std::vector<size_t> &pin_map,
-                                   uint32_t used_pins);
+// If a conflict arises, return false and result is unchanged.
+bool rotate_and_merge_lut_equation(LutEquation *result, const LutBel &lut_bel, uint64_t old_equation,
+                                   const std::vector<int32_t> &pin_map, uint32_t used_pins);
 
 NEXTPNR_NAMESPACE_END
 
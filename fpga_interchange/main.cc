@@ -57,7 +57,14 @@ po::options_description FpgaInterchangeCommandHandler::getArchOptions()
     specific.add_options()("package", po::value<std::string>(), "Package to use");
     specific.add_options()("rebuild-lookahead", "Ignore lookahead cache and rebuild");
     specific.add_options()("dont-write-lookahead", "Don't write the lookahead file");
+    specific.add_options()("disable-lookahead", "Use a simple distance based delay estimate instead of the lookahead");
     specific.add_options()("disable-lut-mapping-cache", "Disable caching of LUT mapping solutions in site router");
+    specific.add_options()("site-cache-size", po::value<int>(),
+                           "Memory limit in MiB of each of the site router caches (default: 512)");
+    specific.add_options()("site-cache", po::value<std::string>(),
+                           "File to load site routing and LUT mapping solutions from, and save them to");
+    specific.add_options()("incremental-site-routing",
+                           "Keep the previous routes of a site when re-checking it (experimental)");
 
     return specific;
 }
@@ -75,9 +82,19 @@ std::unique_ptr<Context> FpgaInterchangeCommandHandler::createContext(dict<std::
     auto start = std::chrono::high_resolution_clock::now();
 
     ArchArgs chipArgs;
-    chipArgs.rebuild_lookahead = vm.count("rebuild_lookahead") != 0;
-    chipArgs.dont_write_lookahead = vm.count("dont_write_lookahead") != 0;
+    chipArgs.rebuild_lookahead = vm.count("rebuild-lookahead") != 0;
+    chipArgs.dont_write_lookahead = vm.count("dont-write-lookahead") != 0;
+    chipArgs.disable_lookahead = vm.count("disable-lookahead") != 0;
     chipArgs.disable_lut_mapping_cache = vm.count("disable-lut-mapping-cache") != 0;
+    chipArgs.incremental_site_routing = vm.count("incremental-site-routing") != 0;
+    if (vm.count("site-cache-size")) {
+        chipArgs.site_cache_mb = vm["site-cache-size"].as<int>();
+        if (chipArgs.site_cache_mb < 0)
+            log_error("Site cache size must not be negative, got %d MiB.\n", chipArgs.site_cache_mb);
+    }
+    if (vm.count("site-cache")) {
+        chipArgs.site_cache = vm["site-cache"].as<std::string>();
+    }
 
     if (!vm.count("chipdb")) {
         log_error("chip database binary must be provided\n");
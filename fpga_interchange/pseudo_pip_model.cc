@@ -20,6 +20,8 @@
 
 #include "pseudo_pip_model.h"
 
+#include <algorithm>
+
 #include "context.h"
 
 // #define DEBUG_PSEUDO_PIP
@@ -28,22 +30,41 @@ NEXTPNR_NAMESPACE_BEGIN
 
 void PseudoPipData::init_tile_type(const Context *ctx, int32_t tile_type)
 {
-    if (max_pseudo_pip_for_tile_type.count(tile_type)) {
+    if (tile_types.size() <= size_t(tile_type)) {
+        tile_types.resize(ctx->chip_info->tile_types.size());
+    }
+    TileTypeData &data = tile_types.at(tile_type);
+    if (data.initialized) {
         return;
     }
+    data.initialized = true;
 
     const TileTypeInfoPOD &type_data = ctx->chip_info->tile_types[tile_type];
     int32_t max_pseudo_pip_index = -1;
     for (int32_t pip_idx = 0; pip_idx < type_data.pip_data.ssize(); ++pip_idx) {
+        if (type_data.pip_data[pip_idx].pseudo_cell_wires.size() != 0) {
+            max_pseudo_pip_index = pip_idx;
+        }
+    }
+
+    data.max_pseudo_pip = max_pseudo_pip_index;
+    data.site_offsets.reserve(max_pseudo_pip_index + 2);
+    data.bel_site_offsets.reserve(max_pseudo_pip_index + 2);
+    data.site_offsets.push_back(0);
+    data.bel_site_offsets.push_back(0);
+    data.bel_offsets.push_back(0);
+
+    // Pips are visited in order, so each pip appends its entries to the flat
+    // arrays.
+    std::vector<std::pair<int32_t, PseudoPipBel>> site_bels;
+    for (int32_t pip_idx = 0; pip_idx <= max_pseudo_pip_index; ++pip_idx) {
         const PipInfoPOD &pip_data = type_data.pip_data[pip_idx];
         if (pip_data.pseudo_cell_wires.size() == 0) {
+            data.site_offsets.push_back(data.sites.size());
+            data.bel_site_offsets.push_back(data.bel_sites.size());
             continue;
         }
 
-        if (pip_idx > max_pseudo_pip_index) {
-            max_pseudo_pip_index = pip_idx;
-        }
-
         pool<size_t> sites;
         std::vector<PseudoPipBel> pseudo_pip_bels;
         for (int32_t wire_index : pip_data.pseudo_cell_wires) {
@@ -97,17 +118,16 @@ void PseudoPipData::init_tile_type(const Context *ctx, int32_t tile_type)
             }
         }
 
-        std::pair<int32_t, int32_t> key{tile_type, pip_idx};
-        std::vector<size_t> &sites_for_pseudo_pip = possibles_sites_for_pip[key];
-        sites_for_pseudo_pip.clear();
-        sites_for_pseudo_pip.insert(sites_for_pseudo_pip.begin(), sites.begin(), sites.end());
-        std::sort(sites_for_pseudo_pip.begin(), sites_for_pseudo_pip.end());
-
-        // Initialize "logic_bels_for_pip" for every site that this pseudo pip
-        // appears.  This means that if there are no pseudo_pip_bels, those
-        // vectors will be empty.
-        for (int32_t site : sites_for_pseudo_pip) {
-            logic_bels_for_pip[LogicBelKey{tile_type, pip_idx, site}].clear();
+        size_t sites_begin = data.sites.size();
+        data.sites.insert(data.sites.end(), sites.begin(), sites.end());
+        std::sort(data.sites.begin() + sites_begin, data.sites.end());
+        data.site_offsets.push_back(data.sites.size());
+
+        // There is a (possibly empty) list of logic BELs for every site that
+        // this pseudo pip appears in.
+        site_bels.clear();
+        for (size_t i = sites_begin; i < data.sites.size(); ++i) {
+            site_bels.emplace_back(data.sites[i], PseudoPipBel{-1, -1, -1});
         }
 
         if (!pseudo_pip_bels.empty()) {
@@ -147,27 +167,60 @@ void PseudoPipData::init_tile_type(const Context *ctx, int32_t tile_type)
                 NPNR_ASSERT(output_bel_pin == bel.output_bel_pin);
                 bel.input_bel_pin = input_bel_pin;
 
-                logic_bels_for_pip[LogicBelKey{tile_type, pip_idx, site}].push_back(bel);
+                site_bels.emplace_back(site, bel);
             }
         }
-    }
 
-    max_pseudo_pip_for_tile_type[tile_type] = max_pseudo_pip_index;
+        // Group the BELs by site, keeping their order within each site. The
+        // placeholder entries (bel_index -1) sort first and only mark that
+        // the site has a list.
+        std::stable_sort(site_bels.begin(), site_bels.end(),
+                         [](const std::pair<int32_t, PseudoPipBel> &a, const std::pair<int32_t, PseudoPipBel> &b) {
+                             return a.first < b.first || (a.first == b.first && a.second.bel_index == -1 &&
+                                                          b.second.bel_index != -1);
+                         });
+        for (const auto &site_bel : site_bels) {
+            if (data.bel_sites.size() == data.bel_site_offsets.back() || data.bel_sites.back() != site_bel.first) {
+                data.bel_sites.push_back(site_bel.first);
+                data.bel_offsets.push_back(data.bels.size());
+            }
+            if (site_bel.second.bel_index != -1) {
+                data.bels.push_back(site_bel.second);
+                data.bel_offsets.back() = data.bels.size();
+            }
+        }
+        data.bel_site_offsets.push_back(data.bel_sites.size());
+    }
 }
 
-const std::vector<size_t> &PseudoPipData::get_possible_sites_for_pip(const Context *ctx, PipId pip) const
+PseudoPipRange<size_t> PseudoPipData::get_possible_sites_for_pip(const Context *ctx, PipId pip) const
 {
-    int32_t tile_type = ctx->chip_info->tiles[pip.tile].type;
-    return possibles_sites_for_pip.at(std::make_pair(tile_type, pip.index));
+    const TileTypeData &data = tile_types.at(ctx->chip_info->tiles[pip.tile].type);
+    NPNR_ASSERT(pip.index <= data.max_pseudo_pip);
+
+    PseudoPipRange<size_t> range;
+    range.b = data.sites.data() + data.site_offsets[pip.index];
+    range.e = data.sites.data() + data.site_offsets[pip.index + 1];
+    return range;
 }
 
-size_t PseudoPipData::get_max_pseudo_pip(int32_t tile_type) const { return max_pseudo_pip_for_tile_type.at(tile_type); }
+size_t PseudoPipData::get_max_pseudo_pip(int32_t tile_type) const { return tile_types.at(tile_type).max_pseudo_pip; }
 
-const std::vector<PseudoPipBel> &PseudoPipData::get_logic_bels_for_pip(const Context *ctx, int32_t site,
-                                                                       PipId pip) const
+PseudoPipRange<PseudoPipBel> PseudoPipData::get_logic_bels_for_pip(const Context *ctx, int32_t site, PipId pip) const
 {
-    int32_t tile_type = ctx->chip_info->tiles[pip.tile].type;
-    return logic_bels_for_pip.at(LogicBelKey{tile_type, pip.index, site});
+    const TileTypeData &data = tile_types.at(ctx->chip_info->tiles[pip.tile].type);
+    NPNR_ASSERT(pip.index <= data.max_pseudo_pip);
+
+    auto sites_begin = data.bel_sites.begin() + data.bel_site_offsets[pip.index];
+    auto sites_end = data.bel_sites.begin() + data.bel_site_offsets[pip.index + 1];
+    auto found = std::lower_bound(sites_begin, sites_end, site);
+    NPNR_ASSERT(found != sites_end && *found == site);
+
+    size_t idx = found - data.bel_sites.begin();
+    PseudoPipRange<PseudoPipBel> range;
+    range.b = data.bels.data() + data.bel_offsets[idx];
+    range.e = data.bels.data() + data.bel_offsets[idx + 1];
+    return range;
 }
 
 void PseudoPipModel::init(Context *ctx, int32_t tile_idx)
@@ -209,7 +262,8 @@ void PseudoPipModel::prepare_for_routing(const Context *ctx, const std::vector<S
         PipId pip;
         pip.tile = tile;
         pip.index = pip_idx;
-        const std::vector<size_t> &sites = ctx->pseudo_pip_data.get_possible_sites_for_pip(ctx, pip);
+        PseudoPipRange<size_t> sites = ctx->pseudo_pip_data.get_possible_sites_for_pip(ctx, pip);
+        NPNR_ASSERT(!sites.empty());
 
         int32_t site_for_pip = -1;
         for (size_t possible_site : sites) {
@@ -220,7 +274,7 @@ void PseudoPipModel::prepare_for_routing(const Context *ctx, const std::vector<S
         }
 
         if (site_for_pip < 0) {
-            site_for_pip = sites.at(0);
+            site_for_pip = *sites.begin();
         }
 
         pseudo_pip_sites[pip_idx] = site_for_pip;
@@ -427,7 +481,7 @@ void PseudoPipModel::update_site(const Context *ctx, size_t site)
         pip.index = pseudo_pip;
 
         bool blocked_by_bel = false;
-        const std::vector<PseudoPipBel> &bels = ctx->pseudo_pip_data.get_logic_bels_for_pip(ctx, site, pip);
+        PseudoPipRange<PseudoPipBel> bels = ctx->pseudo_pip_data.get_logic_bels_for_pip(ctx, site, pip);
         for (const PseudoPipBel &bel : bels) {
             if (tile_status.boundcells[bel.bel_index] != nullptr) {
                 blocked_by_bel = true;
@@ -21,7 +21,7 @@
 #ifndef PSEUDO_PIP_MODEL_H
 #define PSEUDO_PIP_MODEL_H
 
-#include <tuple>
+#include <vector>
 
 #include "dynamic_bitarray.h"
 #include "nextpnr_namespaces.h"
@@ -46,19 +46,16 @@ struct PseudoPipBel
     int32_t output_bel_pin;
 };
 
-struct LogicBelKey
+// A view of part of one of the flat arrays in PseudoPipData.
+template <typename T> struct PseudoPipRange
 {
-    int32_t tile_type;
-    int32_t pip_index;
-    int32_t site;
+    const T *b = nullptr;
+    const T *e = nullptr;
 
-    std::tuple<int32_t, int32_t, int32_t> make_tuple() const { return std::make_tuple(tile_type, pip_index, site); }
-
-    bool operator==(const LogicBelKey &other) const { return make_tuple() == other.make_tuple(); }
-
-    bool operator<(const LogicBelKey &other) const { return make_tuple() < other.make_tuple(); }
-
-    unsigned int hash() const { return mkhash(mkhash(tile_type, pip_index), site); }
+    const T *begin() const { return b; }
+    const T *end() const { return e; }
+    size_t size() const { return e - b; }
+    bool empty() const { return b == e; }
 };
 
 // Storage for tile type generic pseudo pip data and lookup.
@@ -71,16 +68,35 @@ struct PseudoPipData
     size_t get_max_pseudo_pip(int32_t tile_type) const;
 
     // Get the list of possible sites that a pseudo pip might be used in.
-    const std::vector<size_t> &get_possible_sites_for_pip(const Context *ctx, PipId pip) const;
+    PseudoPipRange<size_t> get_possible_sites_for_pip(const Context *ctx, PipId pip) const;
 
     // Get list of BELs the pseudo pip uses, and how it routes through them.
     //
     // This does **not** include site ports or site pips.
-    const std::vector<PseudoPipBel> &get_logic_bels_for_pip(const Context *ctx, int32_t site, PipId pip) const;
-
-    dict<int32_t, size_t> max_pseudo_pip_for_tile_type;
-    dict<std::pair<int32_t, int32_t>, std::vector<size_t>> possibles_sites_for_pip;
-    dict<LogicBelKey, std::vector<PseudoPipBel>> logic_bels_for_pip;
+    PseudoPipRange<PseudoPipBel> get_logic_bels_for_pip(const Context *ctx, int32_t site, PipId pip) const;
+
+    // Pseudo pip data of a tile type, in flat arrays indexed by pip index.
+    struct TileTypeData
+    {
+        bool initialized = false;
+        int32_t max_pseudo_pip = -1;
+
+        // The possible sites of pip i are
+        // sites[site_offsets[i]..site_offsets[i + 1]], sorted.
+        std::vector<uint32_t> site_offsets;
+        std::vector<size_t> sites;
+
+        // The sites that pip i has logic BEL lists for are
+        // bel_sites[bel_site_offsets[i]..bel_site_offsets[i + 1]], sorted,
+        // and the BELs for bel_sites[j] are
+        // bels[bel_offsets[j]..bel_offsets[j + 1]].
+        std::vector<uint32_t> bel_site_offsets;
+        std::vector<int32_t> bel_sites;
+        std::vector<uint32_t> bel_offsets;
+        std::vector<PseudoPipBel> bels;
+    };
+
+    std::vector<TileTypeData> tile_types;
 };
 
 // Tile instance fast pseudo pip lookup.
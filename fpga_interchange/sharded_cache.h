@@ -0,0 +1,218 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SHARDED_CACHE_H
+#define SHARDED_CACHE_H
+
+#include <array>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "hashlib.h"
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct CacheStats
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t count = 0;
+    size_t bytes = 0;
+
+    float miss_ratio() const { return (hits + misses) == 0 ? 0.0f : float(misses) / float(hits + misses); }
+};
+
+// A cache with a memory limit, that can be used from several threads at once.
+//
+// Entries are split between shards by hash, and each shard has its own lock
+// and its own share of the memory limit. When a shard is over its limit,
+// entries are evicted using CLOCK (an approximation of LRU): reading an entry
+// sets its referenced bit, and the clock hand clears referenced bits until it
+// finds an entry that has not been read since the hand last passed it.
+//
+// TSize()(key, value) gives the approximate memory used by an entry, in bytes.
+template <typename Key, typename Value, typename TSize> class ShardedCache
+{
+  public:
+    static constexpr size_t kNumShards = 16;
+
+    void set_max_bytes(size_t max_bytes)
+    {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.max_bytes = max_bytes / kNumShards;
+            shard.evict();
+        }
+    }
+
+    // Copies the entry into *value, returns false if the key isn't cached.
+    bool get(const Key &key, Value *value)
+    {
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto iter = shard.index.find(key);
+        if (iter == shard.index.end()) {
+            shard.stats.misses += 1;
+            return false;
+        }
+
+        shard.stats.hits += 1;
+        Slot &slot = shard.slots.at(iter->second);
+        slot.referenced = true;
+        *value = slot.value;
+        return true;
+    }
+
+    void add(const Key &key, const Value &value)
+    {
+        size_t bytes = TSize()(key, value);
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto iter = shard.index.find(key);
+        if (iter != shard.index.end()) {
+            Slot &slot = shard.slots.at(iter->second);
+            shard.stats.bytes -= slot.bytes;
+            slot.value = value;
+            slot.bytes = bytes;
+            slot.referenced = true;
+        } else {
+            size_t index;
+            if (!shard.free_slots.empty()) {
+                index = shard.free_slots.back();
+                shard.free_slots.pop_back();
+            } else {
+                index = shard.slots.size();
+                shard.slots.emplace_back();
+            }
+
+            Slot &slot = shard.slots.at(index);
+            slot.key = key;
+            slot.value = value;
+            slot.bytes = bytes;
+            slot.used = true;
+            // New entries get one pass of the clock hand before they can be
+            // evicted.
+            slot.referenced = true;
+            shard.index.emplace(key, index);
+            shard.stats.count += 1;
+        }
+        shard.stats.bytes += bytes;
+        shard.evict();
+    }
+
+    // Removes all entries and resets the counters.
+    void clear()
+    {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.index.clear();
+            shard.slots.clear();
+            shard.free_slots.clear();
+            shard.hand = 0;
+            shard.stats = CacheStats();
+        }
+    }
+
+    // Calls func(key, value) for each entry. The shard being visited is
+    // locked, so func must not use the cache.
+    template <typename TFunc> void for_each(TFunc func) const
+    {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const Slot &slot : shard.slots) {
+                if (slot.used) {
+                    func(slot.key, slot.value);
+                }
+            }
+        }
+    }
+
+    CacheStats stats() const
+    {
+        CacheStats total;
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.hits += shard.stats.hits;
+            total.misses += shard.stats.misses;
+            total.evictions += shard.stats.evictions;
+            total.count += shard.stats.count;
+            total.bytes += shard.stats.bytes;
+        }
+        return total;
+    }
+
+  private:
+    struct Slot
+    {
+        Key key;
+        Value value;
+        size_t bytes = 0;
+        bool used = false;
+        bool referenced = false;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        dict<Key, size_t> index;
+        std::vector<Slot> slots;
+        std::vector<size_t> free_slots;
+        size_t hand = 0;
+        size_t max_bytes = std::numeric_limits<size_t>::max();
+        CacheStats stats;
+
+        void evict()
+        {
+            while (stats.bytes > max_bytes && !index.empty()) {
+                if (hand >= slots.size()) {
+                    hand = 0;
+                }
+                Slot &slot = slots.at(hand);
+                if (slot.used && slot.referenced) {
+                    slot.referenced = false;
+                } else if (slot.used) {
+                    index.erase(slot.key);
+                    stats.bytes -= slot.bytes;
+                    stats.count -= 1;
+                    stats.evictions += 1;
+                    slot = Slot();
+                    free_slots.push_back(hand);
+                }
+                ++hand;
+            }
+        }
+    };
+
+    std::array<Shard, kNumShards> shards_;
+
+    Shard &shard_for(const Key &key)
+    {
+        // Mix the hash first, as the dict in each shard also uses its low bits
+        unsigned int hash = hash_ops<Key>::hash(key) * 0x9E3779B1u;
+        return shards_[(hash >> 16) % kNumShards];
+    }
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* SHARDED_CACHE_H */
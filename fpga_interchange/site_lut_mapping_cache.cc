@@ -165,32 +165,15 @@ size_t SiteLutMappingResult::getSizeInBytes() const
 
 void SiteLutMappingCache::add(const SiteLutMappingKey &key, const SiteLutMappingResult &result)
 {
-    cache_[key] = result;
+    cache_.add(key, result);
 }
 
 bool SiteLutMappingCache::get(const SiteLutMappingKey &key, SiteLutMappingResult *result)
 {
-    if (cache_.count(key) == 0) {
-        numMisses++;
-        return false;
-    }
-
-    numHits++;
-    *result = cache_[key];
-    return true;
-}
-
-void SiteLutMappingCache::clear()
-{
-    cache_.clear();
-    clearStats();
+    return cache_.get(key, result);
 }
 
-void SiteLutMappingCache::clearStats()
-{
-    numHits = 0;
-    numMisses = 0;
-}
+void SiteLutMappingCache::clear() { cache_.clear(); }
 
 // ============================================================================
 
@@ -22,6 +22,7 @@
 
 #include "idstring.h"
 #include "nextpnr_namespaces.h"
+#include "sharded_cache.h"
 #include "site_arch.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -62,7 +63,14 @@ struct SiteLutMappingKey
     static SiteLutMappingKey create(const SiteInformation &siteInfo);
 
     // Returns size in bytes of the key
-    size_t getSizeInBytes() const { return sizeof(SiteLutMappingKey); }
+    size_t getSizeInBytes() const
+    {
+        size_t size = sizeof(SiteLutMappingKey) + cells.capacity() * sizeof(Cell);
+        for (const auto &cell : cells) {
+            size += cell.conns.capacity() * sizeof(int32_t);
+        }
+        return size;
+    }
 
     // Precomputes hash of the key and stores it within
     void computeHash()
@@ -134,7 +142,7 @@ struct SiteLutMappingResult
     size_t getSizeInBytes() const;
 };
 
-// Site LUT mapping cache object
+// Site LUT mapping cache object. The cache is size limited and thread safe.
 class SiteLutMappingCache
 {
   public:
@@ -143,35 +151,29 @@ class SiteLutMappingCache
     // Retrieves an entry from the cache. Returns false if not found
     bool get(const SiteLutMappingKey &key, SiteLutMappingResult *result);
 
-    // Clears the cache
+    // Clears the cache and its statistics counters
     void clear();
-    // Clears statistics counters of the cache
-    void clearStats();
 
-    // Return get() miss ratio
-    float getMissRatio() const { return (float)numMisses / (float)(numHits + numMisses); }
+    // Calls func(key, result) for each entry in the cache
+    template <typename TFunc> void forEach(TFunc func) const { cache_.for_each(func); }
 
-    // Returns count of entries in the cache
-    size_t getCount() const { return cache_.size(); }
+    // Sets the memory limit of the cache, least recently used entries are
+    // evicted beyond it
+    void setMaxBytes(size_t maxBytes) { cache_.set_max_bytes(maxBytes); }
 
-    // Returns size of the cache rounded upwards to full MBs.
-    size_t getSizeMB() const
-    {
-        size_t size = 0;
-        for (const auto &it : cache_) {
-            size += it.first.getSizeInBytes();
-            size += it.second.getSizeInBytes();
-        }
-
-        const size_t MB = 1024L * 1024L;
-        return (size + MB - 1) / MB; // Round up to megabytes
-    }
+    // Returns hit/miss/eviction counters and the current size
+    CacheStats getStats() const { return cache_.stats(); }
 
   private:
-    dict<SiteLutMappingKey, SiteLutMappingResult> cache_; // The cache
+    struct EntrySize
+    {
+        size_t operator()(const SiteLutMappingKey &key, const SiteLutMappingResult &result) const
+        {
+            return key.getSizeInBytes() + result.getSizeInBytes();
+        }
+    };
 
-    size_t numHits = 0;   // Hit count
-    size_t numMisses = 0; // Miss count
+    ShardedCache<SiteLutMappingKey, SiteLutMappingResult, EntrySize> cache_; // The cache
 };
 
 NEXTPNR_NAMESPACE_END
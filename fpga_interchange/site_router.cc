@@ -27,6 +27,8 @@
 #include "site_arch.h"
 #include "site_arch.impl.h"
 
+#include <chrono>
+#include <limits>
 #include <queue>
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -35,6 +37,20 @@ bool verbose_site_router(const Context *ctx) { return ctx->debug; }
 
 bool verbose_site_router(const SiteArch *ctx) { return verbose_site_router(ctx->ctx); }
 
+// Adds the time until it goes out of scope to SiteRouterStats::time_us
+struct SiteRouterTimer
+{
+    SiteRouterStats &stats;
+    std::chrono::steady_clock::time_point start;
+
+    SiteRouterTimer(SiteRouterStats &stats) : stats(stats), start(std::chrono::steady_clock::now()) {}
+    ~SiteRouterTimer()
+    {
+        auto end = std::chrono::steady_clock::now();
+        stats.time_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    }
+};
+
 void SiteRouter::bindBel(CellInfo *cell)
 {
     auto result = cells_in_site.emplace(cell);
@@ -516,9 +532,12 @@ struct SolutionPreference
     }
 };
 
+// Picks one of the solutions for each sink so that no site wire is used by
+// two nets. On success the picked solutions are left bound, and
+// (*chosen)[sink_idx] is the solution picked for each sink.
 static bool find_solution_via_backtrack(SiteArch *ctx, std::vector<PossibleSolutions> *solutions,
                                         std::vector<std::vector<size_t>> sinks_to_solutions,
-                                        const std::vector<SiteWire> &sinks, bool explain)
+                                        const std::vector<SiteWire> &sinks, bool explain, std::vector<size_t> *chosen)
 {
     std::vector<uint8_t> routed_sinks;
     std::vector<size_t> solution_indicies;
@@ -529,21 +548,23 @@ static bool find_solution_via_backtrack(SiteArch *ctx, std::vector<PossibleSolut
     //
     // Note: This result cannot be cached because some solutions may be
     // placement dependent.
-    for (size_t solution_idx = 0; solution_idx < solutions->size(); ++solution_idx) {
-        PossibleSolutions &solution = (*solutions)[solution_idx];
-        if (verbose_site_router(ctx) || explain) {
-            log_info("Testing solution %zu\n", solution_idx);
-        }
-        if (test_solution(ctx, solution.net, solution.pips_begin, solution.pips_end)) {
+    for (const std::vector<size_t> &solutions_for_sink : sinks_to_solutions) {
+        for (size_t solution_idx : solutions_for_sink) {
+            PossibleSolutions &solution = (*solutions)[solution_idx];
             if (verbose_site_router(ctx) || explain) {
-                log_info("Solution %zu is good\n", solution_idx);
+                log_info("Testing solution %zu\n", solution_idx);
             }
-            remove_solution(ctx, solution.pips_begin, solution.pips_end);
-        } else {
-            if (verbose_site_router(ctx) || explain) {
-                log_info("Solution %zu is not useable\n", solution_idx);
+            if (test_solution(ctx, solution.net, solution.pips_begin, solution.pips_end)) {
+                if (verbose_site_router(ctx) || explain) {
+                    log_info("Solution %zu is good\n", solution_idx);
+                }
+                remove_solution(ctx, solution.pips_begin, solution.pips_end);
+            } else {
+                if (verbose_site_router(ctx) || explain) {
+                    log_info("Solution %zu is not useable\n", solution_idx);
+                }
+                solution.tested = true;
             }
-            solution.tested = true;
         }
     }
 
@@ -685,6 +706,10 @@ static bool find_solution_via_backtrack(SiteArch *ctx, std::vector<PossibleSolut
                     log_info("Solved via backtrack with %zu solutions and %zu sinks\n", solutions->size(),
                              sinks_to_solutions.size());
                 }
+                chosen->resize(sinks_to_solutions.size());
+                for (size_t i = 0; i < solution_stack.size(); ++i) {
+                    (*chosen)[solution_order[i].first] = solution_stack[i];
+                }
                 return true;
             } else {
                 // Because we pushing to a new level of stack, restart the
@@ -699,8 +724,84 @@ static bool find_solution_via_backtrack(SiteArch *ctx, std::vector<PossibleSolut
     NPNR_ASSERT(false);
 }
 
+// Tries to keep the routes of the previous solution for the site, and only
+// route the remaining sinks. Returns false (with nothing left bound) if that
+// is not possible, in which case the whole site must be routed.
+static bool route_site_incremental(SiteArch *ctx, std::vector<PossibleSolutions> *solutions,
+                                   const std::vector<std::vector<size_t>> &sinks_to_solutions,
+                                   const std::vector<SiteWire> &sinks,
+                                   const dict<SiteWire, SiteSinkRoute> &sink_routes, bool explain,
+                                   std::vector<size_t> *chosen)
+{
+    constexpr size_t kNotKept = std::numeric_limits<size_t>::max();
+    chosen->assign(sinks.size(), kNotKept);
+
+    // Bind the previous routes that are still a possible solution for their
+    // sink, and do not conflict with anything bound so far.
+    std::vector<std::vector<size_t>> remaining_sinks_to_solutions;
+    std::vector<SiteWire> remaining_sinks;
+    std::vector<size_t> remaining_sink_idx;
+    size_t kept = 0;
+    for (size_t sink_idx = 0; sink_idx < sinks.size(); ++sink_idx) {
+        auto route = sink_routes.find(sinks[sink_idx]);
+        if (route != sink_routes.end()) {
+            for (size_t solution_idx : sinks_to_solutions[sink_idx]) {
+                const PossibleSolutions &solution = solutions->at(solution_idx);
+                if (solution.net->net != route->second.net ||
+                    !std::equal(solution.pips_begin, solution.pips_end, route->second.pips.begin(),
+                                route->second.pips.end())) {
+                    continue;
+                }
+                if (test_solution(ctx, solution.net, solution.pips_begin, solution.pips_end)) {
+                    (*chosen)[sink_idx] = solution_idx;
+                    ++kept;
+                }
+                break;
+            }
+        }
+
+        if ((*chosen)[sink_idx] == kNotKept) {
+            remaining_sinks_to_solutions.push_back(sinks_to_solutions[sink_idx]);
+            remaining_sinks.push_back(sinks[sink_idx]);
+            remaining_sink_idx.push_back(sink_idx);
+        }
+    }
+
+    if (verbose_site_router(ctx) || explain) {
+        log_info("Kept %zu of %zu routes from the previous solution\n", kept, sinks.size());
+    }
+
+    if (remaining_sinks.empty()) {
+        return true;
+    }
+
+    std::vector<size_t> remaining_chosen;
+    if (kept > 0 && find_solution_via_backtrack(ctx, solutions, remaining_sinks_to_solutions, remaining_sinks, explain,
+                                                &remaining_chosen)) {
+        for (size_t i = 0; i < remaining_sink_idx.size(); ++i) {
+            (*chosen)[remaining_sink_idx[i]] = remaining_chosen[i];
+        }
+        return true;
+    }
+
+    for (size_t solution_idx : *chosen) {
+        if (solution_idx != kNotKept) {
+            const PossibleSolutions &solution = solutions->at(solution_idx);
+            remove_solution(ctx, solution.pips_begin, solution.pips_end);
+        }
+    }
+    // Solutions that conflicted with the kept routes may still be useful.
+    for (PossibleSolutions &solution : *solutions) {
+        solution.tested = false;
+    }
+    return false;
+}
+
+// Routes all nets in the site. If sink_routes is given, the routes of its
+// previous solution are kept where possible, and it is updated with the new
+// solution.
 static bool route_site(SiteArch *ctx, SiteRoutingCache *site_routing_cache, RouteNodeStorage *node_storage,
-                       bool explain, bool cache_disabled = false)
+                       dict<SiteWire, SiteSinkRoute> *sink_routes, bool explain, bool cache_disabled = false)
 {
     // Overview:
     // - Starting from each site net source, expand the site routing graph
@@ -750,6 +851,9 @@ static bool route_site(SiteArch *ctx, SiteRoutingCache *site_routing_cache, Rout
 
     if (sink_map.empty()) {
         // All nets are trivially routed!
+        if (sink_routes != nullptr) {
+            sink_routes->clear();
+        }
         return true;
     }
 
@@ -795,7 +899,33 @@ static bool route_site(SiteArch *ctx, SiteRoutingCache *site_routing_cache, Rout
         }
     }
 
-    return find_solution_via_backtrack(ctx, &solutions, sinks_to_solutions, sinks, explain);
+    SiteRouterStats &stats = ctx->ctx->site_router_stats;
+    stats.routes += 1;
+
+    std::vector<size_t> chosen;
+    bool routed = false;
+    if (sink_routes != nullptr && !sink_routes->empty()) {
+        routed = route_site_incremental(ctx, &solutions, sinks_to_solutions, sinks, *sink_routes, explain, &chosen);
+        if (routed) {
+            stats.incremental += 1;
+        } else {
+            stats.fallbacks += 1;
+        }
+    }
+    if (!routed) {
+        routed = find_solution_via_backtrack(ctx, &solutions, sinks_to_solutions, sinks, explain, &chosen);
+    }
+
+    if (routed && sink_routes != nullptr) {
+        sink_routes->clear();
+        for (size_t sink_idx = 0; sink_idx < sinks.size(); ++sink_idx) {
+            const PossibleSolutions &solution = solutions.at(chosen.at(sink_idx));
+            SiteSinkRoute &route = (*sink_routes)[sinks[sink_idx]];
+            route.net = solution.net->net;
+            route.pips.assign(solution.pips_begin, solution.pips_end);
+        }
+    }
+    return routed;
 }
 
 void check_routing(const SiteArch &site_arch)
@@ -1291,6 +1421,7 @@ bool SiteRouter::checkSiteRouting(const Context *ctx, const TileStatus &tile_sta
     }
 
     dirty = false;
+    SiteRouterTimer timer(ctx->site_router_stats);
 
     // Empty sites are trivially correct.
     if (cells_in_site.size() == 0) {
@@ -1358,7 +1489,8 @@ bool SiteRouter::checkSiteRouting(const Context *ctx, const TileStatus &tile_sta
 
     // Do a detailed routing check to see if the site has at least 1 valid
     // routing solution.
-    site_ok = route_site(&site_arch, &ctx->site_routing_cache, &ctx->node_storage, /*explain=*/false);
+    dict<SiteWire, SiteSinkRoute> *previous_routes = ctx->args.incremental_site_routing ? &sink_routes : nullptr;
+    site_ok = route_site(&site_arch, &ctx->site_routing_cache, &ctx->node_storage, previous_routes, /*explain=*/false);
     if (verbose_site_router(ctx)) {
         if (site_ok) {
             log_info("Site %s is routable\n", ctx->get_site_name(tile, site));
@@ -1377,6 +1509,7 @@ void SiteRouter::bindSiteRouting(Context *ctx)
 {
     NPNR_ASSERT(!dirty);
     NPNR_ASSERT(site_ok);
+    SiteRouterTimer timer(ctx->site_router_stats);
 
     // Make sure all cells in this site belong!
     auto iter = cells_in_site.begin();
@@ -1416,8 +1549,9 @@ void SiteRouter::bindSiteRouting(Context *ctx)
     block_lut_outputs(&site_arch, blocked_wires);
     block_cluster_wires(&site_arch);
     reserve_site_ports(&site_arch);
-    NPNR_ASSERT(route_site(&site_arch, &ctx->site_routing_cache, &ctx->node_storage, /*explain=*/false,
-                           /*cache_disabled=*/true));
+    dict<SiteWire, SiteSinkRoute> *previous_routes = ctx->args.incremental_site_routing ? &sink_routes : nullptr;
+    NPNR_ASSERT(route_site(&site_arch, &ctx->site_routing_cache, &ctx->node_storage, previous_routes,
+                           /*explain=*/false, /*cache_disabled=*/true));
 
     check_routing(site_arch);
     apply_routing(ctx, site_arch, lut_thrus);
@@ -1443,7 +1577,8 @@ void SiteRouter::explain(const Context *ctx) const
 
     SiteInformation site_info(ctx, tile, site, cells_in_site);
     SiteArch site_arch(&site_info);
-    bool route_status = route_site(&site_arch, &ctx->site_routing_cache, &ctx->node_storage, /*explain=*/true);
+    bool route_status = route_site(&site_arch, &ctx->site_routing_cache, &ctx->node_storage, /*sink_routes=*/nullptr,
+                                   /*explain=*/true);
     if (!route_status) {
         print_current_state(&site_arch);
     }
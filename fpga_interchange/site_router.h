@@ -21,7 +21,9 @@
 #ifndef SITE_ROUTER_H
 #define SITE_ROUTER_H
 
+#include <atomic>
 #include <cstdint>
+#include <vector>
 
 #include "hashlib.h"
 #include "nextpnr_namespaces.h"
@@ -34,6 +36,34 @@ NEXTPNR_NAMESPACE_BEGIN
 struct Context;
 struct TileStatus;
 
+// Counters for the site router, summed over all sites.
+struct SiteRouterStats
+{
+    // Number of times a site was routed
+    std::atomic<size_t> routes{0};
+    // Number of those that reused the routes of the previous solution for the
+    // site, and only routed the sinks that changed
+    std::atomic<size_t> incremental{0};
+    // Number of incremental attempts that failed and routed the whole site
+    std::atomic<size_t> fallbacks{0};
+    std::atomic<int64_t> time_us{0};
+
+    void clear()
+    {
+        routes = 0;
+        incremental = 0;
+        fallbacks = 0;
+        time_us = 0;
+    }
+};
+
+// The route chosen for a sink of a site net.
+struct SiteSinkRoute
+{
+    NetInfo *net;
+    std::vector<SitePip> pips;
+};
+
 struct SiteRouter
 {
     SiteRouter(int16_t site) : site(site), dirty(false), site_ok(true) {}
@@ -46,6 +76,12 @@ struct SiteRouter
     mutable bool dirty;
     mutable bool site_ok;
 
+    // Routes from the last time the site was successfully routed, only kept
+    // with --incremental-site-routing. Placement usually changes one cell at
+    // a time, so most of these can be kept and only the sinks that were added
+    // (or whose route is now blocked) need routing.
+    mutable dict<SiteWire, SiteSinkRoute> sink_routes;
+
     void bindBel(CellInfo *cell);
     void unbindBel(CellInfo *cell);
     bool checkSiteRouting(const Context *ctx, const TileStatus &tile_status) const;
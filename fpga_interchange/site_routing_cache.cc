@@ -130,15 +130,13 @@ SiteRoutingKey SiteRoutingKey::make(const SiteArch *ctx, const SiteNetInfo &site
     return out;
 }
 
-bool SiteRoutingCache::get_solution(const SiteArch *ctx, const SiteNetInfo &net, SiteRoutingSolution *solution) const
+bool SiteRoutingCache::get_solution(const SiteArch *ctx, const SiteNetInfo &net, SiteRoutingSolution *solution)
 {
     SiteRoutingKey key = SiteRoutingKey::make(ctx, net);
-    auto iter = cache_.find(key);
-    if (iter == cache_.end()) {
+    if (!cache_.get(key, solution)) {
         return false;
     }
 
-    *solution = iter->second;
     const auto &tile_type_data = ctx->site_info->chip_info().tile_types[ctx->site_info->tile_type];
 
     for (SiteWire &wire : solution->solution_sinks) {
@@ -201,7 +199,7 @@ void SiteRoutingCache::add_solutions(const SiteArch *ctx, const SiteNetInfo &net
 {
     SiteRoutingKey key = SiteRoutingKey::make(ctx, net);
 
-    cache_[key] = solution;
+    cache_.add(key, solution);
 }
 
 void SiteRoutingCache::clear() { cache_.clear(); }
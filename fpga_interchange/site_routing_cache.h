@@ -23,6 +23,7 @@
 
 #include "PhysicalNetlist.capnp.h"
 #include "nextpnr_namespaces.h"
+#include "sharded_cache.h"
 #include "site_arch.h"
 #include "site_routing_storage.h"
 
@@ -63,6 +64,13 @@ struct SiteRoutingSolution
 
     bool solution_can_invert(size_t solution) const { return can_invert.at(solution) != 0; }
 
+    size_t size_in_bytes() const
+    {
+        return sizeof(SiteRoutingSolution) + solution_offsets.capacity() * sizeof(size_t) +
+               solution_storage.capacity() * sizeof(SitePip) + solution_sinks.capacity() * sizeof(SiteWire) +
+               inverted.capacity() + can_invert.capacity();
+    }
+
     std::vector<size_t> solution_offsets;
     std::vector<SitePip> solution_storage;
     std::vector<SiteWire> solution_sinks;
@@ -97,6 +105,12 @@ struct SiteRoutingKey
 
     static SiteRoutingKey make(const SiteArch *ctx, const SiteNetInfo &site_net);
 
+    size_t size_in_bytes() const
+    {
+        return sizeof(SiteRoutingKey) + user_types.capacity() * sizeof(SiteWire::Type) +
+               user_indicies.capacity() * sizeof(int32_t);
+    }
+
     unsigned int hash() const
     {
         unsigned int seed = 0;
@@ -115,16 +129,31 @@ struct SiteRoutingKey
     }
 };
 
-// Provides an LRU cache for site routing solutions.
+// Provides a size limited, thread safe cache for site routing solutions.
 class SiteRoutingCache
 {
   public:
-    bool get_solution(const SiteArch *ctx, const SiteNetInfo &net, SiteRoutingSolution *solution) const;
+    bool get_solution(const SiteArch *ctx, const SiteNetInfo &net, SiteRoutingSolution *solution);
     void add_solutions(const SiteArch *ctx, const SiteNetInfo &net, const SiteRoutingSolution &solution);
     void clear();
 
+    // Used to save and restore the cache (see arch_site_cache.cc)
+    void add_solutions(const SiteRoutingKey &key, const SiteRoutingSolution &solution) { cache_.add(key, solution); }
+    template <typename TFunc> void for_each(TFunc func) const { cache_.for_each(func); }
+
+    void set_max_bytes(size_t max_bytes) { cache_.set_max_bytes(max_bytes); }
+    CacheStats stats() const { return cache_.stats(); }
+
   private:
-    dict<SiteRoutingKey, SiteRoutingSolution> cache_;
+    struct EntrySize
+    {
+        size_t operator()(const SiteRoutingKey &key, const SiteRoutingSolution &solution) const
+        {
+            return key.size_in_bytes() + solution.size_in_bytes();
+        }
+    };
+
+    ShardedCache<SiteRoutingKey, SiteRoutingSolution, EntrySize> cache_;
 };
 
 NEXTPNR_NAMESPACE_END
@@ -32,6 +32,7 @@ NEXTPNR_NAMESPACE_BEGIN
 WireId Arch::addWire(IdStringList name, IdString type, int x, int y)
 {
     NPNR_ASSERT(wire_by_name.count(name) == 0);
+    thawGraph();
     WireId wire(wires.size());
     wire_by_name[name] = wire;
     wires.emplace_back();
@@ -69,7 +70,10 @@ WireId Arch::addWireAsBelInout(BelId bel, IdString name)
 
 PipId Arch::addPip(IdStringList name, IdString type, WireId srcWire, WireId dstWire, delay_t delay, Loc loc)
 {
+    if (pip_by_name_pending)
+        index_pip_names();
     NPNR_ASSERT(pip_by_name.count(name) == 0);
+    thawGraph();
     PipId pip(pips.size());
     pip_by_name[name] = pip;
     pips.emplace_back();
@@ -113,6 +117,7 @@ BelId Arch::addBel(IdStringList name, IdString type, Loc loc, bool gb, bool hidd
     bi.hidden = hidden;
 
     bel_by_loc[loc] = bel;
+    getCtx()->invalidateBelsForCellType();
 
     if (int(bels_by_tile.size()) <= loc.x)
         bels_by_tile.resize(loc.x + 1);
@@ -149,8 +154,10 @@ void Arch::addBelPin(BelId bel, IdString name, WireId wire, PortType type)
     pi.wire = wire;
     pi.type = type;
 
-    if (wire != WireId())
+    if (wire != WireId()) {
+        thawGraph();
         wire_info(wire).bel_pins.push_back(BelPin{bel, name});
+    }
 }
 
 void Arch::addGroupBel(IdStringList group, BelId bel) { groups[group].bels.push_back(bel); }
@@ -207,7 +214,7 @@ void Arch::setGroupDecal(GroupId group, float x, float y, IdStringList decal)
 
 void Arch::setWireAttr(WireId wire, IdString key, const std::string &value) { wire_info(wire).attrs[key] = value; }
 
-void Arch::setPipAttr(PipId pip, IdString key, const std::string &value) { pip_info(pip).attrs[key] = value; }
+void Arch::setPipAttr(PipId pip, IdString key, const std::string &value) { pip_attrs[pip][key] = value; }
 
 void Arch::setBelAttr(BelId bel, IdString key, const std::string &value) { bel_info(bel).attrs[key] = value; }
 
@@ -257,6 +264,68 @@ void Arch::addCellBelPinMapping(IdString cell, IdString cell_pin, IdString bel_p
     cells.at(cell)->bel_pins[cell_pin].push_back(bel_pin);
 }
 
+void Arch::freezeGraph()
+{
+    if (graph_frozen)
+        return;
+    auto freeze = [&](auto &csr, auto field) {
+        csr.offsets.reserve(wires.size() + 1);
+        size_t total = 0;
+        for (auto &wire : wires)
+            total += (wire.*field).size();
+        NPNR_ASSERT(total <= std::numeric_limits<uint32_t>::max());
+        csr.data.reserve(total);
+        for (auto &wire : wires) {
+            csr.offsets.push_back(csr.data.size());
+            csr.data.insert(csr.data.end(), (wire.*field).begin(), (wire.*field).end());
+            // Swap rather than clear, to free the memory
+            std::remove_reference_t<decltype(wire.*field)>().swap(wire.*field);
+        }
+        csr.offsets.push_back(csr.data.size());
+    };
+    freeze(downhill_csr, &WireInfo::downhill);
+    freeze(uphill_csr, &WireInfo::uphill);
+    freeze(bel_pin_csr, &WireInfo::bel_pins);
+    graph_frozen = true;
+    logGraphMemory();
+}
+
+void Arch::logGraphMemory() const
+{
+    auto dict_usage = [](const auto &d) {
+        // An entry is the key-value pair plus a next index; the hashtable is about three indices per entry
+        return d.size() * (sizeof(*d.begin()) + 4 * sizeof(int));
+    };
+    size_t wire_mem = wires.capacity() * sizeof(WireInfo);
+    size_t pip_mem = pips.capacity() * sizeof(PipInfo);
+    size_t bel_mem = bels.capacity() * sizeof(BelInfo);
+    size_t csr_mem = downhill_csr.memory_usage() + uphill_csr.memory_usage() + bel_pin_csr.memory_usage();
+    size_t index_mem = dict_usage(wire_by_name) + dict_usage(pip_by_name) + dict_usage(bel_by_name);
+    auto mib = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+    log_info("Routing graph: %d wires, %d pips, %d bels using %.1f MiB\n", int(wires.size()), int(pips.size()),
+             int(bels.size()), mib(wire_mem + pip_mem + bel_mem + csr_mem + index_mem));
+    log_info("    %.1f MiB wires, %.1f MiB pips, %.1f MiB bels, %.1f MiB adjacency, %.1f MiB name index\n",
+             mib(wire_mem), mib(pip_mem), mib(bel_mem), mib(csr_mem), mib(index_mem));
+}
+
+void Arch::thawGraph()
+{
+    if (!graph_frozen)
+        return;
+    for (int32_t i = 0; i < int32_t(wires.size()); i++) {
+        auto &wire = wires[i];
+        auto downhill = downhill_csr.at(i), uphill = uphill_csr.at(i);
+        auto bel_pins = bel_pin_csr.at(i);
+        wire.downhill.assign(downhill.begin(), downhill.end());
+        wire.uphill.assign(uphill.begin(), uphill.end());
+        wire.bel_pins.assign(bel_pins.begin(), bel_pins.end());
+    }
+    downhill_csr.clear();
+    uphill_csr.clear();
+    bel_pin_csr.clear();
+    graph_frozen = false;
+}
+
 // ---------------------------------------------------------------
 
 Arch::Arch(ArchArgs args) : chipName("generic"), args(args)
@@ -296,7 +365,14 @@ BelId Arch::getBelByLocation(Loc loc) const
     return BelId();
 }
 
-const std::vector<BelId> &Arch::getBelsByTile(int x, int y) const { return bels_by_tile.at(x).at(y); }
+const std::vector<BelId> &Arch::getBelsByTile(int x, int y) const
+{
+    // The grid also covers tiles that only contain wires and pips
+    static const std::vector<BelId> no_bels;
+    if (x >= int(bels_by_tile.size()) || y >= int(bels_by_tile.at(x).size()))
+        return no_bels;
+    return bels_by_tile.at(x).at(y);
+}
 
 bool Arch::getBelGlobalBuf(BelId bel) const { return bel_info(bel).gb; }
 
@@ -425,8 +501,6 @@ NetInfo *Arch::getBoundWireNet(WireId wire) const { return wire_info(wire).bound
 
 NetInfo *Arch::getConflictingWireNet(WireId wire) const { return wire_info(wire).bound_net; }
 
-const std::vector<BelPin> &Arch::getWireBelPins(WireId wire) const { return wire_info(wire).bel_pins; }
-
 linear_range<WireId> Arch::getWires() const { return linear_range<WireId>(wires.size()); }
 
 // ---------------------------------------------------------------
@@ -435,6 +509,8 @@ PipId Arch::getPipByName(IdStringList name) const
 {
     if (name.size() == 0)
         return PipId();
+    if (pip_by_name_pending)
+        index_pip_names();
     auto fnd = pip_by_name.find(name);
     if (fnd == pip_by_name.end())
         NPNR_ASSERT_FALSE_STR("no pip named " + name.str(getCtx()));
@@ -445,7 +521,12 @@ IdStringList Arch::getPipName(PipId pip) const { return pip_info(pip).name; }
 
 IdString Arch::getPipType(PipId pip) const { return pip_info(pip).type; }
 
-const std::map<IdString, std::string> &Arch::getPipAttrs(PipId pip) const { return pip_info(pip).attrs; }
+const std::map<IdString, std::string> &Arch::getPipAttrs(PipId pip) const
+{
+    static const std::map<IdString, std::string> no_attrs;
+    auto found = pip_attrs.find(pip);
+    return (found != pip_attrs.end()) ? found->second : no_attrs;
+}
 
 uint32_t Arch::getPipChecksum(PipId pip) const { return pip.index; }
 
@@ -510,10 +591,6 @@ WireId Arch::getPipDstWire(PipId pip) const { return pip_info(pip).dstWire; }
 
 DelayQuad Arch::getPipDelay(PipId pip) const { return DelayQuad(pip_info(pip).delay); }
 
-const std::vector<PipId> &Arch::getPipsDownhill(WireId wire) const { return wire_info(wire).downhill; }
-
-const std::vector<PipId> &Arch::getPipsUphill(WireId wire) const { return wire_info(wire).uphill; }
-
 // ---------------------------------------------------------------
 
 GroupId Arch::getGroupByName(IdStringList name) const { return name; }
@@ -593,6 +670,7 @@ BoundingBox Arch::getRouteBoundingBox(WireId src, WireId dst) const
 
 bool Arch::place()
 {
+    freezeGraph();
     if (uarch)
         uarch->prePlace();
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
@@ -634,6 +712,7 @@ bool Arch::place()
 
 bool Arch::route()
 {
+    freezeGraph();
     if (uarch)
         uarch->preRoute();
     std::string router = str_or_default(settings, id("router"), defaultRouter);
@@ -20,7 +20,9 @@
 #ifndef GENERIC_ARCH_H
 #define GENERIC_ARCH_H
 
+#include <atomic>
 #include <map>
+#include <mutex>
 
 #include "arch_api.h"
 #include "base_arch.h"
@@ -47,7 +49,6 @@ struct PipInfo
 {
     IdStringList name;
     IdString type;
-    std::map<IdString, std::string> attrs;
     NetInfo *bound_net;
     WireId srcWire, dstWire;
     delay_t delay;
@@ -61,6 +62,7 @@ struct WireInfo
     IdString type;
     std::map<IdString, std::string> attrs;
     NetInfo *bound_net;
+    // Only used while the device is being built, see Arch::freezeGraph
     std::vector<PipId> downhill, uphill;
     std::vector<BelPin> bel_pins;
     DecalXY decalxy;
@@ -128,6 +130,36 @@ template <typename TId> struct linear_range
     iterator end() const { return iterator(size); }
 };
 
+// A contiguous slice of an array
+template <typename T> struct array_range
+{
+    array_range(const T *b, const T *e) : b(b), e(e){};
+    explicit array_range(const std::vector<T> &v) : b(v.data()), e(v.data() + v.size()){};
+    const T *b, *e;
+    const T *begin() const { return b; }
+    const T *end() const { return e; }
+    size_t size() const { return e - b; }
+    bool empty() const { return b == e; }
+};
+
+// Per-wire lists stored in compressed sparse row form: the items for wire i are data[offsets[i]] to
+// data[offsets[i + 1]]
+template <typename T> struct csr_array
+{
+    std::vector<uint32_t> offsets;
+    std::vector<T> data;
+    array_range<T> at(int32_t index) const
+    {
+        return array_range<T>(data.data() + offsets[index], data.data() + offsets[index + 1]);
+    }
+    void clear()
+    {
+        std::vector<uint32_t>().swap(offsets);
+        std::vector<T>().swap(data);
+    }
+    size_t memory_usage() const { return offsets.capacity() * sizeof(uint32_t) + data.capacity() * sizeof(T); }
+};
+
 struct ArchRanges : BaseArchRanges
 {
     using ArchArgsT = ArchArgs;
@@ -139,9 +171,9 @@ struct ArchRanges : BaseArchRanges
     using CellBelPinRangeT = const std::vector<IdString> &;
     // Wires
     using AllWiresRangeT = linear_range<WireId>;
-    using DownhillPipRangeT = const std::vector<PipId> &;
-    using UphillPipRangeT = const std::vector<PipId> &;
-    using WireBelPinRangeT = const std::vector<BelPin> &;
+    using DownhillPipRangeT = array_range<PipId>;
+    using UphillPipRangeT = array_range<PipId>;
+    using WireBelPinRangeT = array_range<BelPin>;
     using WireAttrsRangeT = const std::map<IdString, std::string> &;
     // Pips
     using AllPipsRangeT = linear_range<PipId>;
@@ -179,7 +211,12 @@ struct Arch : BaseArch<ArchRanges>
     const BelInfo &bel_info(BelId bel) const { return bels.at(bel.index); }
 
     dict<IdStringList, WireId> wire_by_name;
-    dict<IdStringList, PipId> pip_by_name;
+    // After loading from a device cache, this is only built when first needed, as it is rarely used but slow to
+    // build for large devices
+    mutable dict<IdStringList, PipId> pip_by_name;
+    mutable std::atomic<bool> pip_by_name_pending{false};
+    mutable std::mutex pip_by_name_mutex;
+    void index_pip_names() const;
     dict<IdStringList, BelId> bel_by_name;
 
     dict<Loc, BelId> bel_by_loc;
@@ -193,6 +230,19 @@ struct Arch : BaseArch<ArchRanges>
 
     dict<IdString, CellTiming> cellTiming;
 
+    // Pip attributes are rare, so are not stored in PipInfo
+    dict<PipId, std::map<IdString, std::string>> pip_attrs;
+
+    // Once the device is built, the pips and bel pins of each wire are moved out of the per-wire vectors in WireInfo
+    // into flat CSR arrays, for lower memory use and better locality when routing. This is done before packing,
+    // placement and routing; adding wires, pips or bel pins afterwards moves them back.
+    bool graph_frozen = false;
+    csr_array<PipId> downhill_csr, uphill_csr;
+    csr_array<BelPin> bel_pin_csr;
+    void freezeGraph();
+    void thawGraph();
+    void logGraphMemory() const;
+
     WireId addWire(IdStringList name, IdString type, int x, int y);
     PipId addPip(IdStringList name, IdString type, WireId srcWire, WireId dstWire, delay_t delay, Loc loc);
 
@@ -232,6 +282,15 @@ struct Arch : BaseArch<ArchRanges>
     void clearCellBelPinMap(IdString cell, IdString cell_pin);
     void addCellBelPinMapping(IdString cell, IdString cell_pin, IdString bel_pin);
 
+    // Save the device built by the functions above to a binary cache, or load it back instead of building it again
+    // (arch_cache.cc). `key` must identify everything the device was built from; loading returns false if the file
+    // doesn't exist or has a different key. Both do nothing if filename is empty.
+    bool loadArchCache(const std::string &filename, const std::string &key);
+    void saveArchCache(const std::string &filename, const std::string &key) const;
+    // Number of IdStrings when loadArchCache was last called. Those created after it while building the device are
+    // saved in creation order, so that a loaded device has the same IdString indices as a freshly built one
+    int arch_cache_id_base = -1;
+
     // ---------------------------------------------------------------
     // Common Arch API. Every arch must provide the following methods.
 
@@ -284,7 +343,10 @@ struct Arch : BaseArch<ArchRanges>
     NetInfo *getConflictingWireNet(WireId wire) const override;
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
     linear_range<WireId> getWires() const override;
-    const std::vector<BelPin> &getWireBelPins(WireId wire) const override;
+    array_range<BelPin> getWireBelPins(WireId wire) const override
+    {
+        return graph_frozen ? bel_pin_csr.at(wire.index) : array_range<BelPin>(wire_info(wire).bel_pins);
+    }
 
     PipId getPipByName(IdStringList name) const override;
     IdStringList getPipName(PipId pip) const override;
@@ -303,8 +365,14 @@ struct Arch : BaseArch<ArchRanges>
     WireId getPipSrcWire(PipId pip) const override;
     WireId getPipDstWire(PipId pip) const override;
     DelayQuad getPipDelay(PipId pip) const override;
-    const std::vector<PipId> &getPipsDownhill(WireId wire) const override;
-    const std::vector<PipId> &getPipsUphill(WireId wire) const override;
+    array_range<PipId> getPipsDownhill(WireId wire) const override
+    {
+        return graph_frozen ? downhill_csr.at(wire.index) : array_range<PipId>(wire_info(wire).downhill);
+    }
+    array_range<PipId> getPipsUphill(WireId wire) const override
+    {
+        return graph_frozen ? uphill_csr.at(wire.index) : array_range<PipId>(wire_info(wire).uphill);
+    }
 
     GroupId getGroupByName(IdStringList name) const override;
     IdStringList getGroupName(GroupId group) const override;
@@ -0,0 +1,754 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  agent <agent@local>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+/*
+Binary cache of a fully built generic device, so that viaduct uarches and Python scripts that build large fabrics only
+pay for that once.
+
+The file is a flat sequence of native-endian 32-bit words: a header containing the key that identifies what the device
+was built from, a string table, and then the device itself. Every name, type and attribute refers to the string table
+by index, so each string is only interned once when loading. The IdStrings created while building the device come
+first in the table, in the order they were created, so that they get the same indices when the cache is loaded. The
+routing graph and the bel pins of each wire are stored in the same CSR form that Arch::freezeGraph uses, and are loaded
+straight into it. The file is memory-mapped and decoded in a single pass when loading.
+*/
+
+#include <algorithm>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "log.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+const uint32_t cache_magic = 0x4347504e; // "NPGC"
+const uint32_t cache_version = 1;
+
+// hashlib dicts iterate in reverse insertion order; entries are saved in insertion order so that loading recreates
+// the dicts (and so the order of getBelPins, getGroups etc) exactly
+template <typename K, typename T, typename OPS>
+std::vector<const std::pair<K, T> *> insertion_order(const dict<K, T, OPS> &d)
+{
+    std::vector<const std::pair<K, T> *> result;
+    for (auto &entry : d)
+        result.push_back(&entry);
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+struct CacheWriter
+{
+    const Context *ctx;
+    // The IdStrings from id_base onwards start the string table in index order, and are interned up front on loading
+    CacheWriter(const Context *ctx, int id_base) : ctx(ctx)
+    {
+        int id_count = ctx->idstring_idx_to_str->size();
+        for (int i = id_base; i < id_count; i++) {
+            id_index.emplace(IdString(i), strings.size());
+            strings.push_back(IdString(i).str(ctx));
+        }
+        preload_count = strings.size();
+    };
+
+    std::vector<std::string> strings;
+    uint32_t preload_count;
+    dict<std::string, uint32_t> string_index;
+    dict<IdString, uint32_t> id_index;
+    std::vector<uint32_t> body;
+
+    void u32(uint32_t v) { body.push_back(v); }
+    void i32(int32_t v) { body.push_back(uint32_t(v)); }
+    void f32(float v)
+    {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+    void f64(double v)
+    {
+        uint32_t bits[2];
+        memcpy(bits, &v, sizeof(bits));
+        u32(bits[0]);
+        u32(bits[1]);
+    }
+    void str(const std::string &s)
+    {
+        auto found = string_index.find(s);
+        if (found != string_index.end()) {
+            u32(found->second);
+            return;
+        }
+        uint32_t index = strings.size();
+        strings.push_back(s);
+        string_index.emplace(s, index);
+        u32(index);
+    }
+    void id(IdString v)
+    {
+        auto found = id_index.find(v);
+        if (found != id_index.end()) {
+            u32(found->second);
+            return;
+        }
+        uint32_t index = strings.size();
+        strings.push_back(v.str(ctx));
+        id_index.emplace(v, index);
+        u32(index);
+    }
+    void id_list(const IdStringList &v)
+    {
+        u32(v.size());
+        for (IdString x : v)
+            id(x);
+    }
+    void attrs(const std::map<IdString, std::string> &v)
+    {
+        u32(v.size());
+        for (auto &attr : v) {
+            id(attr.first);
+            str(attr.second);
+        }
+    }
+    void decal(const DecalXY &v)
+    {
+        id_list(v.decal.name);
+        u32(v.decal.active);
+        f32(v.x);
+        f32(v.y);
+    }
+    void delay_pair(const DelayPair &v)
+    {
+        f32(v.min_delay);
+        f32(v.max_delay);
+    }
+    void delay_quad(const DelayQuad &v)
+    {
+        delay_pair(v.rise);
+        delay_pair(v.fall);
+    }
+    template <typename TId> void index_list(const std::vector<TId> &v)
+    {
+        u32(v.size());
+        for (TId x : v)
+            i32(x.index);
+    }
+    void grid(const std::vector<std::vector<int>> &v)
+    {
+        u32(v.size());
+        for (auto &col : v) {
+            u32(col.size());
+            for (int x : col)
+                i32(x);
+        }
+    }
+    void bytes(const std::vector<uint8_t> &v)
+    {
+        u32(v.size());
+        for (size_t i = 0; i < v.size(); i += 4) {
+            uint32_t word = 0;
+            memcpy(&word, v.data() + i, std::min<size_t>(4, v.size() - i));
+            u32(word);
+        }
+    }
+
+    // Strings, as a length followed by the characters padded to a whole number of words
+    static void write_string(std::vector<uint32_t> &out, const std::string &s)
+    {
+        out.push_back(s.size());
+        size_t start = out.size();
+        out.resize(start + (s.size() + 3) / 4);
+        memcpy(out.data() + start, s.data(), s.size());
+    }
+
+    void save(const std::string &filename, const std::string &key)
+    {
+        std::vector<uint32_t> header;
+        header.push_back(cache_magic);
+        header.push_back(cache_version);
+        write_string(header, key);
+        header.push_back(strings.size());
+        header.push_back(preload_count);
+        for (auto &s : strings)
+            write_string(header, s);
+        // Write to a temporary file first so that an interrupted run never leaves a truncated cache behind
+        std::string temp_filename = filename + ".tmp";
+        {
+            std::ofstream out(temp_filename, std::ios::binary);
+            if (!out)
+                log_error("Failed to open device cache '%s' for writing.\n", temp_filename.c_str());
+            out.write(reinterpret_cast<const char *>(header.data()), header.size() * sizeof(uint32_t));
+            out.write(reinterpret_cast<const char *>(body.data()), body.size() * sizeof(uint32_t));
+            if (!out)
+                log_error("Failed to write device cache '%s'.\n", temp_filename.c_str());
+        }
+        if (std::rename(temp_filename.c_str(), filename.c_str()) != 0)
+            log_error("Failed to rename '%s' to '%s'.\n", temp_filename.c_str(), filename.c_str());
+    }
+};
+
+struct CacheReader
+{
+    Context *ctx;
+    const std::string &filename;
+    const uint32_t *ptr, *end;
+    CacheReader(Context *ctx, const std::string &filename, const uint32_t *data, size_t size)
+            : ctx(ctx), filename(filename), ptr(data), end(data + size){};
+
+    // The string table points into the mapped file; strings are only interned as IdStrings once they are used as one
+    std::vector<std::pair<const char *, uint32_t>> strings;
+    std::vector<IdString> ids;
+    std::vector<bool> id_valid;
+
+    uint32_t u32()
+    {
+        if (ptr >= end)
+            log_error("Device cache '%s' is truncated.\n", filename.c_str());
+        return *(ptr++);
+    }
+    int32_t i32() { return int32_t(u32()); }
+    float f32()
+    {
+        uint32_t bits = u32();
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    double f64()
+    {
+        uint32_t bits[2];
+        bits[0] = u32();
+        bits[1] = u32();
+        double v;
+        memcpy(&v, bits, sizeof(v));
+        return v;
+    }
+    // Count of items that each take at least min_words, checked against the remaining size so a corrupt count can't
+    // cause a huge allocation
+    uint32_t count(uint32_t min_words = 1)
+    {
+        uint32_t n = u32();
+        if (uint64_t(n) * min_words > uint64_t(end - ptr))
+            log_error("Device cache '%s' is truncated.\n", filename.c_str());
+        return n;
+    }
+    std::pair<const char *, uint32_t> read_string()
+    {
+        uint32_t size = u32();
+        uint32_t words = (uint64_t(size) + 3) / 4;
+        if (words > uint32_t(end - ptr))
+            log_error("Device cache '%s' is truncated.\n", filename.c_str());
+        const char *data = reinterpret_cast<const char *>(ptr);
+        ptr += words;
+        return {data, size};
+    }
+    void read_strings()
+    {
+        uint32_t n = count();
+        uint32_t preload_count = u32();
+        if (preload_count > n)
+            log_error("Device cache '%s' is corrupt.\n", filename.c_str());
+        strings.reserve(n);
+        for (uint32_t i = 0; i < n; i++)
+            strings.push_back(read_string());
+        ids.resize(n);
+        id_valid.resize(n);
+        for (uint32_t i = 0; i < preload_count; i++) {
+            ids.at(i) = ctx->id(std::string(strings.at(i).first, strings.at(i).second));
+            id_valid.at(i) = true;
+        }
+    }
+    uint32_t string_index()
+    {
+        uint32_t index = u32();
+        if (index >= strings.size())
+            log_error("Device cache '%s' is corrupt.\n", filename.c_str());
+        return index;
+    }
+    std::string str()
+    {
+        auto &s = strings.at(string_index());
+        return std::string(s.first, s.second);
+    }
+    IdString id()
+    {
+        uint32_t index = string_index();
+        if (!id_valid.at(index)) {
+            auto &s = strings.at(index);
+            ids.at(index) = ctx->id(std::string(s.first, s.second));
+            id_valid.at(index) = true;
+        }
+        return ids.at(index);
+    }
+    IdStringList id_list()
+    {
+        size_t size = count();
+        IdStringList result(size);
+        for (size_t i = 0; i < result.size(); i++)
+            result.ids[i] = id();
+        return result;
+    }
+    void attrs(std::map<IdString, std::string> &v)
+    {
+        uint32_t n = count(2);
+        for (uint32_t i = 0; i < n; i++) {
+            IdString key = id();
+            v[key] = str();
+        }
+    }
+    DecalXY decal()
+    {
+        DecalXY result;
+        result.decal.name = id_list();
+        result.decal.active = u32();
+        result.x = f32();
+        result.y = f32();
+        return result;
+    }
+    DelayPair delay_pair()
+    {
+        DelayPair result;
+        result.min_delay = f32();
+        result.max_delay = f32();
+        return result;
+    }
+    DelayQuad delay_quad()
+    {
+        DelayQuad result;
+        result.rise = delay_pair();
+        result.fall = delay_pair();
+        return result;
+    }
+    template <typename TId> void index_list(std::vector<TId> &v)
+    {
+        uint32_t n = count();
+        v.reserve(n);
+        for (uint32_t i = 0; i < n; i++)
+            v.emplace_back(i32());
+    }
+    void grid(std::vector<std::vector<int>> &v)
+    {
+        v.resize(count());
+        for (auto &col : v) {
+            col.resize(count());
+            for (auto &x : col)
+                x = i32();
+        }
+    }
+    void bytes(std::vector<uint8_t> &v)
+    {
+        uint32_t size = u32();
+        uint32_t words = (uint64_t(size) + 3) / 4;
+        if (words > uint32_t(end - ptr))
+            log_error("Device cache '%s' is truncated.\n", filename.c_str());
+        v.resize(size);
+        if (size > 0)
+            memcpy(v.data(), ptr, size);
+        ptr += words;
+    }
+};
+
+} // namespace
+
+void Arch::index_pip_names() const
+{
+    std::lock_guard<std::mutex> lock(pip_by_name_mutex);
+    if (!pip_by_name_pending)
+        return;
+    pip_by_name.reserve(pips.size());
+    for (int32_t i = 0; i < int32_t(pips.size()); i++)
+        pip_by_name[pips[i].name] = PipId(i);
+    pip_by_name_pending = false;
+}
+
+void Arch::saveArchCache(const std::string &filename, const std::string &key) const
+{
+    if (filename.empty())
+        return;
+    CacheWriter wr(getCtx(), arch_cache_id_base == -1 ? int(idstring_idx_to_str->size()) : arch_cache_id_base);
+
+    std::vector<uint8_t> uarch_data;
+    if (uarch)
+        uarch->saveCacheData(uarch_data);
+    wr.bytes(uarch_data);
+
+    wr.i32(args.K);
+    wr.f64(args.delayScale);
+    wr.f64(args.delayOffset);
+    wr.f32(delay_epsilon);
+    wr.f32(ripup_penalty);
+    wr.i32(gridDimX);
+    wr.i32(gridDimY);
+    wr.grid(tileBelDimZ);
+    wr.grid(tilePipDimZ);
+
+    wr.u32(wires.size());
+    for (auto &wire : wires) {
+        wr.id_list(wire.name);
+        wr.id(wire.type);
+        wr.i32(wire.x);
+        wr.i32(wire.y);
+        wr.attrs(wire.attrs);
+        wr.decal(wire.decalxy);
+    }
+
+    wr.u32(pips.size());
+    for (int32_t i = 0; i < int32_t(pips.size()); i++) {
+        auto &pip = pips[i];
+        wr.id_list(pip.name);
+        wr.id(pip.type);
+        wr.i32(pip.srcWire.index);
+        wr.i32(pip.dstWire.index);
+        wr.f32(pip.delay);
+        wr.i32(pip.loc.x);
+        wr.i32(pip.loc.y);
+        wr.i32(pip.loc.z);
+        wr.attrs(getPipAttrs(PipId(i)));
+        wr.decal(pip.decalxy);
+    }
+
+    // Downhill and uphill pips of each wire as CSR arrays; the order within each wire is kept as it affects routing
+    auto write_pip_csr = [&](array_range<PipId> (Arch::*get_pips)(WireId) const) {
+        uint32_t offset = 0;
+        for (int32_t i = 0; i < int32_t(wires.size()); i++) {
+            wr.u32(offset);
+            offset += (this->*get_pips)(WireId(i)).size();
+        }
+        wr.u32(offset);
+        for (int32_t i = 0; i < int32_t(wires.size()); i++)
+            for (PipId pip : (this->*get_pips)(WireId(i)))
+                wr.i32(pip.index);
+    };
+    write_pip_csr(&Arch::getPipsDownhill);
+    write_pip_csr(&Arch::getPipsUphill);
+
+    wr.u32(bels.size());
+    for (auto &bel : bels) {
+        wr.id_list(bel.name);
+        wr.id(bel.type);
+        wr.i32(bel.x);
+        wr.i32(bel.y);
+        wr.i32(bel.z);
+        wr.u32((bel.gb ? 1 : 0) | (bel.hidden ? 2 : 0));
+        wr.attrs(bel.attrs);
+        wr.decal(bel.decalxy);
+        wr.u32(bel.pins.size());
+        for (auto pin : insertion_order(bel.pins)) {
+            wr.id(pin->second.name);
+            wr.i32(pin->second.wire.index);
+            wr.u32(pin->second.type);
+        }
+    }
+
+    // Bel pins of each wire, also as CSR arrays. These are not derived from the bel pins as a uarch may have removed
+    // or reordered some
+    uint32_t offset = 0;
+    for (int32_t i = 0; i < int32_t(wires.size()); i++) {
+        wr.u32(offset);
+        offset += getWireBelPins(WireId(i)).size();
+    }
+    wr.u32(offset);
+    for (int32_t i = 0; i < int32_t(wires.size()); i++) {
+        for (auto &bel_pin : getWireBelPins(WireId(i))) {
+            wr.i32(bel_pin.bel.index);
+            wr.id(bel_pin.pin);
+        }
+    }
+
+    wr.u32(groups.size());
+    for (auto group : insertion_order(groups)) {
+        wr.id_list(group->first);
+        wr.index_list(group->second.bels);
+        wr.index_list(group->second.wires);
+        wr.index_list(group->second.pips);
+        wr.u32(group->second.groups.size());
+        for (auto &subgroup : group->second.groups)
+            wr.id_list(subgroup);
+        wr.decal(group->second.decalxy);
+    }
+
+    wr.u32(decal_graphics.size());
+    for (auto decal : insertion_order(decal_graphics)) {
+        wr.id_list(decal->first.name);
+        wr.u32(decal->first.active);
+        wr.u32(decal->second.size());
+        for (auto &g : decal->second) {
+            wr.u32(g.type);
+            wr.u32(g.style);
+            wr.f32(g.x1);
+            wr.f32(g.y1);
+            wr.f32(g.x2);
+            wr.f32(g.y2);
+            wr.f32(g.z);
+            wr.str(g.text);
+        }
+    }
+
+    wr.u32(cellTiming.size());
+    for (auto cell : insertion_order(cellTiming)) {
+        wr.id(cell->first);
+        auto &tmg = cell->second;
+        wr.u32(tmg.portClasses.size());
+        for (auto port : insertion_order(tmg.portClasses)) {
+            wr.id(port->first);
+            wr.u32(port->second);
+        }
+        wr.u32(tmg.combDelays.size());
+        for (auto arc : insertion_order(tmg.combDelays)) {
+            wr.id(arc->first.from);
+            wr.id(arc->first.to);
+            wr.delay_quad(arc->second);
+        }
+        wr.u32(tmg.clockingInfo.size());
+        for (auto port : insertion_order(tmg.clockingInfo)) {
+            wr.id(port->first);
+            wr.u32(port->second.size());
+            for (auto &info : port->second) {
+                wr.id(info.clock_port);
+                wr.u32(info.edge);
+                wr.delay_pair(info.setup);
+                wr.delay_pair(info.hold);
+                wr.delay_quad(info.clockToQ);
+            }
+        }
+    }
+
+    wr.save(filename, key);
+    log_info("Saved device to cache '%s'.\n", filename.c_str());
+}
+
+bool Arch::loadArchCache(const std::string &filename, const std::string &key)
+{
+    if (filename.empty())
+        return false;
+    NPNR_ASSERT(wires.empty() && pips.empty() && bels.empty() && !graph_frozen);
+    arch_cache_id_base = idstring_idx_to_str->size();
+
+    boost::iostreams::mapped_file_source file;
+    try {
+        file.open(filename);
+    } catch (std::ios_base::failure &fail) {
+        return false;
+    }
+    if (!file.is_open())
+        return false;
+
+    CacheReader rd(getCtx(), filename, reinterpret_cast<const uint32_t *>(file.data()),
+                   file.size() / sizeof(uint32_t));
+    if (file.size() < 2 * sizeof(uint32_t) || rd.u32() != cache_magic || rd.u32() != cache_version) {
+        log_info("Device cache '%s' is from an incompatible version of nextpnr, rebuilding it.\n", filename.c_str());
+        return false;
+    }
+    auto cache_key = rd.read_string();
+    if (std::string(cache_key.first, cache_key.second) != key) {
+        log_info("Device cache '%s' is out of date, rebuilding it.\n", filename.c_str());
+        return false;
+    }
+    rd.read_strings();
+
+    std::vector<uint8_t> uarch_data;
+    rd.bytes(uarch_data);
+
+    args.K = rd.i32();
+    args.delayScale = rd.f64();
+    args.delayOffset = rd.f64();
+    delay_epsilon = rd.f32();
+    ripup_penalty = rd.f32();
+    gridDimX = rd.i32();
+    gridDimY = rd.i32();
+    rd.grid(tileBelDimZ);
+    rd.grid(tilePipDimZ);
+
+    wires.resize(rd.count());
+    wire_by_name.reserve(wires.size());
+    for (int32_t i = 0; i < int32_t(wires.size()); i++) {
+        auto &wire = wires[i];
+        wire.name = rd.id_list();
+        wire.type = rd.id();
+        wire.x = rd.i32();
+        wire.y = rd.i32();
+        rd.attrs(wire.attrs);
+        wire.decalxy = rd.decal();
+        wire.bound_net = nullptr;
+        wire_by_name[wire.name] = WireId(i);
+    }
+
+    pips.resize(rd.count());
+    for (int32_t i = 0; i < int32_t(pips.size()); i++) {
+        auto &pip = pips[i];
+        pip.name = rd.id_list();
+        pip.type = rd.id();
+        pip.srcWire = WireId(rd.i32());
+        pip.dstWire = WireId(rd.i32());
+        pip.delay = rd.f32();
+        pip.loc.x = rd.i32();
+        pip.loc.y = rd.i32();
+        pip.loc.z = rd.i32();
+        std::map<IdString, std::string> attrs;
+        rd.attrs(attrs);
+        if (!attrs.empty())
+            pip_attrs[PipId(i)] = std::move(attrs);
+        pip.decalxy = rd.decal();
+        pip.bound_net = nullptr;
+    }
+
+    // The CSR arrays are loaded as they are, leaving the graph frozen
+    auto read_csr_offsets = [&](auto &csr, uint32_t item_words) {
+        csr.offsets.resize(wires.size() + 1);
+        for (size_t i = 0; i < csr.offsets.size(); i++) {
+            csr.offsets[i] = rd.u32();
+            if (i > 0 && csr.offsets[i] < csr.offsets[i - 1])
+                log_error("Device cache '%s' is corrupt.\n", filename.c_str());
+        }
+        if (csr.offsets.front() != 0 || uint64_t(csr.offsets.back()) * item_words > uint64_t(rd.end - rd.ptr))
+            log_error("Device cache '%s' is corrupt.\n", filename.c_str());
+        csr.data.reserve(csr.offsets.back());
+    };
+    auto read_pip_csr = [&](csr_array<PipId> &csr) {
+        read_csr_offsets(csr, 1);
+        for (uint32_t i = 0; i < csr.offsets.back(); i++)
+            csr.data.emplace_back(rd.i32());
+    };
+    read_pip_csr(downhill_csr);
+    read_pip_csr(uphill_csr);
+
+    bels.resize(rd.count());
+    bel_by_name.reserve(bels.size());
+    for (int32_t i = 0; i < int32_t(bels.size()); i++) {
+        auto &bel = bels[i];
+        bel.name = rd.id_list();
+        bel.type = rd.id();
+        bel.x = rd.i32();
+        bel.y = rd.i32();
+        bel.z = rd.i32();
+        uint32_t flags = rd.u32();
+        bel.gb = (flags & 1);
+        bel.hidden = (flags & 2);
+        rd.attrs(bel.attrs);
+        bel.decalxy = rd.decal();
+        bel.bound_cell = nullptr;
+        uint32_t pin_count = rd.count(3);
+        for (uint32_t j = 0; j < pin_count; j++) {
+            PinInfo pin;
+            pin.name = rd.id();
+            pin.wire = WireId(rd.i32());
+            pin.type = PortType(rd.u32());
+            bel.pins[pin.name] = pin;
+        }
+
+        BelId bel_id(i);
+        bel_by_name[bel.name] = bel_id;
+        Loc loc(bel.x, bel.y, bel.z);
+        bel_by_loc[loc] = bel_id;
+        if (int(bels_by_tile.size()) <= loc.x)
+            bels_by_tile.resize(loc.x + 1);
+        if (int(bels_by_tile[loc.x].size()) <= loc.y)
+            bels_by_tile[loc.x].resize(loc.y + 1);
+        bels_by_tile[loc.x][loc.y].push_back(bel_id);
+    }
+
+    read_csr_offsets(bel_pin_csr, 2);
+    for (uint32_t i = 0; i < bel_pin_csr.offsets.back(); i++) {
+        BelPin bel_pin;
+        bel_pin.bel = BelId(rd.i32());
+        bel_pin.pin = rd.id();
+        bel_pin_csr.data.push_back(bel_pin);
+    }
+    graph_frozen = true;
+
+    groups.clear();
+    uint32_t group_count = rd.count();
+    for (uint32_t i = 0; i < group_count; i++) {
+        auto &group = groups[rd.id_list()];
+        rd.index_list(group.bels);
+        rd.index_list(group.wires);
+        rd.index_list(group.pips);
+        uint32_t subgroup_count = rd.count();
+        for (uint32_t j = 0; j < subgroup_count; j++)
+            group.groups.push_back(rd.id_list());
+        group.decalxy = rd.decal();
+    }
+
+    decal_graphics.clear();
+    uint32_t decal_count = rd.count();
+    for (uint32_t i = 0; i < decal_count; i++) {
+        DecalId decal;
+        decal.name = rd.id_list();
+        decal.active = rd.u32();
+        auto &graphics = decal_graphics[decal];
+        graphics.resize(rd.count(8));
+        for (auto &g : graphics) {
+            g.type = GraphicElement::type_t(rd.u32());
+            g.style = GraphicElement::style_t(rd.u32());
+            g.x1 = rd.f32();
+            g.y1 = rd.f32();
+            g.x2 = rd.f32();
+            g.y2 = rd.f32();
+            g.z = rd.f32();
+            g.text = rd.str();
+        }
+    }
+
+    cellTiming.clear();
+    uint32_t cell_count = rd.count();
+    for (uint32_t i = 0; i < cell_count; i++) {
+        auto &tmg = cellTiming[rd.id()];
+        uint32_t port_count = rd.count(2);
+        for (uint32_t j = 0; j < port_count; j++) {
+            IdString port = rd.id();
+            tmg.portClasses[port] = TimingPortClass(rd.u32());
+        }
+        uint32_t arc_count = rd.count(6);
+        for (uint32_t j = 0; j < arc_count; j++) {
+            CellDelayKey arc;
+            arc.from = rd.id();
+            arc.to = rd.id();
+            tmg.combDelays[arc] = rd.delay_quad();
+        }
+        uint32_t clock_port_count = rd.count(2);
+        for (uint32_t j = 0; j < clock_port_count; j++) {
+            auto &infos = tmg.clockingInfo[rd.id()];
+            infos.resize(rd.count(10));
+            for (auto &info : infos) {
+                info.clock_port = rd.id();
+                info.edge = ClockEdge(rd.u32());
+                info.setup = rd.delay_pair();
+                info.hold = rd.delay_pair();
+                info.clockToQ = rd.delay_quad();
+            }
+        }
+    }
+
+    pip_by_name_pending = true;
+    if (rd.ptr != rd.end)
+        log_error("Device cache '%s' is corrupt.\n", filename.c_str());
+    if (uarch)
+        uarch->loadCacheData(uarch_data);
+    getCtx()->invalidateBelsForCellType();
+    refreshUi();
+    log_info("Loaded device from cache '%s'.\n", filename.c_str());
+    logGraphMemory();
+    return true;
+}
+
+NEXTPNR_NAMESPACE_END
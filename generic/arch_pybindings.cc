@@ -46,12 +46,13 @@ void arch_wrap_python(py::module &m)
     typedef linear_range<WireId> WireRange;
     typedef linear_range<PipId> AllPipRange;
 
-    typedef const std::vector<PipId> &UphillPipRange;
-    typedef const std::vector<PipId> &DownhillPipRange;
+    typedef array_range<PipId> PipRange;
+    typedef PipRange UphillPipRange;
+    typedef PipRange DownhillPipRange;
 
     typedef const std::vector<BelBucketId> &BelBucketRange;
     typedef const std::vector<BelId> &BelRangeForBelBucket;
-    typedef const std::vector<BelPin> &BelPinRange;
+    typedef array_range<BelPin> BelPinRange;
 
     auto arch_cls = py::class_<Arch, BaseCtx>(m, "Arch").def(py::init<ArchArgs>());
 
@@ -173,9 +174,17 @@ void arch_wrap_python(py::module &m)
                     conv_from_str<IdString>>::def_wrap(ctx_cls, "addCellBelPinMapping", "cell"_a, "cell_pin"_a,
                                                        "bel_pin"_a);
 
+    fn_wrapper_2a<Context, decltype(&Context::loadArchCache), &Context::loadArchCache, pass_through<bool>,
+                  pass_through<std::string>, pass_through<std::string>>::def_wrap(ctx_cls, "loadArchCache",
+                                                                                   "filename"_a, "key"_a);
+    fn_wrapper_2a_v<Context, decltype(&Context::saveArchCache), &Context::saveArchCache, pass_through<std::string>,
+                    pass_through<std::string>>::def_wrap(ctx_cls, "saveArchCache", "filename"_a, "key"_a);
+
     WRAP_RANGE(m, Bel, conv_to_str<BelId>);
     WRAP_RANGE(m, Wire, conv_to_str<WireId>);
     WRAP_RANGE(m, AllPip, conv_to_str<PipId>);
+    WRAP_RANGE(m, Pip, conv_to_str<PipId>);
+    WRAP_RANGE(m, BelPin, wrap_context<BelPin>);
 
     WRAP_MAP_UPTR(m, CellMap, "IdCellMap");
     WRAP_MAP_UPTR(m, NetMap, "IdNetMap");
@@ -103,6 +103,21 @@ template <> struct string_converter<BelPin>
     }
 };
 
+template <> struct string_converter<const BelPin &>
+{
+    BelPin from_str(Context *ctx, std::string name)
+    {
+        NPNR_ASSERT_FALSE("string_converter<BelPin>::from_str not implemented");
+    }
+
+    std::string to_str(Context *ctx, const BelPin &pin)
+    {
+        if (pin.bel == BelId())
+            throw bad_wrap();
+        return ctx->getBelName(pin.bel).str(ctx) + "/" + pin.pin.str(ctx);
+    }
+};
+
 } // namespace PythonConversion
 
 NEXTPNR_NAMESPACE_END
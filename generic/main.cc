@@ -50,6 +50,8 @@ po::options_description GenericCommandHandler::getArchOptions()
     specific.add_options()("uarch", po::value<std::string>(), uarch_help.c_str());
     specific.add_options()("no-iobs", "disable automatic IO buffer insertion");
     specific.add_options()("vopt,o", po::value<std::vector<std::string>>(), "options to pass to the viaduct uarch");
+    specific.add_options()("arch-cache", po::value<std::string>(),
+                           "cache the viaduct device in this file, and load it from there if still up to date");
 
     return specific;
 }
@@ -88,8 +90,10 @@ std::unique_ptr<Context> GenericCommandHandler::createContext(dict<std::string,
         ctx->uarch = std::move(uarch);
         if (vm.count("gui"))
             ctx->uarch->with_gui = true;
+        if (vm.count("arch-cache"))
+            ctx->uarch->arch_cache = vm["arch-cache"].as<std::string>();
         ctx->uarch->init(ctx.get());
-    } else if (vm.count("vopt")) {
+    } else if (vm.count("vopt") || vm.count("arch-cache")) {
         log_error("Viaduct options passed in non-viaduct mode!\n");
     } else if (vm.count("gui")) {
         log_error("nextpnr-generic GUI only supported in viaduct mode!\n");
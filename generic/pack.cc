@@ -273,6 +273,7 @@ static void pack_io(Context *ctx)
 bool Arch::pack()
 {
     Context *ctx = getCtx();
+    freezeGraph();
     try {
         log_break();
         if (uarch) {
@@ -38,11 +38,15 @@ struct ExampleImpl : ViaductAPI
         init_uarch_constids(ctx);
         ViaductAPI::init(ctx);
         h.init(ctx);
+        std::string cache_key = stringf("example X=%d Y=%d N=%d K=%d gui=%d", X, Y, N, K, with_gui);
+        if (ctx->loadArchCache(arch_cache, cache_key))
+            return;
         if (with_gui)
             init_bel_decals();
         init_wires();
         init_bels();
         init_pips();
+        ctx->saveArchCache(arch_cache, cache_key);
     }
 
     void pack() override
@@ -24,7 +24,9 @@
 #include "viaduct_api.h"
 #include "viaduct_helpers.h"
 
+#include <cstring>
 #include <fstream>
+#include <type_traits>
 
 #define GEN_INIT_CONSTIDS
 #define VIADUCT_CONSTIDS "viaduct/fabulous/constids.inc"
@@ -68,18 +70,81 @@ struct FabulousImpl : ViaductAPI
             is_new_fab = false;
         log_info("Detected FABulous %s format project.\n", is_new_fab ? "2.0" : "1.0");
         init_default_ctrlset_cfg();
-        // To consider: a faster serialised form of the device data (like bba that other arches use) so we don't have to
-        // go through the whole csv parsing malarkey each time
         blk_trk = std::make_unique<BlockTracker>(ctx, cfg);
-        is_new_fab ? init_bels_v2() : init_bels_v1();
-        init_pips();
-        init_pseudo_constant_wires();
-        setup_lut_permutation();
+        // With --arch-cache, the whole csv parsing malarkey only needs to be done when the fabric changes
+        std::string cache_key = get_cache_key();
+        if (!ctx->loadArchCache(arch_cache, cache_key)) {
+            is_new_fab ? init_bels_v2() : init_bels_v1();
+            init_pips();
+            init_pseudo_constant_wires();
+            setup_lut_permutation();
+            ctx->saveArchCache(arch_cache, cache_key);
+        }
         ctx->setDelayScaling(3.0, 3.0);
         ctx->delay_epsilon = 0.25;
         ctx->ripup_penalty = 0.5;
     }
 
+    std::string get_cache_key()
+    {
+        if (arch_cache.empty())
+            return "";
+        // Hash the contents of the data files rather than using timestamps, so that regenerating an unchanged fabric
+        // doesn't invalidate the cache
+        auto file_hash = [&](const std::string &postfix) {
+            std::ifstream in = open_data_rel(postfix);
+            uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+            std::vector<char> buf(1 << 16);
+            while (in.read(buf.data(), buf.size()) || in.gcount() > 0) {
+                for (std::streamsize i = 0; i < in.gcount(); i++)
+                    hash = (hash ^ uint8_t(buf[i])) * 0x100000001b3ULL;
+            }
+            return stringf("%016llx", (unsigned long long)hash);
+        };
+        std::string bels_hash = file_hash(is_new_fab ? "/.FABulous/bel.v2.txt" : "/npnroutput/bel.txt");
+        std::string pips_hash = file_hash(is_new_fab ? "/.FABulous/pips.txt" : "/npnroutput/pips.txt");
+        return stringf("fabulous v%d lut_k=%d bels=%s pips=%s", is_new_fab ? 2 : 1, int(cfg.clb.lut_k),
+                       bels_hash.c_str(), pips_hash.c_str());
+    }
+
+    void saveCacheData(std::vector<uint8_t> &data) const override
+    {
+        static_assert(std::is_trivially_copyable<PseudoPipTags>::value, "PseudoPipTags must be trivially copyable");
+        static_assert(std::is_trivially_copyable<BelFlags>::value, "BelFlags must be trivially copyable");
+        auto append = [&](const void *ptr, size_t size) {
+            auto bytes = reinterpret_cast<const uint8_t *>(ptr);
+            data.insert(data.end(), bytes, bytes + size);
+        };
+        uint32_t pp_count = pp_tags.size(), bel_count = blk_trk->bel_data.size();
+        append(&pp_count, sizeof(pp_count));
+        append(pp_tags.data(), pp_count * sizeof(PseudoPipTags));
+        append(&bel_count, sizeof(bel_count));
+        append(blk_trk->bel_data.data(), bel_count * sizeof(BelFlags));
+    }
+
+    void loadCacheData(const std::vector<uint8_t> &data) override
+    {
+        size_t pos = 0;
+        auto extract = [&](void *ptr, size_t size) {
+            NPNR_ASSERT(pos + size <= data.size());
+            memcpy(ptr, data.data() + pos, size);
+            pos += size;
+        };
+        uint32_t count;
+        extract(&count, sizeof(count));
+        pp_tags.resize(count);
+        extract(pp_tags.data(), count * sizeof(PseudoPipTags));
+        extract(&count, sizeof(count));
+        std::vector<BelFlags> bel_data(count);
+        extract(bel_data.data(), count * sizeof(BelFlags));
+        // Replaying set_bel_type also creates the per-tile block state
+        for (int i = 0; i < int(count); i++) {
+            auto &flags = bel_data.at(i);
+            if (flags.block != BelFlags::BLOCK_OTHER)
+                blk_trk->set_bel_type(BelId(i), flags.block, flags.func, flags.index);
+        }
+    }
+
     void init_default_ctrlset_cfg()
     {
         // TODO: loading from file or something
@@ -209,7 +274,7 @@ struct FabulousImpl : ViaductAPI
             }
         } else if (bel_type.in(id_InPass4_frame_config, id_OutPass4_frame_config)) {
             WireId clk_wire = get_wire(tile, id_CLK, id_REG_CLK);
-            if (ctx->wires.at(clk_wire.index).uphill.empty()) {
+            if (ctx->getPipsUphill(clk_wire).empty()) {
                 add_pseudo_pip(global_clk_wire, clk_wire, id_global_clock);
             }
             ctx->addBelInput(bel, id_CLK, clk_wire);
@@ -477,6 +542,8 @@ struct FabulousImpl : ViaductAPI
 
     void remove_bel_pin(BelId bel, IdString pin)
     {
+        // Edits the per-wire bel pin lists directly
+        ctx->thawGraph();
         auto &bel_data = ctx->bel_info(bel);
         auto &wire_data = ctx->wire_info(ctx->getBelPinWire(bel, pin));
         std::vector<BelPin> new_wire_pins;
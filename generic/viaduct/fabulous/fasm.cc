@@ -20,11 +20,13 @@
 #include "fasm.h"
 #include "log.h"
 #include "nextpnr.h"
+#include "parallel_chunks.h"
 #include "util.h"
 
 #include <algorithm>
 #include <boost/range/adaptor/reversed.hpp>
 #include <fstream>
+#include <sstream>
 
 #define VIADUCT_CONSTIDS "viaduct/fabulous/constids.inc"
 #include "viaduct_constids.h"
@@ -35,11 +37,9 @@ namespace {
 struct FabFasmWriter
 {
     FabFasmWriter(const Context *ctx, const FabricConfig &cfg, const std::vector<PseudoPipTags> &pip_tags,
-                  const std::string &filename)
-            : ctx(ctx), cfg(cfg), pip_tags(pip_tags), out(filename)
+                  std::ostream &out)
+            : ctx(ctx), cfg(cfg), pip_tags(pip_tags), out(out)
     {
-        if (!out)
-            log_error("failed to open fasm file '%s' for writing\n", filename.c_str());
     }
     std::string format_name(IdStringList name)
     {
@@ -260,8 +260,20 @@ struct FabFasmWriter
 
     void write_fasm()
     {
+        // Routing is written in chunks of nets on worker threads, each with its own writer and buffer, and then
+        // emitted in net order
+        std::vector<const NetInfo *> nets;
         for (const auto &net : ctx->nets)
-            write_routing(net.second.get());
+            nets.push_back(net.second.get());
+        auto write_nets = [&](int begin, int end, std::string &buffer) {
+            std::ostringstream chunk_out;
+            FabFasmWriter chunk_writer(ctx, cfg, pip_tags, chunk_out);
+            for (int i = begin; i < end; i++)
+                chunk_writer.write_routing(nets.at(i));
+            buffer = chunk_out.str();
+        };
+        for (auto &buffer : parallel_chunks<std::string>(ctx, int(nets.size()), 100, write_nets))
+            out << buffer;
         for (const auto &cell : ctx->cells)
             write_cell(cell.second.get());
     }
@@ -269,14 +281,17 @@ struct FabFasmWriter
     const Context *ctx;
     const FabricConfig &cfg;
     const std::vector<PseudoPipTags> &pip_tags;
-    std::ofstream out;
+    std::ostream &out;
 };
 } // namespace
 
 void fabulous_write_fasm(const Context *ctx, const FabricConfig &cfg, const std::vector<PseudoPipTags> &pip_tags,
                          const std::string &filename)
 {
-    FabFasmWriter wr(ctx, cfg, pip_tags, filename);
+    std::ofstream out(filename);
+    if (!out)
+        log_error("failed to open fasm file '%s' for writing\n", filename.c_str());
+    FabFasmWriter wr(ctx, cfg, pip_tags, out);
     wr.write_fasm();
 }
 
@@ -39,9 +39,14 @@ struct OkamiImpl : ViaductAPI
         init_uarch_constids(ctx);
         ViaductAPI::init(ctx);
         h.init(ctx);
+        std::string cache_key = stringf("okami X=%d Y=%d N=%d K=%d in=%d out=%d", X, Y, N, K, InputMuxCount,
+                                        OutputMuxCount);
+        if (ctx->loadArchCache(arch_cache, cache_key))
+            return;
         init_wires();
         init_bels();
         init_pips();
+        ctx->saveArchCache(arch_cache, cache_key);
     }
 
     void pack() override
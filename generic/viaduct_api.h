@@ -56,6 +56,8 @@ struct ViaductAPI
     virtual void init(Context *ctx);
     Context *ctx;
     bool with_gui = false;
+    // Device cache file from --arch-cache, or empty
+    std::string arch_cache;
 
     // --- Bel functions ---
     // Called when a bel is placed/unplaced (with cell=nullptr for a unbind)
@@ -85,6 +87,14 @@ struct ViaductAPI
     virtual delay_t predictDelay(BelId src_bel, IdString src_pin, BelId dst_bel, IdString dst_pin) const;
     virtual BoundingBox getRouteBoundingBox(WireId src, WireId dst) const;
 
+    // --- Device cache ---
+    // Uarches that support caching call ctx->loadArchCache(arch_cache, key) in init() after registering their constids
+    // and skip building the device if it succeeds; otherwise they call ctx->saveArchCache(arch_cache, key) once it is
+    // built. The key must cover the uarch options and the contents of any files the device is built from.
+    // Uarch state that is created along with the device and still needed after init() is stored in the cache by these
+    virtual void saveCacheData(std::vector<uint8_t> &data) const {}
+    virtual void loadCacheData(const std::vector<uint8_t> &data) {}
+
     // --- Flow hooks ---
     virtual void pack(){}; // replaces the pack function
     // Called before and after main placement and routing
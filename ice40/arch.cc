@@ -197,21 +197,43 @@ IdString Arch::archArgsToId(ArchArgs args) const
 
 // -----------------------------------------------------------------------
 
+int Arch::name_tile(IdStringList name) const
+{
+    if (name.size() != 3)
+        return -1;
+    auto fnd_x = id_to_x.find(name[0]), fnd_y = id_to_y.find(name[1]);
+    if (fnd_x == id_to_x.end() || fnd_y == id_to_y.end())
+        return -1;
+    return fnd_y->second * chip_info->width + fnd_x->second;
+}
+
 BelId Arch::getBelByName(IdStringList name) const
 {
     BelId ret;
 
-    if (bel_by_name.empty()) {
-        for (size_t i = 0; i < chip_info->bel_data.size(); i++) {
-            BelId b;
-            b.index = i;
-            bel_by_name[getBelName(b)] = i;
+    int tile = name_tile(name);
+    if (tile == -1)
+        return ret;
+
+    // Only the x and y of each bel are read to find the bels of each tile, and the name index of a tile is built the
+    // first time a name in it is looked up
+    if (bels_by_name_tile.empty()) {
+        bels_by_name_tile.resize(chip_info->width * chip_info->height);
+        bel_index_by_name_tile.resize(chip_info->width * chip_info->height);
+        for (int i = 0; i < chip_info->bel_data.ssize(); i++) {
+            auto &data = chip_info->bel_data[i];
+            bels_by_name_tile.at(data.y * chip_info->width + data.x).push_back(i);
         }
     }
 
-    auto it = bel_by_name.find(name);
-    if (it != bel_by_name.end())
-        ret.index = it->second;
+    auto &index = bel_index_by_name_tile.at(tile);
+    if (index.empty()) {
+        for (int32_t bel : bels_by_name_tile.at(tile))
+            index[id(chip_info->bel_data[bel].name.get())] = bel;
+    }
+    auto fnd = index.find(name[2]);
+    if (fnd != index.end())
+        ret.index = fnd->second;
 
     return ret;
 }
@@ -362,20 +384,36 @@ bool Arch::is_bel_locked(BelId bel) const
 // -----------------------------------------------------------------------
 
 WireId Arch::getWireByName(IdStringList name) const
+{
+    int tile = name_tile(name);
+    if (tile == -1)
+        return WireId();
+    return wire_by_tile_name(tile % chip_info->width, tile / chip_info->width, name[2]);
+}
+
+WireId Arch::wire_by_tile_name(int x, int y, IdString name) const
 {
     WireId ret;
 
-    if (wire_by_name.empty()) {
+    // As for bels, indexed by the x and y in the wire name
+    if (wires_by_name_tile.empty()) {
+        wires_by_name_tile.resize(chip_info->width * chip_info->height);
+        wire_index_by_name_tile.resize(chip_info->width * chip_info->height);
         for (int i = 0; i < chip_info->wire_data.ssize(); i++) {
-            WireId w;
-            w.index = i;
-            wire_by_name[getWireName(w)] = i;
+            auto &data = chip_info->wire_data[i];
+            wires_by_name_tile.at(data.name_y * chip_info->width + data.name_x).push_back(i);
         }
     }
 
-    auto it = wire_by_name.find(name);
-    if (it != wire_by_name.end())
-        ret.index = it->second;
+    int tile = y * chip_info->width + x;
+    auto &index = wire_index_by_name_tile.at(tile);
+    if (index.empty()) {
+        for (int32_t wire : wires_by_name_tile.at(tile))
+            index[id(chip_info->wire_data[wire].name.get())] = wire;
+    }
+    auto fnd = index.find(name);
+    if (fnd != index.end())
+        ret.index = fnd->second;
 
     return ret;
 }
@@ -436,21 +474,39 @@ std::vector<std::pair<IdString, std::string>> Arch::getWireAttrs(WireId wire) co
 
 PipId Arch::getPipByName(IdStringList name) const
 {
-    PipId ret;
+    // Pip names are made up of the names of their source and destination wires. Rather than building a map of every
+    // pip name in the device (by far the largest of the name maps), find the two wires and search the uphill pips of
+    // the destination.
+    if (name.size() != 3)
+        return PipId();
+    const std::string &pip_name = name[2].str(this);
+    size_t sep = pip_name.find(".->.");
+    if (sep == std::string::npos)
+        return PipId();
+
+    // Wires in pip names are of the form x.y.name
+    auto parse_wire = [&](const std::string &wire_name) {
+        size_t dot_x = wire_name.find('.');
+        size_t dot_y = (dot_x == std::string::npos) ? dot_x : wire_name.find('.', dot_x + 1);
+        if (dot_y == std::string::npos)
+            return WireId();
+        int x = std::atoi(wire_name.substr(0, dot_x).c_str());
+        int y = std::atoi(wire_name.substr(dot_x + 1, dot_y - dot_x - 1).c_str());
+        if (x < 0 || x >= chip_info->width || y < 0 || y >= chip_info->height)
+            return WireId();
+        return wire_by_tile_name(x, y, id(wire_name.substr(dot_y + 1)));
+    };
 
-    if (pip_by_name.empty()) {
-        for (int i = 0; i < chip_info->pip_data.ssize(); i++) {
-            PipId pip;
-            pip.index = i;
-            pip_by_name[getPipName(pip)] = i;
-        }
+    WireId src = parse_wire(pip_name.substr(0, sep));
+    WireId dst = parse_wire(pip_name.substr(sep + 4));
+    if (src == WireId() || dst == WireId())
+        return PipId();
+    for (PipId pip : getPipsUphill(dst)) {
+        auto &pd = chip_info->pip_data[pip.index];
+        if (pd.src == src.index && x_ids.at(pd.x) == name[0] && y_ids.at(pd.y) == name[1])
+            return pip;
     }
-
-    auto it = pip_by_name.find(name);
-    if (it != pip_by_name.end())
-        ret.index = it->second;
-
-    return ret;
+    return PipId();
 }
 
 IdStringList Arch::getPipName(PipId pip) const
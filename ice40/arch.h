@@ -400,9 +400,11 @@ struct Arch : BaseArch<ArchRanges>
     const ChipInfoPOD *chip_info;
     const PackageInfoPOD *package_info;
 
-    mutable dict<IdStringList, int> bel_by_name;
-    mutable dict<IdStringList, int> wire_by_name;
-    mutable dict<IdStringList, int> pip_by_name;
+    // bels and wires by the tile in their name, built on first name lookup, and a name to index map for each tile,
+    // built the first time a name in that tile is looked up
+    mutable std::vector<std::vector<int32_t>> bels_by_name_tile;
+    mutable std::vector<std::vector<int32_t>> wires_by_name_tile;
+    mutable std::vector<dict<IdString, int32_t>> bel_index_by_name_tile, wire_index_by_name_tile;
     mutable dict<Loc, int> bel_by_loc;
 
     std::vector<bool> bel_carry;
@@ -416,6 +418,10 @@ struct Arch : BaseArch<ArchRanges>
     // inverse of the above for name->object mapping
     dict<IdString, int> id_to_x, id_to_y;
 
+    // tile index from the X and Y parts of a bel or wire name, or -1 if they are not valid
+    int name_tile(IdStringList name) const;
+    WireId wire_by_tile_name(int x, int y, IdString name) const;
+
     ArchArgs args;
     Arch(ArchArgs args);
 
@@ -18,6 +18,7 @@
  *
  */
 
+#include <chrono>
 #include <iostream>
 #include <math.h>
 #include "embed.h"
@@ -85,6 +86,7 @@ static void get_chip_info(std::string device, const ChipInfoPOD **chip_info, con
 
 Arch::Arch(ArchArgs args) : args(args)
 {
+    auto setup_start = std::chrono::high_resolution_clock::now();
     get_chip_info(args.device, &chip_info, &package_info, &device_name, &package_name);
     if (chip_info == nullptr)
         log_error("Unsupported MachXO2 chip type.\n");
@@ -94,14 +96,12 @@ Arch::Arch(ArchArgs args) : args(args)
 
     if (!package_info)
         log_error("Unsupported package '%s' for '%s'.\n", package_name, getChipName().c_str());
+    auto chipdb_end = std::chrono::high_resolution_clock::now();
 
+    // Bels, wires and pips are bound through the BaseArch maps, so there is no per-tile state to set up here
     BaseArch::init_cell_types();
     BaseArch::init_bel_buckets();
-
-    for (int i = 0; i < chip_info->width; i++)
-        x_ids.push_back(idf("X%d", i));
-    for (int i = 0; i < chip_info->height; i++)
-        y_ids.push_back(idf("Y%d", i));
+    auto cell_types_end = std::chrono::high_resolution_clock::now();
 
     for (int i = 0; i < chip_info->width; i++) {
         IdString x_id = idf("X%d", i);
@@ -113,6 +113,14 @@ Arch::Arch(ArchArgs args) : args(args)
         y_ids.push_back(y_id);
         id_to_y[y_id] = i;
     }
+
+    bel_index_by_name.resize(chip_info->num_tiles);
+    wire_index_by_name.resize(chip_info->num_tiles);
+
+    auto setup_end = std::chrono::high_resolution_clock::now();
+    auto secs = [](auto start, auto end) { return std::chrono::duration<float>(end - start).count(); };
+    log_info("Set up %s in %.02fs (chipdb %.02fs, cell types %.02fs)\n", getChipName().c_str(),
+             secs(setup_start, setup_end), secs(setup_start, chipdb_end), secs(chipdb_end, cell_types_end));
 }
 
 void Arch::list_devices()
@@ -154,14 +162,17 @@ BelId Arch::getBelByName(IdStringList name) const
     loc.x = id_to_x.at(name[0]);
     loc.y = id_to_y.at(name[1]);
     ret.location = loc;
-    const TileTypePOD *loci = tile_info(ret);
-    for (int i = 0; i < loci->bel_data.ssize(); i++) {
-        if (std::strcmp(loci->bel_data[i].name.get(), name[2].c_str(this)) == 0) {
-            ret.index = i;
-            return ret;
-        }
+    auto &index = bel_index_by_name.at(loc.y * chip_info->width + loc.x);
+    if (index.empty()) {
+        const TileTypePOD *loci = tile_info(ret);
+        for (int i = 0; i < loci->bel_data.ssize(); i++)
+            index[id(loci->bel_data[i].name.get())] = i;
     }
-    return BelId();
+    auto fnd = index.find(name[2]);
+    if (fnd == index.end())
+        return BelId();
+    ret.index = fnd->second;
+    return ret;
 }
 
 BelId Arch::getBelByLocation(Loc loc) const
@@ -273,14 +284,17 @@ WireId Arch::getWireByName(IdStringList name) const
     loc.x = id_to_x.at(name[0]);
     loc.y = id_to_y.at(name[1]);
     ret.location = loc;
-    const TileTypePOD *loci = tile_info(ret);
-    for (int i = 0; i < loci->wire_data.ssize(); i++) {
-        if (std::strcmp(loci->wire_data[i].name.get(), name[2].c_str(this)) == 0) {
-            ret.index = i;
-            return ret;
-        }
+    auto &index = wire_index_by_name.at(loc.y * chip_info->width + loc.x);
+    if (index.empty()) {
+        const TileTypePOD *loci = tile_info(ret);
+        for (int i = 0; i < loci->wire_data.ssize(); i++)
+            index[id(loci->wire_data[i].name.get())] = i;
     }
-    return WireId();
+    auto fnd = index.find(name[2]);
+    if (fnd == index.end())
+        return WireId();
+    ret.index = fnd->second;
+    return ret;
 }
 
 // ---------------------------------------------------------------
@@ -375,6 +375,8 @@ struct Arch : BaseArch<ArchRanges>
     const char *device_name;
 
     mutable dict<IdStringList, PipId> pip_by_name;
+    // Per tile maps from bel and wire name to index, each built the first time a name in that tile is looked up
+    mutable std::vector<dict<IdString, int>> bel_index_by_name, wire_index_by_name;
 
     // fast access to  X and Y IdStrings for building object names
     std::vector<IdString> x_ids, y_ids;
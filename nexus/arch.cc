@@ -19,6 +19,7 @@
  */
 
 #include <boost/algorithm/string.hpp>
+#include <chrono>
 
 #include "embed.h"
 #include "log.h"
@@ -47,6 +48,7 @@ void IdString::initialize_arch(const BaseCtx *ctx)
 
 Arch::Arch(ArchArgs args) : args(args)
 {
+    auto setup_start = std::chrono::high_resolution_clock::now();
     // Parse device string
     if (boost::starts_with(args.device, "LIFCL")) {
         family = "LIFCL";
@@ -105,11 +107,9 @@ Arch::Arch(ArchArgs args) : args(args)
     for (size_t i = 0; i < db->ids->bba_id_strs.size(); i++) {
         IdString::initialize_add(this, db->ids->bba_id_strs[i].get(), uint32_t(i) + db->ids->num_file_ids);
     }
-    // Set up validity structures
+    auto chipdb_end = std::chrono::high_resolution_clock::now();
+    // Set up validity structures; the binding arrays of each tile are allocated on first use
     tileStatus.resize(chip_info->grid.size());
-    for (size_t i = 0; i < chip_info->grid.size(); i++) {
-        tileStatus[i].boundcells.resize(db->loctypes[chip_info->grid[i].loc_type].bels.size());
-    }
     // This structure is needed for a fast getBelByLocation because bels can have an offset
     for (size_t i = 0; i < chip_info->grid.size(); i++) {
         auto &loc = db->loctypes[chip_info->grid[i].loc_type];
@@ -124,10 +124,8 @@ Arch::Arch(ArchArgs args) : args(args)
             ts.bels_by_z[bel.z].tile = i;
             ts.bels_by_z[bel.z].index = j;
         }
-        auto &ts = tileStatus.at(i);
-        ts.boundwires.resize(loc.wires.size());
-        ts.boundpips.resize(loc.pips.size());
     }
+    auto tile_index_end = std::chrono::high_resolution_clock::now();
 
     for (int i = 0; i < chip_info->width; i++) {
         IdString x_id = idf("X%d", i);
@@ -179,6 +177,7 @@ Arch::Arch(ArchArgs args) : args(args)
 
     BaseArch::init_cell_types();
     BaseArch::init_bel_buckets();
+    auto cell_types_end = std::chrono::high_resolution_clock::now();
 
     if (device == "LIFCL-17") {
         for (BelId bel : getBelsByTile(37, 10)) {
@@ -197,6 +196,12 @@ Arch::Arch(ArchArgs args) : args(args)
             disabled_pips.insert(dcs_pip);
         NPNR_ASSERT(disabled_pips.size() == 6);
     }
+
+    auto setup_end = std::chrono::high_resolution_clock::now();
+    auto secs = [](auto start, auto end) { return std::chrono::duration<float>(end - start).count(); };
+    log_info("Set up %s in %.02fs (chipdb %.02fs, tile index %.02fs, cell types %.02fs)\n", args.device.c_str(),
+             secs(setup_start, setup_end), secs(setup_start, chipdb_end), secs(chipdb_end, tile_index_end),
+             secs(tile_index_end, cell_types_end));
 }
 
 void Arch::list_devices()
@@ -909,15 +909,30 @@ struct Arch : BaseArch<ArchRanges>
 
     struct TileStatus
     {
+        // Allocated on first bind (see bind_tile_status), as a small design on a large device only uses a few tiles
         std::vector<CellInfo *> boundcells;
-        std::vector<BelId> bels_by_z;
         std::vector<NetInfo *> boundwires, boundpips;
+        bool bindings_allocated = false;
+        std::vector<BelId> bels_by_z;
         LogicTileStatus *lts = nullptr;
         ~TileStatus() { delete lts; }
     };
 
     std::vector<TileStatus> tileStatus;
 
+    TileStatus &bind_tile_status(int32_t tile)
+    {
+        auto &ts = tileStatus.at(tile);
+        if (!ts.bindings_allocated) {
+            auto &loc = db->loctypes[chip_info->grid[tile].loc_type];
+            ts.boundcells.resize(loc.bels.size());
+            ts.boundwires.resize(loc.wires.size());
+            ts.boundpips.resize(loc.pips.size());
+            ts.bindings_allocated = true;
+        }
+        return ts;
+    }
+
     // fast access to  X and Y IdStrings for building object names
     std::vector<IdString> x_ids, y_ids;
     // inverse of the above for name->object mapping
@@ -953,8 +968,9 @@ struct Arch : BaseArch<ArchRanges>
     void bindBel(BelId bel, CellInfo *cell, PlaceStrength strength) override
     {
         NPNR_ASSERT(bel != BelId());
-        NPNR_ASSERT(tileStatus[bel.tile].boundcells[bel.index] == nullptr);
-        tileStatus[bel.tile].boundcells[bel.index] = cell;
+        auto &slot = bind_tile_status(bel.tile).boundcells.at(bel.index);
+        NPNR_ASSERT(slot == nullptr);
+        slot = cell;
         cell->bel = bel;
         cell->belStrength = strength;
         refreshUiBel(bel);
@@ -966,21 +982,21 @@ struct Arch : BaseArch<ArchRanges>
     void unbindBel(BelId bel) override
     {
         NPNR_ASSERT(bel != BelId());
-        NPNR_ASSERT(tileStatus[bel.tile].boundcells[bel.index] != nullptr);
+        auto &slot = bind_tile_status(bel.tile).boundcells.at(bel.index);
+        NPNR_ASSERT(slot != nullptr);
 
         if (bel_tile_is(bel, LOC_LOGIC))
             update_logic_bel(bel, nullptr);
 
-        tileStatus[bel.tile].boundcells[bel.index]->bel = BelId();
-        tileStatus[bel.tile].boundcells[bel.index]->belStrength = STRENGTH_NONE;
-        tileStatus[bel.tile].boundcells[bel.index] = nullptr;
+        slot->bel = BelId();
+        slot->belStrength = STRENGTH_NONE;
+        slot = nullptr;
         refreshUiBel(bel);
     }
 
     bool checkBelAvail(BelId bel) const override
     {
-        NPNR_ASSERT(bel != BelId());
-        return tileStatus[bel.tile].boundcells[bel.index] == nullptr;
+        return getBoundBelCell(bel) == nullptr;
     }
 
     bool is_pseudo_pip_disabled(PipId pip) const
@@ -1031,7 +1047,8 @@ struct Arch : BaseArch<ArchRanges>
     CellInfo *getBoundBelCell(BelId bel) const override
     {
         NPNR_ASSERT(bel != BelId());
-        return tileStatus[bel.tile].boundcells[bel.index];
+        auto &ts = tileStatus[bel.tile];
+        return ts.bindings_allocated ? ts.boundcells[bel.index] : nullptr;
     }
 
     BelRange getBels() const override
@@ -1141,7 +1158,7 @@ struct Arch : BaseArch<ArchRanges>
     void bindWire(WireId wire, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = tileStatus.at(wire.tile).boundwires.at(wire.index);
+        auto &w2n_entry = bind_tile_status(wire.tile).boundwires.at(wire.index);
         NPNR_ASSERT(w2n_entry == nullptr);
         net->wires[wire].pip = PipId();
         net->wires[wire].strength = strength;
@@ -1151,7 +1168,7 @@ struct Arch : BaseArch<ArchRanges>
     void unbindWire(WireId wire) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = tileStatus.at(wire.tile).boundwires.at(wire.index);
+        auto &w2n_entry = bind_tile_status(wire.tile).boundwires.at(wire.index);
         NPNR_ASSERT(w2n_entry != nullptr);
 
         auto &net_wires = w2n_entry->wires;
@@ -1160,7 +1177,7 @@ struct Arch : BaseArch<ArchRanges>
 
         auto pip = it->second.pip;
         if (pip != PipId()) {
-            tileStatus.at(pip.tile).boundpips.at(pip.index) = nullptr;
+            bind_tile_status(pip.tile).boundpips.at(pip.index) = nullptr;
         }
 
         net_wires.erase(it);
@@ -1168,7 +1185,11 @@ struct Arch : BaseArch<ArchRanges>
         this->refreshUiWire(wire);
     }
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
-    NetInfo *getBoundWireNet(WireId wire) const override { return tileStatus.at(wire.tile).boundwires.at(wire.index); }
+    NetInfo *getBoundWireNet(WireId wire) const override
+    {
+        auto &ts = tileStatus.at(wire.tile);
+        return ts.bindings_allocated ? ts.boundwires.at(wire.index) : nullptr;
+    }
 
     // -------------------------------------------------
 
@@ -1258,12 +1279,12 @@ struct Arch : BaseArch<ArchRanges>
     {
         NPNR_ASSERT(pip != PipId());
 
-        auto &p2n_entry = tileStatus.at(pip.tile).boundpips.at(pip.index);
+        auto &p2n_entry = bind_tile_status(pip.tile).boundpips.at(pip.index);
         NPNR_ASSERT(p2n_entry == nullptr);
         p2n_entry = net;
 
         WireId dst = this->getPipDstWire(pip);
-        auto &w2n_entry = tileStatus.at(dst.tile).boundwires.at(dst.index);
+        auto &w2n_entry = bind_tile_status(dst.tile).boundwires.at(dst.index);
         NPNR_ASSERT(w2n_entry == nullptr);
         w2n_entry = net;
         net->wires[dst].pip = pip;
@@ -1274,11 +1295,11 @@ struct Arch : BaseArch<ArchRanges>
     {
         NPNR_ASSERT(pip != PipId());
 
-        auto &p2n_entry = tileStatus.at(pip.tile).boundpips.at(pip.index);
+        auto &p2n_entry = bind_tile_status(pip.tile).boundpips.at(pip.index);
         NPNR_ASSERT(p2n_entry != nullptr);
         WireId dst = this->getPipDstWire(pip);
 
-        auto &w2n_entry = tileStatus.at(dst.tile).boundwires.at(dst.index);
+        auto &w2n_entry = bind_tile_status(dst.tile).boundwires.at(dst.index);
         NPNR_ASSERT(w2n_entry != nullptr);
         w2n_entry = nullptr;
 
@@ -1286,7 +1307,11 @@ struct Arch : BaseArch<ArchRanges>
         p2n_entry = nullptr;
     }
 
-    NetInfo *getBoundPipNet(PipId pip) const override { return tileStatus.at(pip.tile).boundpips.at(pip.index); }
+    NetInfo *getBoundPipNet(PipId pip) const override
+    {
+        auto &ts = tileStatus.at(pip.tile);
+        return ts.bindings_allocated ? ts.boundpips.at(pip.index) : nullptr;
+    }
 
     // -------------------------------------------------
 
@@ -20,11 +20,13 @@
 
 #include "log.h"
 #include "nextpnr.h"
+#include "parallel_chunks.h"
 #include "util.h"
 
 #include <boost/range/adaptor/reversed.hpp>
 #include <queue>
 #include <set>
+#include <sstream>
 
 NEXTPNR_NAMESPACE_BEGIN
 namespace {
@@ -1056,10 +1058,21 @@ struct NexusFasmWriter
         write_attribute("oxide.device", ctx->device);
         write_attribute("oxide.device_variant", ctx->variant);
         blank();
-        // Write routing
-        for (auto &n : ctx->nets) {
-            write_net(n.second.get());
-        }
+        // Write routing. Chunks of nets are written into buffers on worker threads, each by its own writer. Every net
+        // starts and ends with an empty prefix stack after a blank line, so this gives the same output as writing the
+        // nets in order.
+        std::vector<const NetInfo *> nets;
+        for (auto &n : ctx->nets)
+            nets.push_back(n.second.get());
+        auto write_nets = [&](int begin, int end, std::string &buffer) {
+            std::ostringstream chunk_out;
+            NexusFasmWriter chunk_writer(ctx, chunk_out);
+            for (int i = begin; i < end; i++)
+                chunk_writer.write_net(nets.at(i));
+            buffer = chunk_out.str();
+        };
+        for (auto &buffer : parallel_chunks<std::string>(ctx, int(nets.size()), 100, write_nets))
+            out << buffer;
         // Write cell config
         for (auto &c : ctx->cells) {
             const CellInfo *ci = c.second.get();
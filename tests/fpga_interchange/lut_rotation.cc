@@ -0,0 +1,302 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2021  Symbiflow Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "luts.h"
+
+USING_NEXTPNR_NAMESPACE
+
+namespace {
+
+enum LogicLevel
+{
+    LL_Zero,
+    LL_One,
+    LL_DontCare
+};
+
+// The per-address rotation that rotate_and_merge_lut_equation replaced, kept
+// as the reference.  The only change is that the BEL address is offset by
+// low_bit without touching the loop counter.
+bool reference_rotate_and_merge(std::vector<LogicLevel> *result, const LutBel &lut_bel,
+                                const DynamicBitarray<> &old_equation, const std::vector<int32_t> &pin_map,
+                                uint32_t used_pins)
+{
+    size_t bel_width = 1 << lut_bel.pins.size();
+    for (size_t bel_address = 0; bel_address < bel_width; ++bel_address) {
+        bool address_reachable = true;
+        size_t cell_address = 0;
+        for (size_t bel_pin_idx = 0; bel_pin_idx < lut_bel.pins.size(); ++bel_pin_idx) {
+            if ((bel_address & (1 << bel_pin_idx)) == 0) {
+                if ((used_pins & (1 << bel_pin_idx)) == 0) {
+                    address_reachable = false;
+                    break;
+                }
+
+                continue;
+            }
+
+            auto cell_pin_idx = pin_map[bel_pin_idx];
+            if (cell_pin_idx < 0) {
+                continue;
+            }
+
+            cell_address |= (1 << cell_pin_idx);
+        }
+
+        if (!address_reachable) {
+            continue;
+        }
+
+        size_t element_address = bel_address + lut_bel.low_bit;
+        if (old_equation.get(cell_address)) {
+            if ((*result)[element_address] == LL_Zero) {
+                return false;
+            }
+
+            (*result)[element_address] = LL_One;
+        } else {
+            if ((*result)[element_address] == LL_One) {
+                return false;
+            }
+            (*result)[element_address] = LL_Zero;
+        }
+    }
+
+    return true;
+}
+
+LogicLevel level_at(const LutEquation &equation, size_t address)
+{
+    if ((equation.care & (1ull << address)) == 0) {
+        return LL_DontCare;
+    }
+    return (equation.value & (1ull << address)) ? LL_One : LL_Zero;
+}
+
+class LutRotationTest : public ::testing::Test
+{
+  protected:
+    std::mt19937_64 rng{1};
+
+    int rand_int(int n) { return std::uniform_int_distribution<int>(0, n - 1)(rng); }
+
+    // A LUT BEL with num_pins inputs somewhere in a 64 bit element.
+    LutBel make_lut_bel(size_t num_pins)
+    {
+        LutBel lut_bel;
+        for (size_t i = 0; i < num_pins; ++i) {
+            lut_bel.pins.push_back(IdString(1000 + i));
+            lut_bel.pin_to_index[lut_bel.pins.back()] = i;
+        }
+        size_t width = size_t(1) << num_pins;
+        lut_bel.low_bit = rand_int(64 / width) * width;
+        lut_bel.high_bit = lut_bel.low_bit + width - 1;
+        return lut_bel;
+    }
+
+    // A random cell equation with up to as many pins as the BEL.  Some of the
+    // cell pins may be left off the BEL (and so tied low).
+    void make_cell(const LutBel &lut_bel, LutCell *cell, std::vector<int32_t> *pin_map)
+    {
+        size_t num_pins = lut_bel.pins.size();
+        size_t cell_pins = 1 + rand_int(num_pins);
+
+        cell->pins.clear();
+        for (size_t i = 0; i < cell_pins; ++i) {
+            cell->pins.push_back(IdString(2000 + i));
+        }
+        cell->equation.resize(size_t(1) << cell_pins);
+        for (size_t i = 0; i < (size_t(1) << cell_pins); ++i) {
+            cell->equation.set(i, rand_int(2));
+        }
+
+        std::vector<int32_t> bel_pins(num_pins);
+        for (size_t i = 0; i < num_pins; ++i) {
+            bel_pins[i] = i;
+        }
+        std::shuffle(bel_pins.begin(), bel_pins.end(), rng);
+
+        pin_map->assign(num_pins, -1);
+        for (size_t cell_pin_idx = 0; cell_pin_idx < cell_pins; ++cell_pin_idx) {
+            if (rand_int(4) != 0) {
+                (*pin_map)[bel_pins[cell_pin_idx]] = cell_pin_idx;
+            }
+        }
+    }
+
+    // BEL pins used by any cell in the element; the others are tied high.
+    uint32_t make_used_pins(size_t num_pins, const std::vector<std::vector<int32_t>> &pin_maps)
+    {
+        uint32_t used_pins = 0;
+        for (size_t bel_pin_idx = 0; bel_pin_idx < num_pins; ++bel_pin_idx) {
+            if (rand_int(3) == 0) {
+                used_pins |= (1 << bel_pin_idx);
+            }
+        }
+        for (const auto &pin_map : pin_maps) {
+            for (size_t bel_pin_idx = 0; bel_pin_idx < num_pins; ++bel_pin_idx) {
+                if (pin_map[bel_pin_idx] >= 0) {
+                    used_pins |= (1 << bel_pin_idx);
+                }
+            }
+        }
+        return used_pins;
+    }
+};
+
+} // namespace
+
+TEST_F(LutRotationTest, equation_word)
+{
+    DynamicBitarray<> equation;
+    equation.resize(16);
+    equation.set(0, true);
+    equation.set(5, true);
+    equation.set(15, true);
+    ASSERT_EQ(lut_equation_word(equation), 0x8021ull);
+}
+
+TEST_F(LutRotationTest, matches_reference)
+{
+    for (int iter = 0; iter < 200000; ++iter) {
+        LutBel lut_bel = make_lut_bel(1 + rand_int(6));
+        size_t num_pins = lut_bel.pins.size();
+
+        // Merge a few cells onto the same BEL, so that both agreeing and
+        // conflicting merges are covered.
+        size_t num_cells = 1 + rand_int(3);
+        std::vector<LutCell> cells(num_cells);
+        std::vector<std::vector<int32_t>> pin_maps(num_cells);
+        for (size_t i = 0; i < num_cells; ++i) {
+            make_cell(lut_bel, &cells[i], &pin_maps[i]);
+        }
+        uint32_t used_pins = make_used_pins(num_pins, pin_maps);
+
+        LutEquation equation;
+        std::vector<LogicLevel> reference(64, LL_DontCare);
+        for (size_t i = 0; i < num_cells; ++i) {
+            LutEquation before = equation;
+            bool merged = rotate_and_merge_lut_equation(&equation, lut_bel, lut_equation_word(cells[i].equation),
+                                                        pin_maps[i], used_pins);
+            bool reference_merged =
+                    reference_rotate_and_merge(&reference, lut_bel, cells[i].equation, pin_maps[i], used_pins);
+            ASSERT_EQ(merged, reference_merged) << "iteration " << iter << " cell " << i;
+            if (!merged) {
+                // A failed merge leaves the equation untouched.
+                ASSERT_EQ(equation.value, before.value);
+                ASSERT_EQ(equation.care, before.care);
+                break;
+            }
+
+            ASSERT_EQ(equation.value & ~equation.care, 0ull);
+            for (size_t address = 0; address < 64; ++address) {
+                ASSERT_EQ(level_at(equation, address), reference[address])
+                        << "iteration " << iter << " cell " << i << " address " << address;
+            }
+
+            // check_equation asserts if the merged equation doesn't respect
+            // the cell equation.
+            dict<IdString, IdString> cell_to_bel_map;
+            for (size_t bel_pin_idx = 0; bel_pin_idx < num_pins; ++bel_pin_idx) {
+                int32_t cell_pin_idx = pin_maps[i][bel_pin_idx];
+                if (cell_pin_idx >= 0) {
+                    cell_to_bel_map[cells[i].pins[cell_pin_idx]] = lut_bel.pins[bel_pin_idx];
+                }
+            }
+            // check_equation only takes mapped cell pins, so check the cells
+            // where every pin is on the BEL.
+            if (cell_to_bel_map.size() == cells[i].pins.size()) {
+                check_equation(cells[i], cell_to_bel_map, lut_bel, equation, used_pins);
+            }
+        }
+    }
+}
+
+TEST_F(LutRotationTest, tied_high_pins)
+{
+    // A LUT2 cell on the upper LUT5 of a LUT6 element, with BEL pin 1 unused
+    // and so tied high: only addresses with that input high are constrained.
+    LutBel lut_bel = make_lut_bel(5);
+    lut_bel.low_bit = 32;
+    lut_bel.high_bit = 63;
+
+    DynamicBitarray<> and2;
+    and2.resize(4);
+    and2.set(3, true);
+
+    std::vector<int32_t> pin_map = {0, -1, 1, -1, -1};
+    uint32_t used_pins = 0x1D;
+
+    LutEquation equation;
+    ASSERT_TRUE(rotate_and_merge_lut_equation(&equation, lut_bel, lut_equation_word(and2), pin_map, used_pins));
+
+    std::vector<LogicLevel> reference(64, LL_DontCare);
+    ASSERT_TRUE(reference_rotate_and_merge(&reference, lut_bel, and2, pin_map, used_pins));
+    for (size_t address = 0; address < 64; ++address) {
+        ASSERT_EQ(level_at(equation, address), reference[address]) << "address " << address;
+    }
+    ASSERT_EQ(equation.care, 0xCCCCCCCC00000000ull);
+}
+
+// Run with --gtest_also_run_disabled_tests to compare the cost of one LUT6
+// rotate-and-merge against the per-address reference.
+TEST_F(LutRotationTest, DISABLED_lut6_rotate_and_merge_benchmark)
+{
+    const int kCases = 256;
+    const int kRounds = 4000;
+
+    LutBel lut_bel = make_lut_bel(6);
+    std::vector<LutCell> cells(kCases);
+    std::vector<std::vector<int32_t>> pin_maps(kCases);
+    std::vector<uint64_t> words(kCases);
+    for (int i = 0; i < kCases; ++i) {
+        make_cell(lut_bel, &cells[i], &pin_maps[i]);
+        words[i] = lut_equation_word(cells[i].equation);
+    }
+
+    size_t merged = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < kRounds; ++round) {
+        for (int i = 0; i < kCases; ++i) {
+            LutEquation equation;
+            merged += rotate_and_merge_lut_equation(&equation, lut_bel, words[i], pin_maps[i], 0x3F);
+        }
+    }
+    auto mid = std::chrono::steady_clock::now();
+    std::vector<LogicLevel> equation(64);
+    for (int round = 0; round < kRounds; ++round) {
+        for (int i = 0; i < kCases; ++i) {
+            std::fill(equation.begin(), equation.end(), LL_DontCare);
+            merged += reference_rotate_and_merge(&equation, lut_bel, cells[i].equation, pin_maps[i], 0x3F);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ops = double(kCases) * kRounds;
+    std::cout << "LUT6 rotate-and-merge: "
+              << std::chrono::duration<double, std::nano>(mid - start).count() / ops << " ns, reference "
+              << std::chrono::duration<double, std::nano>(end - mid).count() / ops << " ns" << std::endl;
+    ASSERT_EQ(merged, size_t(2 * kCases * kRounds));
+}